@@ -12,6 +12,7 @@
 #include "EditorState.h"
 #include "SceneState.h"
 #include "Shader.h"
+#include "ShaderPermutations.h"
 #include "Grid.h"
 #include "MenuRenderer.h"
 #include <memory>
@@ -33,7 +34,8 @@ private:
     SceneState sceneState;
     UiOverlay overlay;
     SandBoxUI sandboxUI;
-    Shader ourShader;
+    std::unique_ptr<ShaderPermutations> modelShaders;
+    std::unique_ptr<Shader> gridShader;
     Grid grid;
     bool overlayOpenedForPause = false;
 
@@ -0,0 +1,86 @@
+#ifndef ASSET_DATABASE_H
+#define ASSET_DATABASE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "Log.h"
+
+// Index des fichiers d'un dossier (modèles, maps) partagé par les panneaux de l'interface.
+// Le parcours initial se fait sur le JobSystem ; ensuite inotify signale ajouts et suppressions,
+// appliqués eux aussi en arrière-plan. Chaque mise à jour publie un nouvel Index immuable :
+// un panneau garde le sien tant qu'il l'affiche et compare version() pour savoir s'il a changé.
+class AssetDatabase {
+public:
+    struct Entry {
+        std::string path;          // chemin tel que parcouru depuis la racine
+        std::string lower;         // chemin relatif à la racine, en minuscules : c'est lui qu'on filtre
+        uint64_t bytes = 0;
+        int64_t modified = 0;      // horloge de std::filesystem::file_time_type
+    };
+
+    class Index {
+    public:
+        const std::vector<Entry> &entries() const { return items; }
+        // Positions croissantes des entrées dont le chemin relatif contient query (casse ignorée).
+        // Trois caractères ou plus : intersection des listes de trigrammes puis vérification ;
+        // en deçà, parcours des chemins déjà en minuscules.
+        std::vector<uint32_t> search(const std::string &query) const;
+        const Entry *find(const std::string &path) const;
+
+    private:
+        friend class AssetDatabase;
+        void build();
+
+        std::vector<Entry> items;   // triées par chemin
+        // Trigrammes triés ; ceux de trigramKeys[k] listent les entrées postings[offsets[k] .. offsets[k + 1]]
+        std::vector<uint32_t> trigramKeys;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> postings;
+    };
+
+    using Filter = std::function<bool(const std::string &)>;
+
+    // filter retient les fichiers à indexer ; recursive descend dans les sous-dossiers
+    AssetDatabase(const std::string &root, Filter filter, bool recursive = true);
+
+    // À appeler une fois par frame : événements inotify et index terminés
+    void update();
+    // Reparcourt la racine complète (bouton Rescan, file inotify débordée)
+    void rescan();
+
+    std::shared_ptr<const Index> index() const { return current; }
+    uint64_t version() const { return published; }
+    bool isIndexing() const { return indexing; }
+    const std::string &root() const { return rootDir; }
+
+    AssetDatabase(const AssetDatabase &) = delete;
+    AssetDatabase &operator=(const AssetDatabase &) = delete;
+
+private:
+    void startJob(bool full);
+    void publish(std::shared_ptr<Index> next);
+
+    std::string rootDir;
+    Filter filter;
+    bool recursive;
+    // Partagé avec le parcours initial, qui pose les surveillances hors du thread principal
+    std::shared_ptr<FileWatcher> watcher;
+    bool watching = false;
+
+    std::shared_ptr<const Index> current;
+    uint64_t published = 0;
+    bool indexing = false;
+    bool rescanRequested = false;
+    std::set<std::string> changed;
+    std::set<std::string> removed;
+
+    static ComponentLogger logger;
+};
+
+#endif // ASSET_DATABASE_H
@@ -0,0 +1,18 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <string>
+
+// Remplacement de fichier sans état intermédiaire : le contenu est écrit dans TempPath(path),
+// rendu durable (fsync) puis renommé sur la cible. Après un crash, la cible contient l'ancienne
+// version ou la nouvelle, jamais un mélange des deux.
+class AtomicFile {
+public:
+    static std::string TempPath(const std::string &path);
+    // fsync de tmp, rename() sur path puis fsync du dossier ; tmp est supprimé en cas d'échec
+    static bool Replace(const std::string &tmp, const std::string &path);
+    // fsync d'un fichier complété par ajout (journal)
+    static bool Sync(const std::string &path);
+};
+
+#endif // ATOMIC_FILE_H
@@ -0,0 +1,28 @@
+#ifndef BINARY_MAP_H
+#define BINARY_MAP_H
+
+#include <optional>
+#include <string>
+
+#include "SceneData.h"
+
+// Format binaire des maps (.sbmap), chargé par projection mémoire.
+//
+//   en-tête (48 octets) : magique, version, drapeaux, nombre d'instances et d'assets,
+//                         tailles et empreinte xxHash64 de la charge utile
+//   charge utile        : réglages de lumière et d'environnement, table des chemins d'assets (décalages + octets),
+//                         puis tableaux SoA : index d'asset, positions, rotations, échelles
+//
+// La charge utile peut être compressée (LZ par blocs, sans dépendance externe) ; sinon elle est
+// lue directement dans la projection. Entiers et flottants en petit-boutiste.
+class BinaryMap {
+public:
+    static constexpr const char *Extension = ".sbmap";
+    static constexpr unsigned int Version = 1;
+
+    static bool IsBinaryPath(const std::string &path);
+    static bool Save(const std::string &path, const SceneSnapshot &snapshot, bool compress);
+    static std::optional<SceneSnapshot> Load(const std::string &path);
+};
+
+#endif // BINARY_MAP_H
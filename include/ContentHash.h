@@ -0,0 +1,17 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Empreinte de contenu (xxHash64) pour reconnaître des ressources identiques sous des noms
+// différents. Non cryptographique : deux contenus distincts peuvent, très rarement, collisionner.
+class ContentHash {
+public:
+    static uint64_t Hash(const void *data, size_t size, uint64_t seed = 0);
+    // Empreinte des octets d'un fichier, lu par projection mémoire ; false s'il est illisible
+    static bool HashFile(const std::string &path, uint64_t &out, uint64_t seed = 0);
+};
+
+#endif // CONTENT_HASH_H
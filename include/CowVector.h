@@ -0,0 +1,93 @@
+#ifndef COW_VECTOR_H
+#define COW_VECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Tableau persistant découpé en blocs de ChunkSize éléments, partagés en copie sur écriture.
+// Copier un CowVector est O(1) : les deux copies partagent la table des blocs et les blocs.
+// Une modification ne recopie que la table et le bloc touché, et seulement s'ils sont partagés.
+// Les copies peuvent être lues depuis un autre thread pendant que l'original est modifié.
+template <typename T, size_t ChunkSize = 64>
+class CowVector {
+public:
+    static constexpr size_t ChunkLength = ChunkSize;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T &operator[](size_t i) const { return (*table)[i / ChunkSize]->items[i % ChunkSize]; }
+
+    // Élément modifiable : recopie au besoin la table et le bloc
+    T &edit(size_t i) { return mutableChunk(i / ChunkSize).items[i % ChunkSize]; }
+
+    void push_back(T value)
+    {
+        if (count % ChunkSize == 0) {
+            mutableTable().push_back(std::make_shared<Chunk>());
+            table->back()->items.reserve(ChunkSize);
+        }
+        mutableChunk(count / ChunkSize).items.push_back(std::move(value));
+        ++count;
+    }
+
+    // Décale les éléments suivants : les blocs à partir de i sont recopiés s'ils sont partagés
+    void erase(size_t i)
+    {
+        for (size_t c = i / ChunkSize; c < table->size(); ++c) {
+            auto &items = mutableChunk(c).items;
+            items.erase(items.begin() + static_cast<std::ptrdiff_t>(c == i / ChunkSize ? i % ChunkSize : 0));
+            if (c + 1 < table->size()) items.push_back((*table)[c + 1]->items.front());
+        }
+        if (table->back()->items.empty()) mutableTable().pop_back();
+        --count;
+    }
+
+    void clear()
+    {
+        table = std::make_shared<Table>();
+        count = 0;
+    }
+
+    // Même bloc physique dans les deux copies : ses éléments sont identiques sans les comparer
+    bool sharesChunk(const CowVector &other, size_t chunk) const
+    {
+        return chunk < table->size() && chunk < other.table->size() && (*table)[chunk] == (*other.table)[chunk];
+    }
+
+    // Octets recopiés depuis l'appel précédent : mémoire désormais propre aux copies plus anciennes
+    size_t takeCopiedBytes() { return std::exchange(copiedBytes, 0); }
+
+private:
+    struct Chunk {
+        std::vector<T> items;
+    };
+    using Table = std::vector<std::shared_ptr<Chunk>>;
+
+    Table &mutableTable()
+    {
+        if (table.use_count() > 1) {
+            table = std::make_shared<Table>(*table);
+            copiedBytes += table->size() * sizeof(std::shared_ptr<Chunk>);
+        }
+        return *table;
+    }
+
+    Chunk &mutableChunk(size_t c)
+    {
+        Table &t = mutableTable();
+        if (t[c].use_count() > 1) {
+            t[c] = std::make_shared<Chunk>(*t[c]);
+            copiedBytes += t[c]->items.size() * sizeof(T);
+        }
+        return *t[c];
+    }
+
+    std::shared_ptr<Table> table = std::make_shared<Table>();
+    size_t count = 0;
+    size_t copiedBytes = 0;
+};
+
+#endif // COW_VECTOR_H
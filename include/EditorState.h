@@ -55,6 +55,7 @@ struct EditorState {
     std::string statusMessage;
     float statusMessageTime = 0.0f;
     std::string currentMapName = "default";
+    std::string currentMapExtension = ".json";   // format de la map ouverte (.json ou .sbmap)
     float fps = 0.0f;
 
     // Sélection d'objet
@@ -0,0 +1,57 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Log.h"
+
+// Surveillance de dossiers via inotify (Linux uniquement, inactif ailleurs).
+// Le descripteur est non bloquant : poll() ne coûte qu'un read() par frame quand rien ne change.
+// Les éditeurs écrivent souvent un fichier en plusieurs fois, d'où l'attente de `debounce`
+// sans nouvel événement avant de signaler un chemin.
+class FileWatcher {
+public:
+    explicit FileWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(200));
+    ~FileWatcher();
+
+    // Ajoute `directory` (et ses sous-dossiers si `recursive`) ; false si inotify est indisponible
+    bool watch(const std::string &directory, bool recursive = true);
+
+    // Chemins modifiés et stabilisés depuis le dernier appel (un dossier apparu y figure aussi) ;
+    // removed reçoit, sans attente, les fichiers et dossiers supprimés ou déplacés hors de vue
+    std::vector<std::string> poll(std::vector<std::string> *removed = nullptr);
+
+    bool isActive() const { return fd >= 0; }
+    // La file d'inotify a débordé depuis le dernier appel : des événements ont été perdus
+    bool takeOverflow() { bool lost = overflowed; overflowed = false; return lost; }
+
+    // Compare deux chemins écrits différemment ("../a/b" et "../a/./b") désignant le même fichier
+    static bool SamePath(const std::string &a, const std::string &b);
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool addWatch(const std::string &directory, bool recursive);
+    void readEvents();
+
+    int fd = -1;
+    std::chrono::milliseconds debounce;
+    struct Watched {
+        std::string path;
+        bool recursive = true;   // les sous-dossiers créés ensuite sont surveillés aussi
+    };
+    std::map<int, Watched> directories;
+    std::map<std::string, Clock::time_point> pending;
+    std::vector<std::string> removedPaths;
+    bool overflowed = false;
+
+    static ComponentLogger logger;
+};
+
+#endif // FILE_WATCHER_H
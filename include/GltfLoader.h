@@ -0,0 +1,51 @@
+#ifndef GLTF_LOADER_H
+#define GLTF_LOADER_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Mesh.h"
+#include "Texture.h"
+
+// Chargeur glTF 2.0 (.gltf + .bin, .glb) sans passer par Assimp.
+// Les buffers sont projetés en mémoire et les accesseurs lus directement dans les Vertex du
+// moteur ; les nœuds sont gardés comme instances des primitives qu'ils référencent.
+// Sans appel OpenGL : utilisable depuis un thread de travail.
+class GltfLoader {
+public:
+    // Image référencée par un matériau : fichier à côté du modèle, ou image intégrée déjà décodée
+    struct ImageSource {
+        std::string key;               // chemin du fichier, ou "<modèle>#image<N>" si intégrée
+        Texture2D::Image embedded;
+    };
+
+    // Une primitive glTF devient un Mesh
+    struct Primitive {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<std::pair<std::string, int>> textures;   // (type de texture, index dans images)
+        float opacity = 1.0f;
+    };
+
+    // Instance d'une primitive placée par un nœud de la scène
+    struct Node {
+        unsigned int primitive;
+        glm::mat4 transform;
+    };
+
+    struct Scene {
+        std::vector<Primitive> primitives;
+        std::vector<ImageSource> images;
+        std::vector<Node> nodes;
+    };
+
+    static bool IsGltf(const std::string &path);
+    // false si le fichier est illisible ou utilise une fonctionnalité non gérée (l'appelant
+    // retombe alors sur Assimp)
+    static bool Load(const std::string &path, Scene &scene);
+};
+
+#endif // GLTF_LOADER_H
@@ -0,0 +1,128 @@
+#ifndef GPU_HANDLE_H
+#define GPU_HANDLE_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+enum class GpuResourceType {
+    Buffer,
+    VertexArray,
+    Texture,
+    Program,
+    Framebuffer,
+    Renderbuffer,
+    Count
+};
+
+// File de suppression différée des objets OpenGL.
+// Un handle détruit n'appelle pas glDelete* directement : l'objet est mis en file et supprimé
+// par Flush() en fin de frame, jamais au milieu d'un dessin ni depuis un thread de travail.
+// Les compteurs d'objets vivants servent au rapport de fuites affiché à la sortie.
+class GpuResources {
+public:
+    static void Created(GpuResourceType type);
+    static void Release(GpuResourceType type, GLuint id);
+
+    // À appeler en fin de frame depuis le thread GL
+    static void Flush();
+
+    static size_t LiveCount(GpuResourceType type);
+    static size_t PendingCount();
+    static const char* TypeName(GpuResourceType type);
+
+    // Liste les objets encore vivants ; appelé automatiquement à la destruction des statiques
+    static void ReportLeaks();
+};
+
+// Handle propriétaire et déplaçable d'un objet OpenGL
+template <GpuResourceType Type>
+class GpuHandle {
+public:
+    GpuHandle() = default;
+    // Prend possession d'un nom déjà généré
+    explicit GpuHandle(GLuint adopted) : id(adopted) {
+        if (id) GpuResources::Created(Type);
+    }
+    ~GpuHandle() { reset(); }
+
+    GpuHandle(GpuHandle&& other) noexcept : id(other.id) { other.id = 0; }
+    GpuHandle& operator=(GpuHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+    GpuHandle(const GpuHandle&) = delete;
+    GpuHandle& operator=(const GpuHandle&) = delete;
+
+    static GpuHandle Create();
+
+    GLuint get() const { return id; }
+    explicit operator bool() const { return id != 0; }
+
+    void reset() {
+        if (id) GpuResources::Release(Type, id);
+        id = 0;
+    }
+
+private:
+    GLuint id = 0;
+};
+
+template <>
+inline GpuHandle<GpuResourceType::Buffer> GpuHandle<GpuResourceType::Buffer>::Create()
+{
+    GLuint name = 0;
+    glGenBuffers(1, &name);
+    return GpuHandle(name);
+}
+
+template <>
+inline GpuHandle<GpuResourceType::VertexArray> GpuHandle<GpuResourceType::VertexArray>::Create()
+{
+    GLuint name = 0;
+    glGenVertexArrays(1, &name);
+    return GpuHandle(name);
+}
+
+template <>
+inline GpuHandle<GpuResourceType::Texture> GpuHandle<GpuResourceType::Texture>::Create()
+{
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    return GpuHandle(name);
+}
+
+template <>
+inline GpuHandle<GpuResourceType::Program> GpuHandle<GpuResourceType::Program>::Create()
+{
+    return GpuHandle(glCreateProgram());
+}
+
+template <>
+inline GpuHandle<GpuResourceType::Framebuffer> GpuHandle<GpuResourceType::Framebuffer>::Create()
+{
+    GLuint name = 0;
+    glGenFramebuffers(1, &name);
+    return GpuHandle(name);
+}
+
+template <>
+inline GpuHandle<GpuResourceType::Renderbuffer> GpuHandle<GpuResourceType::Renderbuffer>::Create()
+{
+    GLuint name = 0;
+    glGenRenderbuffers(1, &name);
+    return GpuHandle(name);
+}
+
+using GlBuffer = GpuHandle<GpuResourceType::Buffer>;
+using GlVertexArray = GpuHandle<GpuResourceType::VertexArray>;
+using GlTexture = GpuHandle<GpuResourceType::Texture>;
+using GlProgram = GpuHandle<GpuResourceType::Program>;
+using GlFramebuffer = GpuHandle<GpuResourceType::Framebuffer>;
+using GlRenderbuffer = GpuHandle<GpuResourceType::Renderbuffer>;
+
+#endif // GPU_HANDLE_H
@@ -5,18 +5,19 @@
 #include <glm/glm.hpp>
 #include <vector>
 
+#include "GpuHandle.h"
+
 class Shader;
 
 class Grid {
 public:
     Grid();
-    ~Grid();
 
     void draw(Shader &shader, const glm::mat4 &view, const glm::mat4 &proj);
 
 private:
-    GLuint vao = 0;
-    GLuint vbo = 0;
+    GlVertexArray vao;
+    GlBuffer vbo;
     GLsizei vertexCount = 0;
 
     void buildGrid(int halfSize = 10, float step = 1.0f);
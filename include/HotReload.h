@@ -0,0 +1,41 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <string>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "Log.h"
+
+class ModelManager;
+class ShaderPermutations;
+
+// Relie les changements de fichiers aux ressources concernées :
+//  - sources GLSL : recompilation des ShaderPermutations qui les utilisent
+//  - modèles (.obj, .fbx, ...) et .mtl : réimport en arrière-plan via ModelManager::reloadAsset
+//  - images : décodage en arrière-plan puis remplacement en place de la texture en cache
+// Tout ce qui touche au GPU est appliqué en début de frame, depuis update() ou JobSystem::drainMainThread().
+class HotReload {
+public:
+    explicit HotReload(ModelManager &models);
+
+    void addShaders(ShaderPermutations *shaders);
+    void watch(const std::string &directory);
+
+    // À appeler une fois par frame, avant le rendu
+    void update();
+
+private:
+    void onShaderChanged(const std::string &path);
+    void onModelChanged(const std::string &path);
+    void onMaterialChanged(const std::string &path);
+    void onTextureChanged(const std::string &path);
+
+    FileWatcher watcher;
+    ModelManager &models;
+    std::vector<ShaderPermutations*> shaders;
+
+    static ComponentLogger logger;
+};
+
+#endif // HOT_RELOAD_H
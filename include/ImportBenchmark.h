@@ -0,0 +1,14 @@
+#ifndef IMPORT_BENCHMARK_H
+#define IMPORT_BENCHMARK_H
+
+#include <string>
+
+// Mesure du temps d'import d'un fichier : lecteur intégré contre Assimp.
+// L'import se fait en mode différé (aucun appel OpenGL), sans fenêtre.
+class ImportBenchmark {
+public:
+    // Affiche et journalise les temps min/moyen de chaque lecteur ; renvoie le code de sortie
+    static int Run(const std::string &path, int iterations);
+};
+
+#endif // IMPORT_BENCHMARK_H
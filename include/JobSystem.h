@@ -0,0 +1,64 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Log.h"
+
+// Pool de threads pour les imports en arrière-plan.
+// Les travaux qui touchent OpenGL sont renvoyés au thread principal via runOnMainThread()
+// et exécutés au début de la frame suivante par drainMainThread().
+// Une seconde file, de basse priorité (préchargements, vignettes), n'est servie que lorsque la
+// file principale est vide, par un seul thread à la fois.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    static JobSystem& Instance();
+
+    void submit(Job job);
+    // File de basse priorité : un travail en cours n'est pas interrompu, mais aucun n'est lancé
+    // tant que la file principale attend, et ses parallelFor s'exécutent sur son seul thread.
+    // Les travaux encore en file à l'arrêt sont abandonnés.
+    void submitBackground(Job job);
+    void runOnMainThread(Job job);
+    // Exécute body(0..count-1) sur le pool et attend la fin. Le thread appelant participe :
+    // utilisable depuis un travail en arrière-plan sans bloquer le pool.
+    // La première exception levée par body est relancée ici.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    // À appeler une fois par frame depuis le thread du contexte GL
+    void drainMainThread();
+
+    size_t workerCount() const { return workers.size(); }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    void workerLoop(unsigned int index);
+
+    std::vector<std::thread> workers;
+    std::deque<Job> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    bool stopping = false;
+    std::deque<Job> backgroundQueue;
+    bool backgroundRunning = false;
+
+    std::vector<Job> mainThreadJobs;
+    std::mutex mainThreadMutex;
+
+    static ComponentLogger logger;
+};
+
+#endif // JOB_SYSTEM_H
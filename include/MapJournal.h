@@ -0,0 +1,85 @@
+#ifndef MAP_JOURNAL_H
+#define MAP_JOURNAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "SceneData.h"
+
+// Journal des modifications d'une map (<map>.journal), en ajout seul.
+// Une sauvegarde n'y écrit que les enregistrements accumulés depuis la précédente : ajout, mise à
+// jour ou suppression d'instance, réglages de lumière et d'environnement. Passé CompactBytes, la
+// map complète est réécrite puis le journal repart de zéro. Sauvegardes et compactions (fsync compris)
+// se font hors du thread de rendu.
+// Au chargement, la map est relue puis son journal rejoué ; un enregistrement tronqué par un crash
+// est ignoré, ainsi que tout ce qui le suit.
+class MapJournal {
+public:
+    static constexpr uint64_t CompactBytes = 1024 * 1024;
+    // Appelée sur le thread principal une fois l'écriture terminée
+    using Completion = std::function<void(bool)>;
+    // Produit les instances à écrire depuis un instantané pris sur le thread principal ; appelée sur
+    // le thread d'écriture, puis détruite sur le thread principal
+    using InstanceSource = std::function<std::vector<ModelInstanceData>()>;
+
+    static std::string JournalPath(const std::string &mapPath);
+    // Map et journal relus sans s'y rattacher (manifestes)
+    static std::optional<SceneSnapshot> Read(const std::string &mapPath);
+
+    // Lit la map, rejoue son journal et s'y rattache (attend d'abord les écritures en cours)
+    std::optional<SceneSnapshot> load(const std::string &mapPath);
+    // Écriture complète de la map en arrière-plan, le journal repart vide
+    void save(const std::string &mapPath, const DirectionalLightSettings &light, const EnvironmentSettings &environment,
+              InstanceSource instances, Completion done);
+    // Écrit une map vide à mapPath et supprime son journal, en arrière-plan et à la suite des
+    // écritures en file ; false si le journal est rattaché à mapPath (map ouverte)
+    bool create(const std::string &mapPath, Completion done);
+    // Ajoute au journal, en arrière-plan, les modifications en attente ; false si le journal n'est
+    // pas rattaché à mapPath
+    bool commit(const std::string &mapPath, const DirectionalLightSettings &light, const EnvironmentSettings &environment,
+                Completion done);
+
+    bool wantsCompaction() const
+    {
+        return !attachedPath.empty() && !compacting && pending.empty() && journalBytes > CompactBytes;
+    }
+    // instances : état courant complet, identique à la map suivie de tout le journal
+    void compact(const DirectionalLightSettings &light, const EnvironmentSettings &environment, InstanceSource instances);
+
+    void record(const InstanceEdit &edit);
+    bool isAttachedTo(const std::string &mapPath) const { return !attachedPath.empty() && attachedPath == mapPath; }
+    // Les modifications ne sont plus suivies, la prochaine sauvegarde sera complète
+    void detach();
+    // Attend la fin des écritures en file (avant un chargement, à la fermeture)
+    void waitIdle();
+
+private:
+    // Rejoue le journal de mapPath sur snapshot ; tail reçoit les enregistrements rejoués
+    static void Replay(const std::string &mapPath, uint64_t mapHash, SceneSnapshot &snapshot, std::vector<unsigned char> *tail);
+    bool attach(const std::string &mapPath, const SceneSnapshot &state, const std::vector<unsigned char> &tail);
+    // Les écritures s'exécutent une à une sur le JobSystem, dans l'ordre de soumission
+    void runSerial(std::function<void()> task);
+
+    std::string attachedPath;
+    uint64_t journalBytes = 0;
+    std::vector<unsigned char> pending;
+    size_t lastUpdateOffset = SIZE_MAX;   // dernier enregistrement de mise à jour en attente, fusionnable
+    size_t lastUpdateIndex = 0;
+    std::vector<unsigned char> committedSettings;
+    // Incrémenté à chaque rattachement : les fins d'écriture d'un rattachement précédent sont ignorées
+    uint64_t generation = 0;
+    bool compacting = false;
+
+    std::mutex ioMutex;
+    std::condition_variable ioIdle;
+    std::deque<std::function<void()>> ioTasks;
+    bool ioRunning = false;
+};
+
+#endif // MAP_JOURNAL_H
@@ -0,0 +1,35 @@
+#ifndef MAP_MANIFEST_H
+#define MAP_MANIFEST_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Résumé d'une map (<map>.manifest) : assets distincts avec taille et empreinte, nombre d'instances.
+// Lu par la liste des maps sans ouvrir la map elle-même ; reconstruit (map relue, journal rejoué)
+// dès que la taille ou la date de la map ou de son journal ne correspondent plus.
+class MapManifest {
+public:
+    struct Asset {
+        std::string path;
+        uint64_t bytes = 0;        // taille du fichier, 0 s'il est introuvable
+        uint64_t hash = 0;         // xxHash64 du fichier
+        size_t instances = 0;
+    };
+
+    size_t instanceCount = 0;
+    std::vector<Asset> assets;
+
+    // Somme des tailles des assets sur disque : ordre de grandeur de la mémoire à prévoir
+    uint64_t estimatedBytes() const;
+    std::vector<std::string> assetPaths() const;
+
+    static std::string SidecarPath(const std::string &mapPath);
+    // Manifeste à jour de mapPath, sans lire la map ; nullopt s'il manque ou est périmé
+    static std::optional<MapManifest> Read(const std::string &mapPath);
+    // Relit la map et son journal, hache les assets et réécrit le manifeste (thread de travail)
+    static std::optional<MapManifest> Build(const std::string &mapPath);
+};
+
+#endif // MAP_MANIFEST_H
@@ -4,8 +4,16 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "AssetDatabase.h"
+#include "MapManifest.h"
 
 class EditorState;
+class ModelManager;
+class ThumbnailRenderer;
 struct SceneSnapshot;
 
 class MapPanel {
@@ -18,11 +26,17 @@ public:
              SaveCallback saveCb,
              LoadCallback loadCb,
              NewCallback newCb,
-             EditorState* editor);
+             EditorState* editor,
+             AssetDatabase* maps = nullptr,
+             ModelManager* models = nullptr);
 
     void draw(bool* open = nullptr);
     void setVisible(bool visible) { m_visible = visible; }
     bool isVisible() const { return m_visible; }
+    void setThumbnails(ThumbnailRenderer* renderer) { thumbnails = renderer; }
+    // Sauvegarde terminée : une sauvegarde dans le journal seul ne change pas la map, l'index ne
+    // la voit pas et son manifeste doit être relu
+    void mapSaved(const std::string& path);
 
 private:
     bool m_visible = true;
@@ -35,8 +49,31 @@ private:
     LoadCallback load;
     NewCallback createNew;
     EditorState* editor;
+    AssetDatabase* maps;
+    ModelManager* models;
+    ThumbnailRenderer* thumbnails = nullptr;
 
+    // Copie de l'index des maps, reprise quand sa version change
+    std::shared_ptr<const AssetDatabase::Index> listing;
+    uint64_t listingVersion = 0;
     std::vector<std::string> files;
+    std::vector<uint32_t> matches;
+    std::string matchedFilter;
+    // Map sauvegardée ou créée, sélectionnée dès que l'index la contient
+    std::string wantedSelection;
+    // Manifestes lus ou reconstruits en arrière-plan, pour les seules maps dont l'entrée de
+    // l'index (taille, date) a changé depuis le scan précédent
+    using Stamp = std::pair<uint64_t, int64_t>;
+    std::map<std::string, Stamp> manifestStamps;
+    std::map<std::string, MapManifest> manifests;
+    std::set<std::string> manifestsPending;
+    // Redemandés pendant leur lecture : relus dès qu'elle se termine
+    std::set<std::string> manifestsStale;
+    // Map dont les assets sont préchargés (sélection, ou survol prolongé de HoverDelay secondes)
+    static constexpr double HoverDelay = 0.3;
+    std::string prefetchTarget;
+    std::string hoveredPath;
+    double hoverStart = 0.0;
     int selected = -1;
     std::string newMapName = "new_map";
     std::string filter;
@@ -47,6 +84,9 @@ private:
     std::string displayName(const std::string& path) const;
     std::string pathForCurrentMap() const;
     void selectPath(const std::string& path);
+    void requestManifest(const std::string& path);
+    void prefetch(const std::string& path);
+    void drawManifest(const std::string& path) const;
 };
 
 #endif // MAP_PANEL_H
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Fichier projeté en mémoire en lecture seule (mmap). Les chargeurs lisent les données
+// directement dans la projection, sans tampon intermédiaire.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Un fichier vide est ouvert mais n'a pas de données
+    bool isOpen() const { return opened; }
+    const unsigned char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Indique au noyau une lecture séquentielle (lecture anticipée plus agressive)
+    void adviseSequential() const;
+
+private:
+    void close();
+
+    const unsigned char *bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+};
+
+#endif // MAPPED_FILE_H
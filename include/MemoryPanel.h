@@ -0,0 +1,22 @@
+#ifndef MEMORY_PANEL_H
+#define MEMORY_PANEL_H
+
+#include <string>
+
+class MemoryPanel {
+public:
+    MemoryPanel();
+
+    void draw(bool* open = nullptr);
+    void setVisible(bool visible) { m_visible = visible; }
+    bool isVisible() const { return m_visible; }
+
+private:
+    bool m_visible = true;
+
+private:
+    int topCount = 10;
+    std::string lastExport;
+};
+
+#endif // MEMORY_PANEL_H
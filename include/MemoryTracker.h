@@ -0,0 +1,74 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Log.h"
+
+enum class MemoryKind {
+    VertexBuffer,
+    IndexBuffer,
+    StreamBuffer,
+    Texture,
+    CpuMesh,     // sommets/indices conservés côté CPU par les Mesh
+    CpuTexture,  // pixels décodés en attente d'envoi au GPU
+    Count
+};
+
+// Comptabilité centrale des allocations GPU (buffers, textures) et des données CPU associées.
+// Chaque entrée porte un propriétaire (chemin de l'asset, "Grid"...) pour la ventilation par asset.
+// Thread-safe : les décodages en arrière-plan déclarent leurs pixels depuis les threads de travail.
+class MemoryTracker {
+public:
+    struct Entry {
+        std::string owner;
+        MemoryKind kind;
+        size_t bytes;
+    };
+
+    static void TrackBuffer(GLuint id, MemoryKind kind, size_t bytes, const std::string& owner = CurrentOwner());
+    static void UntrackBuffer(GLuint id);
+    static void TrackTexture(GLuint id, size_t bytes, const std::string& owner);
+    static void UntrackTexture(GLuint id);
+    // Données CPU : une valeur par (propriétaire, type), 0 retire l'entrée
+    static void SetCpu(const std::string& owner, MemoryKind kind, size_t bytes);
+
+    static std::vector<Entry> Snapshot();
+    static size_t Total(MemoryKind kind);
+    static bool ExportCsv(const std::string& path);
+
+    static bool IsGpu(MemoryKind kind) { return kind != MemoryKind::CpuMesh && kind != MemoryKind::CpuTexture; }
+    static const char* KindName(MemoryKind kind);
+
+    // Propriétaire attribué aux allocations faites sans propriétaire explicite sur ce thread
+    static const std::string& CurrentOwner();
+
+    class OwnerScope {
+    public:
+        explicit OwnerScope(const std::string& owner);
+        ~OwnerScope();
+        OwnerScope(const OwnerScope&) = delete;
+        OwnerScope& operator=(const OwnerScope&) = delete;
+    private:
+        std::string previous;
+    };
+
+private:
+    enum Domain { BufferDomain, TextureDomain };
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, GLuint>, Entry> gpu;
+    static std::map<std::pair<std::string, MemoryKind>, size_t> cpu;
+    static size_t totals[static_cast<size_t>(MemoryKind::Count)];
+
+    static ComponentLogger logger;
+};
+
+#endif // MEMORY_TRACKER_H
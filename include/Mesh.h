@@ -7,7 +7,11 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Shader.h"
+#include "GpuHandle.h"
+#include "UploadScheduler.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,6 +28,12 @@ struct Vertex {
     glm::vec3 Bitangent;
 };
 
+// Données par instance lues par la variante USE_INSTANCING (attributs 5 à 11)
+struct InstanceTransform {
+    glm::mat4 model;
+    glm::mat3 normal;
+};
+
 struct Texture {
     unsigned int id;
     std::string type;
@@ -36,24 +46,51 @@ public:
     std::vector<Vertex>       vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture>      textures;
-    unsigned int VAO;
+
+    // Matériau résolu au chargement : bits ShaderFeature::MaterialMask et textures à lier
+    unsigned int features = 0;
+    float opacity = 1.0f;
     
     // Bounding box
     glm::vec3 minBounds = glm::vec3(FLT_MAX);
     glm::vec3 maxBounds = glm::vec3(-FLT_MAX);
 
-    // constructor
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+    // constructor; with `uploadNow` false the buffers are only created by upload() (imports off the GL thread)
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, float opacity = 1.0f, bool uploadNow = true);
 
-    // render the mesh
+    // creates the GPU buffers from the CPU data, must run on the GL thread
+    void upload();
+    // hands the GPU buffers to the deferred deletion queue; the mesh is no longer drawable until upload()
+    void release();
+    // true once the UploadScheduler has copied the vertex and index data
+    bool isUploaded() const { return gpu && (!gpu->pendingUpload || gpu->pendingUpload->done()); }
+
+    // render the mesh with a variant selected for `features`
     void Draw(Shader &shader);
+    // render `count` instances whose InstanceTransform are stored in `instanceBuffer` at `offset`
+    void DrawInstanced(Shader &shader, GLuint instanceBuffer, GLintptr offset, GLsizei count);
+
+    // recomputes `features` and the texture bindings from `textures`
+    void resolveMaterial();
 
 private:
     // render data 
-    unsigned int VBO, EBO;
+    // shared by every mesh with the same vertex and index data (see contentHash),
+    // deleted when the last of them is released
+    struct GpuBuffers {
+        GlVertexArray VAO;
+        GlBuffer VBO, EBO;
+        std::shared_ptr<UploadScheduler::Ticket> pendingUpload;
+        size_t vertexCount = 0, indexCount = 0;
+    };
+    std::shared_ptr<GpuBuffers> gpu;
+    // xxHash64 of the vertices and indices, computed with the CPU data (import thread)
+    uint64_t contentHash = 0;
+    unsigned int diffuseTexture = 0, specularTexture = 0, normalTexture = 0;
 
     // initializes all the buffer objects/arrays
     void setupMesh();
+    void bindMaterial(Shader &shader);
 };
 
 #endif
@@ -4,12 +4,16 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include "Shader.h"
 #include "Mesh.h"
+#include "Texture.h"
+
+class ShaderPermutations;
 
 #include <string>
 #include <fstream>
@@ -25,38 +29,85 @@ public:
     std::vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
     bool textures_loaded_flag = false; // flag to track if textures have been loaded
     std::vector<Mesh>    meshes;
+    // Placement des maillages par les nœuds de la scène (glTF, hiérarchies Assimp) : un maillage peut y apparaître
+    // plusieurs fois, entrées triées par maillage. Vide : chaque maillage une fois, sans transform.
+    struct MeshNode {
+        unsigned int mesh;
+        glm::mat4 transform;
+    };
+    std::vector<MeshNode> nodes;
     std::string directory;
+    std::string sourcePath;
     bool gammaCorrection;
 
     // constructor, expects a filepath to a 3D model.
-    Model(std::string const &path, bool gamma = false);
+    // With `deferGpuUpload` no GL call is made: the import can run on a worker thread and
+    // uploadToGpu() must then be called from the GL thread before drawing.
+    Model(std::string const &path, bool gamma = false, bool deferGpuUpload = false);
+    ~Model();
+    Model(Model &&) = default;
+    Model &operator=(Model &&) = default;
+
+    // sends the meshes and the textures decoded by a deferred import to the GPU; without
+    // `shareTextures` the textures not already cached stay private to this model (previews)
+    void uploadToGpu(bool shareTextures = true);
+    // deletes the mesh buffers and drops the references on the shared Texture2D cache
+    void releaseGpu();
+    // points the materials using `path` at texture `id` (the cache gave that path a new texture)
+    void retargetTexture(const std::string &path, unsigned int id);
 
-    // draws the model, and thus all its meshes
-    void Draw(Shader &shader);
+    // draws the model, and thus all its meshes, each with the variant matching its material
+    void Draw(ShaderPermutations &shaders, unsigned int drawFeatures, const glm::mat4 &model);
+    // draws `count` instances whose transforms were streamed into `instanceBuffer` at `offset`
+    void DrawInstanced(ShaderPermutations &shaders, unsigned int drawFeatures, GLuint instanceBuffer, GLintptr offset, GLsizei count);
+    // same for a single mesh, `model` already including the node transform
+    void DrawMesh(unsigned int index, ShaderPermutations &shaders, unsigned int drawFeatures, const glm::mat4 &model);
+    void DrawMeshInstanced(unsigned int index, ShaderPermutations &shaders, unsigned int drawFeatures, GLuint instanceBuffer, GLintptr offset, GLsizei count);
     
-    // Get model dimensions
-    glm::vec3 getModelSize() const {
-        if (meshes.empty()) return glm::vec3(1.0f);
-        
-        glm::vec3 minBounds = meshes[0].minBounds;
-        glm::vec3 maxBounds = meshes[0].maxBounds;
-        
-        for (const auto& mesh : meshes) {
-            minBounds = glm::min(minBounds, mesh.minBounds);
-            maxBounds = glm::max(maxBounds, mesh.maxBounds);
-        }
-        
-        return maxBounds - minBounds;
-    }
+    // Get model dimensions (node transforms included)
+    glm::vec3 getModelSize() const;
+    // axis-aligned bounds in model space (node transforms included); inverted when there are no meshes
+    void getBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const;
+
+    // Lecteurs intégrés (glTF, OBJ) plutôt qu'Assimp pour les formats qu'ils gèrent ; Assimp reste
+    // utilisé si le lecteur échoue
+    static void SetNativeImporters(bool enabled) { nativeImporters = enabled; }
+    static bool UsesNativeImporters() { return nativeImporters; }
     
 private:
+    static bool nativeImporters;
+
+    // identifiant provisoire des textures décodées en attente d'envoi
+    static const unsigned int PendingTextureId = 0xFFFFFFFFu;
+
+    bool deferUpload = false;
+    std::map<std::string, Texture2D::Image> pendingImages;
+    // garde les textures du cache vivantes tant que le modèle les utilise
+    std::vector<std::shared_ptr<GlTexture>> textureRefs;
+
+    // Texture2D::Load en mode immédiat, décodage seul en mode différé
+    unsigned int loadTextureFile(const std::string &fullPath);
+    // même chose pour une image déjà décodée (images intégrées au fichier)
+    unsigned int loadTextureImage(const std::string &key, Texture2D::Image &&image);
+
+    // lecteurs intégrés ; false pour retomber sur Assimp
+    bool loadGltf(std::string const &path);
+    bool loadObj(std::string const &path);
+
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(std::string const &path);
 
-    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene);
-    
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any),
+    // collecting each distinct aiMesh once into a flat work list and recording the node's world transform in `nodes`.
+    void processNode(aiNode *node, const aiScene *scene, const glm::mat4 &parent, std::vector<aiMesh*> &work,
+                     std::map<unsigned int, unsigned int> &meshSlots);
+
+    // converts the work list: materials once each on this thread, geometry in parallel on the
+    // JobSystem, then the Mesh objects (and their GL buffers) in traversal order on this thread
+    void processMeshes(const std::vector<aiMesh*> &work, const aiScene *scene);
+    // vertices and indices only, no shared state: safe on any thread
+    static void convertGeometry(const aiMesh *mesh, std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+    void processMaterial(aiMaterial *material, std::vector<Texture> &textures, float &opacity);
 
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
     // the required info is returned as a Texture struct.
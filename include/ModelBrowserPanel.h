@@ -3,30 +3,38 @@
 
 #include <string>
 #include <vector>
-#include <filesystem>
 #include <memory>
 
+#include "AssetDatabase.h"
+
 class ModelManager;
+class ThumbnailRenderer;
 
 class ModelBrowserPanel {
 public:
-    ModelBrowserPanel(ModelManager* mgr, const std::string& rootDir);
+    ModelBrowserPanel(ModelManager* mgr, AssetDatabase* assets);
     void draw(bool* open = nullptr);
     void setVisible(bool visible) { m_visible = visible; }
     bool isVisible() const { return m_visible; }
+    void setThumbnails(ThumbnailRenderer* renderer) { thumbnails = renderer; }
 
 private:
     bool m_visible = true;
 
 private:
     ModelManager* manager;
-    std::string root;
+    AssetDatabase* assets;
+    ThumbnailRenderer* thumbnails = nullptr;
     std::string filter;
-    std::vector<std::string> files;
-    int selected = 0;
+    // Résultat du filtre, recalculé seulement quand le filtre ou l'index changent
+    std::shared_ptr<const AssetDatabase::Index> listing;
+    uint64_t listingVersion = 0;
+    std::string listedFilter;
+    std::vector<uint32_t> matches;
+    std::string selected;
 
-    void scanFiles();
-    bool exists(const std::string& path) const;
+    void refreshMatches();
+    void drawCell(const AssetDatabase::Entry& entry, float cellSize);
 };
 
 #endif // MODEL_BROWSER_PANEL_H
@@ -1,14 +1,22 @@
 #ifndef MODEL_MANAGER_H
 #define MODEL_MANAGER_H
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
+#include "CowVector.h"
 #include "Model.h"
 #include "Log.h"
 #include "SceneData.h"
+#include "ShaderPermutations.h"
+#include "StreamBuffer.h"
 #include <glm/glm.hpp>
+#include <deque>
 #include <optional>
+#include <map>
+#include <set>
 
 struct GLFWwindow;
 
@@ -20,7 +28,12 @@ public:
     void addModel(const std::string &path);
     void addModelInstance(const ModelInstanceData& data);
     void clear();
-    void drawAll(Shader &shader, bool highlight = false, const glm::vec3& highlightColor = glm::vec3(1.0f));
+    // Les instances d'un même modèle sont dessinées en un seul appel instancié
+    void drawAll(ShaderPermutations &shaders, bool highlight = false);
+    // Caméra de la frame, pour estimer la taille à l'écran des objets (résidence des textures)
+    void setViewer(const glm::vec3 &eye, float verticalFov, float viewportHeight);
+    // Boîte englobante de toutes les instances, en coordonnées monde ; false sans instance
+    bool sceneBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const;
 
     // Gestion des objets
     void beginPlacement(const std::string &path);
@@ -28,15 +41,20 @@ public:
     void setPreviewPosition(const glm::vec3 &pos);
     void confirmPlacement();
     void cancelPlacement();
-    void drawPreview(Shader &shader, bool highlight = true, const glm::vec3& highlightColor = glm::vec3(1.0f));
+    void drawPreview(ShaderPermutations &shaders, bool highlight = true);
     
     // Gestion de la sélection
     bool raycast(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, size_t& outIndex);
     void updateModel(size_t index, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale, float opacity = 1.0f);
+    void removeModel(size_t index);
+
+    // Ajouts, mises à jour et suppressions d'instances (hors loadInstances), pour le journal de la map
+    using EditListener = std::function<void(const InstanceEdit&)>;
+    void setEditListener(EditListener listener) { editListener = std::move(listener); }
     
     // Définition de la structure Entry
     struct Entry {
-        std::unique_ptr<Model> model;
+        std::shared_ptr<Model> model;
         glm::vec3 position = glm::vec3(0.0f);
         glm::vec3 rotation = glm::vec3(0.0f);
         glm::vec3 scale = glm::vec3(1.0f);
@@ -44,25 +62,96 @@ public:
     };
     
     using ModelEntry = Entry;  // Alias pour faciliter l'utilisation
+    // Instances en copie sur écriture : un instantané coûte O(1) et partage les blocs inchangés
+    using Instances = CowVector<Entry>;
     
     const ModelEntry* getModel(size_t index) const;
     size_t getModelCount() const { return models.size(); }
 
     bool hasModels() const { return !models.empty(); }
-    std::vector<ModelInstanceData> serializeInstances() const;
+    std::vector<ModelInstanceData> serializeInstances() const { return ToInstanceData(models); }
+    Instances snapshotInstances() const { return models; }
+    static std::vector<ModelInstanceData> ToInstanceData(const Instances& instances);
+
+    // Annulation par instantanés ; l'historique est borné en mémoire (SetHistoryBudget), pas en étapes
+    bool undo();
+    bool redo();
+    bool canUndo() const { return !undoSteps.empty(); }
+    bool canRedo() const { return !redoSteps.empty(); }
+    size_t historyBytes() const { return historyUsed; }
+    static void SetHistoryBudget(size_t bytes) { historyBudget = bytes; }
     void loadInstances(const std::vector<ModelInstanceData>& data);
 
+    // Réimporte le fichier en arrière-plan puis remplace le modèle partagé au début d'une frame :
+    // toutes ses instances (et l'aperçu de placement) voient la nouvelle version sans être recréées
+    void reloadAsset(const std::string &path);
+    std::vector<std::string> loadedAssets() const;
+    // Texture rechargée séparée de celle qu'elle partageait (Texture2D::Store) : relie ses matériaux
+    void retargetTexture(const std::string &path, unsigned int id);
+    // Importe sur la file de basse priorité du JobSystem, un asset à la fois et sur un seul thread,
+    // ceux d'une map pas encore ouverte ; son chargement les reprend sans réimport. Une nouvelle
+    // demande remplace la précédente.
+    void prefetchAssets(const std::vector<std::string>& paths);
+
     static void InstallDropHandler(GLFWwindow* window, ModelManager* mgr);
     static void DropCallback(GLFWwindow* window, int count, const char** paths);
 
 private:
-    std::vector<Entry> models;
+    Instances models;
+    // Modèles importés, partagés par toutes les instances d'un même fichier
+    std::map<std::string, std::weak_ptr<Model>> assets;
+    std::shared_ptr<Model> acquireModel(const std::string &path);
+    // Résout le modèle et l'échelle d'une instance (peut lever si l'import échoue)
+    void makeEntry(const ModelInstanceData& data, Entry& e);
+    // Importe en parallèle des assets absents de la mémoire ; les références rendues les gardent en vie
+    std::vector<std::shared_ptr<Model>> importAssets(const std::vector<std::string>& paths);
+    void startReload(const std::string &key, const std::shared_ptr<Model> &model);
+    // Rechargements en vol, et ceux redemandés entre-temps (fichier réécrit pendant l'import)
+    std::set<std::string> reloadsInFlight;
+    std::set<std::string> reloadsRequeued;
+    // Modèles préchargés, pas encore envoyés au GPU ; seuls ceux de la dernière demande sont gardés
+    std::map<std::string, std::shared_ptr<Model>> warmAssets;
+    std::vector<std::string> prefetchPaths;
+    // Partagé avec la tâche de préchargement, qui peut finir après la destruction du gestionnaire
+    std::shared_ptr<std::atomic<uint64_t>> prefetchGeneration = std::make_shared<std::atomic<uint64_t>>(0);
+    // Faux après la destruction du gestionnaire : vérifié par les rechargements avant de lire this
+    std::shared_ptr<std::atomic<bool>> alive = std::make_shared<std::atomic<bool>>(true);
+    std::shared_ptr<Model> takeWarm(const std::string &path);
+
+    // Signale à TextureResidency les textures du modèle et leur taille projetée
+    void touchTextures(const Model &model, float screenPixels) const;
+    float projectedSize(const Entry &e, float radius) const;
+    glm::vec3 viewerPosition = glm::vec3(0.0f);
+    float pixelsPerUnit = 0.0f;   // pixels couverts par une unité à distance 1
+
+    // Instances d'un modèle à nœuds : un appel instancié par maillage, tous nœuds confondus
+    void drawNodes(Model &model, size_t begin, size_t end, ShaderPermutations &shaders, unsigned int drawFeatures);
+
+    std::unique_ptr<StreamBuffer> instanceStream;
+    std::vector<size_t> drawOrder;
     glm::vec3 nextSpawnOffset = glm::vec3(2.0f, 0.0f, 0.0f);
     glm::vec3 basePosition = glm::vec3(0.0f, 0.0f, 0.0f);
     int count = 0;
     static ComponentLogger logger;
 
     std::optional<Entry> preview;
+
+    EditListener editListener;
+    void notifyEdit(InstanceEdit::Kind kind, size_t index);
+
+    struct HistoryStep {
+        Instances instances;
+        size_t bytes = 0;   // blocs recopiés depuis, que seul cet instantané retient
+    };
+    std::deque<HistoryStep> undoSteps;
+    std::deque<HistoryStep> redoSteps;
+    size_t historyUsed = 0;
+    static size_t historyBudget;
+    // À appeler avant chaque modification des instances
+    void pushHistory();
+    void clearHistory();
+    // Remplace les instances par un instantané et signale la différence comme des modifications
+    void restore(Instances target);
 };
 
 #endif
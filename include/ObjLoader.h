@@ -0,0 +1,39 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Mesh.h"
+
+// Chargeur Wavefront OBJ/MTL sans passer par Assimp.
+// Le fichier projeté en mémoire est découpé en blocs alignés sur les lignes, analysés en
+// parallèle sur le JobSystem ; les sommets identiques (v/vt/vn) sont ensuite fusionnés par une
+// table de hachage partitionnée, elle aussi parallèle (remplace aiProcess_JoinIdenticalVertices).
+// Un maillage par matériau. Sans appel OpenGL : utilisable depuis un thread de travail.
+class ObjLoader {
+public:
+    struct Material {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> textures;   // (type de texture, chemin)
+        float opacity = 1.0f;
+    };
+
+    struct Group {
+        int material = -1;             // index dans materials, -1 sans matériau
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    struct Scene {
+        std::vector<Group> groups;
+        std::vector<Material> materials;
+    };
+
+    static bool IsObj(const std::string &path);
+    // false si le fichier est illisible ou mal formé (l'appelant retombe alors sur Assimp)
+    static bool Load(const std::string &path, Scene &scene);
+};
+
+#endif // OBJ_LOADER_H
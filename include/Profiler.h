@@ -0,0 +1,150 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <GL/glew.h>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TraceCapture.h"
+
+// Profileur de frame : zones CPU hiérarchiques (thread principal) et zones GPU par requêtes
+// GL_TIME_ELAPSED. Sans profileur ni capture actifs, une zone ne coûte que deux tests de booléens.
+//
+// Les requêtes GL_TIME_ELAPSED ne peuvent pas s'imbriquer : une zone GPU ouverte pendant
+// une autre est ignorée. Leurs résultats sont lus avec quelques frames de retard pour ne
+// jamais bloquer le CPU en attendant le GPU.
+class Profiler {
+public:
+    struct Zone {
+        const char* name;
+        int depth;
+        double startMs;     // depuis le début de la frame
+        double durationMs;
+    };
+    struct GpuZone {
+        const char* name;
+        double durationMs;
+    };
+
+    static constexpr size_t HistorySize = 300;
+
+    static Profiler& Instance();
+    static bool IsEnabled() { return enabled; }
+    void setEnabled(bool on);
+
+    // À appeler au début et à la fin de chaque frame, depuis le thread GL
+    void beginFrame();
+    void endFrame();
+
+    void beginZone(const char* name);
+    void endZone();
+    void beginGpuZone(const char* name);
+    void endGpuZone();
+
+    // Données de la dernière frame terminée
+    const std::vector<Zone>& lastFrameZones() const { return lastZones; }
+    const std::vector<GpuZone>& lastGpuZones() const { return lastGpu; }
+    double lastFrameMs() const { return lastFrameDuration; }
+
+    // Historique circulaire des durées de frame (ms), `historyOffset()` pointe sur la plus ancienne
+    const std::array<float, HistorySize>& frameHistory() const { return history; }
+    size_t historyOffset() const { return historyNext; }
+    size_t historyCount() const { return historyFilled; }
+    // Percentile `p` (0..100) des frames de l'historique
+    float percentile(float p) const;
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Assez de frames en vol pour que le GPU ait fini quand on relit une frame
+    static constexpr size_t GpuLatency = 4;
+
+    struct GpuFrame {
+        std::vector<GLuint> queries;
+        std::vector<const char*> names;
+        size_t used = 0;
+        bool pending = false;
+    };
+
+    // Les requêtes GL ne sont pas détruites : le contexte n'existe plus à la sortie
+    Profiler() = default;
+    ~Profiler() = default;
+
+    double msSinceFrameStart() const;
+    void collectGpu(GpuFrame& frame);
+
+    static bool enabled;
+
+    std::thread::id mainThread;
+    Clock::time_point frameStart;
+    bool inFrame = false;
+
+    std::vector<Zone> zones;
+    std::vector<size_t> openZones;
+    std::vector<Zone> lastZones;
+    double lastFrameDuration = 0.0;
+
+    std::array<GpuFrame, GpuLatency> gpuFrames;
+    size_t gpuFrameIndex = 0;
+    int gpuNesting = 0;
+    bool gpuQueryActive = false;
+    std::vector<GpuZone> lastGpu;
+
+    std::array<float, HistorySize> history{};
+    size_t historyNext = 0;
+    size_t historyFilled = 0;
+};
+
+// Portées RAII utilisées via les macros ci-dessous. Une zone alimente le panneau du profileur
+// (thread principal) et, pendant une capture, la trace de tous les threads.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, const char* category = "frame")
+        : name(name), category(category),
+          profiling(Profiler::IsEnabled()), tracing(TraceCapture::IsCapturing()) {
+        if (profiling) Profiler::Instance().beginZone(name);
+        if (tracing) start = TraceCapture::Now();
+    }
+    ~ProfileScope() {
+        if (profiling) Profiler::Instance().endZone();
+        if (tracing) TraceCapture::Record(name, category, start, TraceCapture::Now());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+    const char* name;
+    const char* category;
+    bool profiling;
+    bool tracing;
+    uint64_t start = 0;
+};
+
+class GpuProfileScope {
+public:
+    explicit GpuProfileScope(const char* name) : active(Profiler::IsEnabled()) {
+        if (active) Profiler::Instance().beginGpuZone(name);
+    }
+    ~GpuProfileScope() {
+        if (active) Profiler::Instance().endGpuZone();
+    }
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+private:
+    bool active;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// `name` doit être une chaîne littérale : seul le pointeur est conservé
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#define PROFILE_ZONE_CAT(name, category) ProfileScope PROFILE_CONCAT(profileZone_, __LINE__)(name, category)
+#define PROFILE_GPU_ZONE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileZone_, __LINE__)(name)
+
+#endif // PROFILER_H
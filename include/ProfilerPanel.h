@@ -0,0 +1,22 @@
+#ifndef PROFILER_PANEL_H
+#define PROFILER_PANEL_H
+
+class Profiler;
+
+class ProfilerPanel {
+public:
+    explicit ProfilerPanel(Profiler* profiler);
+
+    void draw(bool* open = nullptr);
+    // Le profilage n'est actif que tant que le panneau est affiché
+    void setVisible(bool visible);
+    bool isVisible() const { return m_visible; }
+
+private:
+    bool m_visible = true;
+
+private:
+    Profiler* profiler = nullptr;
+};
+
+#endif // PROFILER_PANEL_H
@@ -2,6 +2,8 @@
 #define RENDERER_H
 
 class Shader;
+class ShaderPermutations;
+class SceneState;
 class ModelManager;
 class Grid;
 class Camera;
@@ -9,7 +11,7 @@ class EditorState;
 
 class Renderer {
 public:
-    void render(Shader& shader, ModelManager& modelManager, Grid& grid, const Camera& camera, float deltaTime, const EditorState& editorState);
+    void render(ShaderPermutations& modelShaders, Shader& gridShader, ModelManager& modelManager, Grid& grid, const Camera& camera, const SceneState& sceneState, const EditorState& editorState);
 };
 
 #endif // RENDERER_H
\ No newline at end of file
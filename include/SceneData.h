@@ -1,6 +1,7 @@
 #ifndef SCENE_DATA_H
 #define SCENE_DATA_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,14 @@ struct ModelInstanceData {
     bool autoScale = false; // Désactive la mise à l'échelle automatique par défaut
 };
 
+// Modification d'une instance signalée par ModelManager (journal de la map)
+struct InstanceEdit {
+    enum class Kind { Add, Update, Remove };
+    Kind kind = Kind::Update;
+    size_t index = 0;
+    ModelInstanceData data;   // état après l'ajout ou la mise à jour, vide pour une suppression
+};
+
 struct SceneSnapshot {
     DirectionalLightSettings light;
     EnvironmentSettings environment;
@@ -6,10 +6,22 @@
 
 #include "SceneData.h"
 
+// Format choisi par l'extension : .sbmap en binaire (BinaryMap), sinon JSON.
+// Les deux sont sans perte, une map se convertit en la rechargeant puis en l'écrivant.
+// Save remplace la map de façon atomique (AtomicFile).
 class SceneSerializer {
 public:
     static bool Save(const std::string& path, const SceneSnapshot& snapshot);
     static std::optional<SceneSnapshot> Load(const std::string& path);
+
+    static bool IsMapFile(const std::string& path);
+    // Garde une extension de map déjà présente, ajoute .json sinon
+    static std::string WithMapExtension(const std::string& name);
+    static void SetBinaryCompression(bool enabled) { compressBinary = enabled; }
+
+private:
+    static bool writeJson(const std::string& path, const SceneSnapshot& snapshot);
+    static bool compressBinary;
 };
 
 #endif // SCENE_SERIALIZER_H
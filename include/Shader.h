@@ -5,20 +5,26 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GpuHandle.h"
+
 class Shader
 {
 public:
     unsigned int ID;
     
-    Shader(const char* vertexPath, const char* fragmentPath);
-    ~Shader();
+    // `defines` est injecté sous forme de lignes #define juste après la directive #version
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = {});
     
     void use();
+
+    // false si la lecture, la compilation ou l'édition de liens a échoué
+    bool isValid() const { return valid; }
     
     // Utility uniform functions
     void setBool(const std::string &name, bool value) const;
@@ -35,7 +41,11 @@ public:
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
 private:
-    void checkCompileErrors(unsigned int shader, std::string type);
+    bool valid = false;
+    GlProgram program;   // possède ID
+
+    bool checkCompileErrors(unsigned int shader, std::string type);
+    static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines);
 };
 
 #endif
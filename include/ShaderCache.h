@@ -0,0 +1,35 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+#include "Log.h"
+
+// Cache disque des programmes liés (glGetProgramBinary / glProgramBinary).
+// La clé couvre les sources, le jeu de #define et l'identité du driver : tout
+// changement de l'un d'eux produit une autre entrée et donc une recompilation.
+class ShaderCache {
+public:
+    static bool IsSupported();
+
+    static std::string MakeKey(const std::string& vertexSource,
+                               const std::string& fragmentSource,
+                               const std::vector<std::string>& defines);
+
+    // Renvoie un programme prêt à l'emploi, ou 0 si absent/incompatible.
+    static GLuint Load(const std::string& key);
+    static void Store(const std::string& key, GLuint program);
+
+    static void SetDirectory(const std::string& dir) { directory = dir; }
+
+private:
+    static std::string driverIdentity();
+    static std::string pathFor(const std::string& key);
+
+    static std::string directory;
+    static ComponentLogger logger;
+};
+
+#endif // SHADER_CACHE_H
@@ -0,0 +1,71 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "Log.h"
+
+// Bits de fonctionnalités d'une variante ; chacun devient un #define dans les sources GLSL
+namespace ShaderFeature {
+    enum : unsigned int {
+        None       = 0,
+        Diffuse    = 1u << 0,   // HAS_DIFFUSE
+        Specular   = 1u << 1,   // HAS_SPECULAR
+        NormalMap  = 1u << 2,   // HAS_NORMAL_MAP
+        Instancing = 1u << 3,   // USE_INSTANCING
+        Highlight  = 1u << 4,   // HAS_HIGHLIGHT
+        Alpha      = 1u << 5,   // HAS_ALPHA
+
+        // Bits décidés par le matériau au chargement (les autres le sont au moment du dessin)
+        MaterialMask = Diffuse | Specular | NormalMap | Alpha
+    };
+}
+
+// Ensemble des variantes compilées d'un même couple vertex/fragment shader.
+// Les variantes sont compilées à la première demande (le cache binaire rend ça quasi gratuit
+// aux lancements suivants) et reçoivent les uniforms communs de la frame à leur première
+// utilisation dans celle-ci.
+class ShaderPermutations {
+public:
+    using FrameSetup = std::function<void(Shader&)>;
+
+    ShaderPermutations(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // Active et renvoie la variante correspondant à `features`
+    Shader& get(unsigned int features);
+
+    // `setup` est appelé une fois par frame et par variante utilisée (matrices, lumière...)
+    void beginFrame(FrameSetup setup);
+
+    // Recompile toutes les variantes existantes ; si l'une échoue, les anciennes restent en place
+    bool reload();
+
+    size_t variantCount() const { return variants.size(); }
+    const std::string& vertexFile() const { return vertexPath; }
+    const std::string& fragmentFile() const { return fragmentPath; }
+
+    static std::vector<std::string> DefinesFor(unsigned int features);
+
+private:
+    std::unique_ptr<Shader> compile(unsigned int features) const;
+
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        unsigned long long frame = 0;
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::map<unsigned int, Variant> variants;
+    FrameSetup frameSetup;
+    unsigned long long frameIndex = 0;
+
+    static ComponentLogger logger;
+};
+
+#endif // SHADER_PERMUTATIONS_H
@@ -0,0 +1,67 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Log.h"
+#include "GpuHandle.h"
+
+// Tampon circulaire pour les données réécrites à chaque frame (transforms d'instances,
+// commandes de dessin, géométrie de debug). Le stockage est découpé en FrameCount régions :
+// le CPU écrit dans la région courante pendant que le GPU consomme les précédentes,
+// chaque région étant protégée par une fence posée en fin de frame.
+class StreamBuffer {
+public:
+    static constexpr int FrameCount = 3;
+
+    StreamBuffer(GLenum target, size_t bytesPerFrame);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Réserve `size` octets dans la région de la frame courante. Renvoie nullptr si la
+    // région est pleine. `outOffset` est l'offset à passer aux appels GL (glVertexAttribPointer...).
+    // Le pointeur reste valide jusqu'à unmap().
+    void* map(size_t size, size_t alignment, GLintptr& outOffset);
+    // Sans effet en mode persistant ; obligatoire avant le dessin en mode glMapBufferRange.
+    void unmap();
+
+    GLuint id() const { return buffer.get(); }
+    GLenum target() const { return bindTarget; }
+    size_t capacityPerFrame() const { return regionSize; }
+    // Octets encore réservables dans la région de la frame courante
+    size_t available() const { return regionSize - std::min(regionOffset, regionSize); }
+    bool isPersistent() const { return persistent; }
+
+    // Pose les fences de toutes les régions écrites et passe à la frame suivante.
+    // À appeler une fois par frame, après les derniers dessins qui lisent les tampons.
+    static void EndFrameAll();
+    static size_t BytesStreamedLastFrame() { return lastFrameBytes; }
+
+private:
+    GLenum bindTarget;
+    GlBuffer buffer;
+    size_t regionSize = 0;
+    bool persistent = false;
+    unsigned char* persistentPtr = nullptr;
+    bool mapped = false;
+
+    int region = 0;
+    size_t regionOffset = 0;
+    bool regionReady = false;
+    GLsync fences[FrameCount] = {};
+
+    void waitRegion();
+    void endFrame();
+
+    static std::vector<StreamBuffer*> instances;
+    static size_t frameBytes;
+    static size_t lastFrameBytes;
+    static ComponentLogger logger;
+};
+
+#endif // STREAM_BUFFER_H
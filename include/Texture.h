@@ -2,19 +2,86 @@
 #define TEXTURE2D_H
 
 #include <GL/glew.h>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 #include "Log.h"
+#include "GpuHandle.h"
 
 class Texture2D {
 public:
     enum class Format { Auto, SRGB, RGB, RGBA };
+    // Appelé quand un chemin déjà rendu par Load ou Store désigne une autre texture
+    using RelinkHandler = std::function<void(const std::string &fullPath, GLuint id)>;
 
+    // Pixels décodés en mémoire, prêts à être envoyés au GPU
+    struct Image {
+        int width = 0, height = 0, channels = 0;
+        std::shared_ptr<unsigned char> pixels;
+        // Image intégrée : octets encodés d'origine, pour la redécoder sans fichier sur disque
+        std::shared_ptr<const std::vector<unsigned char>> encoded;
+        bool valid() const { return pixels != nullptr; }
+    };
+
+    // Avec la diffusion active, rend tout de suite un identifiant portant un texel provisoire :
+    // le décodage se fait en arrière-plan et les niveaux arrivent au fil des frames
     static GLuint Load(const std::string &fullPath, bool flipY = true, Format fmt = Format::Auto);
     static void ClearCache();
+    static void SetStreaming(bool enabled) { streaming = enabled; }
+    static bool IsStreaming() { return streaming; }
+    // Les utilisateurs de l'ancien identifiant (matériaux) doivent passer au nouveau
+    static void SetRelinkHandler(RelinkHandler handler) { relinkHandler = std::move(handler); }
+
+    // Décodage seul, sans appel OpenGL : utilisable depuis un thread de travail
+    static Image Decode(const std::string &fullPath, bool flipY = true);
+    // Image encodée en mémoire (texture intégrée à un GLB) ; `key` sert de nom dans le cache
+    static Image DecodeMemory(const std::string &key, const unsigned char *bytes, size_t size, bool flipY = true);
+    // Envoie `image` sous `fullPath` ; si la texture est déjà en cache, son contenu est remplacé
+    // en gardant le même identifiant pour que les matériaux qui la référencent suivent. Si elle
+    // est partagée avec un fichier de même contenu, elle reste à ce dernier et `fullPath` reçoit
+    // une nouvelle texture : l'identifiant rendu diffère et le RelinkHandler est appelé.
+    static GLuint Store(const std::string &fullPath, const Image &image);
+    // Texture diffusée dont l'empreinte vient d'être calculée avec le décodage : si un fichier
+    // identique est en cache, `fullPath` devient un alias de sa texture et le RelinkHandler est
+    // appelé (true) ; sinon son contenu est retenu pour les fichiers suivants
+    static bool ShareStreamed(const std::string &fullPath, uint64_t hash, const Image &image);
+    static std::vector<std::string> CachedPaths();
+    // Remplace le contenu d'une texture déjà en cache sans la réenregistrer auprès de
+    // TextureResidency (niveau réduit ou texel de remplacement)
+    static bool Replace(const std::string &fullPath, const Image &image);
+    // Réduction par moyenne 2x2 répétée `levels` fois, sans appel OpenGL
+    static Image Downscale(const Image &image, int levels);
+    // Référence partagée sur la texture en cache : la garder maintient l'objet GL vivant
+    // même après ClearCache()
+    static std::shared_ptr<GlTexture> Find(const std::string &fullPath);
+    // Texture hors cache (ni partage, ni résidence), détruite avec sa dernière référence : aperçus
+    static std::shared_ptr<GlTexture> CreateUncached(const Image &image, const std::string &owner);
+    // Mémoire GPU évitée par les textures de contenu identique partagées entre fichiers
+    static size_t SharedBytes() { return sharedBytes; }
 
 private:
-    static std::map<std::string, GLuint> cache;
+    // Nouvelle texture en cache, sans recherche de contenu identique
+    static GLuint create(const std::string &fullPath, const Image &image);
+    // Empreinte, partage éventuel avec un fichier identique, sinon nouvelle texture
+    static GLuint storeNew(const std::string &fullPath, const Image &image);
+    static void relink(const std::string &fullPath, GLuint id);
+    // Si un fichier de même contenu est déjà en cache, `fullPath` devient un alias de sa texture
+    static GLuint shareIdentical(const std::string &fullPath, uint64_t hash, size_t gpuBytes);
+    static void rememberContent(const std::string &fullPath, uint64_t hash);
+    static void adopt(Image &image, unsigned char *data, const std::string &owner);
+    // Paramètres d'échantillonnage posés tout de suite, pixels confiés à UploadScheduler
+    static bool upload(const std::shared_ptr<GlTexture> &texture, const Image &image);
+
+    static std::map<std::string, std::shared_ptr<GlTexture>> cache;
+    // Empreinte du fichier -> premier chemin chargé avec ce contenu, et l'inverse
+    static std::map<uint64_t, std::string> contents;
+    static std::map<std::string, uint64_t> contentOf;
+    static size_t sharedBytes;
+    static bool streaming;
+    static RelinkHandler relinkHandler;
     static ComponentLogger logger;
 };
 
@@ -0,0 +1,105 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Log.h"
+#include "Texture.h"
+
+// Résidence des textures du cache Texture2D sous un budget de VRAM.
+// Chaque texture garde son identifiant GL : sous pression, son niveau 0 est remplacé par une
+// version réduite (niveau de mip inférieur, redécodée en arrière-plan), et en dernier recours
+// par un texel de sa couleur moyenne. Elle remonte en résolution quand elle redevient visible.
+// Les nouvelles textures sont diffusées progressivement : un petit niveau d'abord, puis le niveau
+// voulu, redécodé depuis le fichier, les envois étant plafonnés par frame et ordonnés par taille
+// à l'écran. Aucune image complète n'est gardée en mémoire après le premier envoi.
+// Thread GL uniquement : les décodages passent par JobSystem et reviennent via runOnMainThread.
+class TextureResidency {
+public:
+    struct Stats {
+        size_t budget = 0;
+        size_t resident = 0;      // octets estimés à la résolution actuelle
+        size_t full = 0;          // octets si tout était à pleine résolution
+        size_t textures = 0;
+        size_t demoted = 0;
+        size_t evicted = 0;
+        size_t loading = 0;
+        size_t queuedUploads = 0;
+    };
+
+    static void SetBudget(size_t bytes);
+    static size_t Budget() { return budget; }
+    // Octets envoyés au GPU par frame pour les montées de résolution (au moins un envoi par frame)
+    static void SetUploadBudget(size_t bytesPerFrame) { uploadBudget = bytesPerFrame; }
+
+    // Niveau de la première image envoyée d'une texture diffusée (plus grand côté <= 32)
+    static int InitialLevel(int width, int height);
+
+    // Appelé par Texture2D::Store après l'envoi de `image` réduite de `uploadedLevel` niveaux.
+    // `image` sert aux dimensions et à la couleur moyenne, elle n'est pas conservée.
+    static void Register(const std::string& fullPath, GLuint id, const Texture2D::Image& image, int uploadedLevel = 0);
+    // Texture créée avec un texel provisoire : décodage en arrière-plan puis diffusion
+    static void Stream(const std::string& fullPath, GLuint id, bool flipY);
+    // La texture `id` appartient désormais à `fullPath` (autre fichier de même contenu) : ses
+    // niveaux seront relus depuis ce fichier
+    static void Rename(GLuint id, const std::string& fullPath);
+    static void Clear();
+
+    // Signale l'utilisation de la texture dans la frame, `screenPixels` étant la taille
+    // projetée à l'écran (en pixels) de l'objet qui la porte
+    static void Touch(GLuint id, float screenPixels);
+
+    // À appeler une fois par frame : rétrograde, évince ou recharge selon le budget
+    static void Update();
+
+    static Stats GetStats();
+
+private:
+    static const int Evicted = -1;
+
+    struct Entry {
+        std::string path;
+        int width = 0, height = 0, channels = 0;
+        int level = 0;             // niveau de mip servant de niveau 0, Evicted si évincée
+        int maxLevel = 0;          // plus petit niveau autorisé avant éviction
+        int pendingLevel = -2;     // niveau en cours de décodage, -2 si aucun
+        bool sourceMissing = false; // fichier illisible : ni rétrogradation ni éviction
+        bool decoding = false;     // premier décodage en cours, dimensions encore inconnues
+        bool flipY = true;
+        std::shared_ptr<const std::vector<unsigned char>> encoded;   // image intégrée, sans fichier
+        uint64_t lastUsed = 0;
+        float coverage = 0.0f;     // taille projetée maximale sur la dernière frame d'utilisation
+        unsigned char placeholder[4] = {128, 128, 128, 255};
+    };
+
+    static size_t bytesAt(const Entry& entry, int level);
+    static int wantedLevel(const Entry& entry);
+    static void requestLevel(GLuint id, Entry& entry, int level);
+    static void finishLevel(GLuint id, const std::string& path, int level, const Texture2D::Image& image);
+    static void applyLevel(Entry& entry, int level, const Texture2D::Image& image);
+    static void uploadReady();
+    static void evict(Entry& entry);
+
+    // Niveaux décodés en attente d'envoi, consommés par uploadReady() sous uploadBudget
+    struct ReadyLevel {
+        GLuint id;
+        std::string path;
+        int level;
+        Texture2D::Image image;
+    };
+
+    static std::unordered_map<GLuint, Entry> entries;
+    static std::vector<ReadyLevel> ready;
+    static size_t budget;
+    static size_t uploadBudget;
+    static uint64_t frame;
+    static ComponentLogger logger;
+};
+
+#endif // TEXTURE_RESIDENCY_H
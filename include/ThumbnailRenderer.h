@@ -0,0 +1,105 @@
+#ifndef THUMBNAIL_RENDERER_H
+#define THUMBNAIL_RENDERER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GpuHandle.h"
+#include "Log.h"
+
+class Model;
+class ModelManager;
+class ShaderPermutations;
+
+// Vignettes des modèles et des maps pour les panneaux de l'interface.
+// Les demandes sont servies une à la fois, les plus récentes d'abord, sur la file de basse priorité
+// du JobSystem : l'empreinte du fichier (xxHash64) désigne l'image du cache disque (<hash>.tga).
+// Si elle n'existe pas, le modèle est importé hors du thread GL puis rendu dans un FBO, cadré sur
+// sa boîte englobante, et l'image est écrite dans le cache. Ses textures ne rejoignent pas le
+// cache de Texture2D et sont libérées avec lui après le rendu.
+// Les maps ne sont pas rendues à la demande : leur vignette est capturée depuis la scène ouverte
+// quand elles sont sauvegardées ou chargées.
+class ThumbnailRenderer {
+public:
+    static constexpr int Size = 128;
+
+    explicit ThumbnailRenderer(ShaderPermutations &shaders);
+
+    // Texture de la vignette (lignes de bas en haut), 0 tant qu'elle n'est pas prête. Seules les
+    // vignettes demandées à la frame courante ou à la précédente restent en file ; celles qui ne
+    // sont plus demandées sont libérées au bout de quelques secondes et rechargées du cache disque.
+    GLuint modelThumbnail(const std::string &path);
+    GLuint mapThumbnail(const std::string &mapPath);
+    // Vignette de mapPath rendue depuis la scène courante dès que ses envois GPU sont terminés
+    void captureMap(const std::string &mapPath, ModelManager &scene);
+
+    // Début de frame, avant ShaderPermutations::beginFrame : au plus un rendu par frame
+    void update();
+
+    static void SetDirectory(const std::string &dir) { directory = dir; }
+
+    ThumbnailRenderer(const ThumbnailRenderer &) = delete;
+    ThumbnailRenderer &operator=(const ThumbnailRenderer &) = delete;
+
+private:
+    enum class State { Idle, Queued, Loading, Ready, Missing };
+    struct Slot {
+        State state = State::Idle;
+        bool map = false;
+        GlTexture texture;
+        uint64_t wanted = 0;   // dernière frame où la vignette a été demandée
+    };
+    // Modèle importé en arrière-plan, rendu quand ses maillages et textures sont sur le GPU
+    struct PendingRender {
+        std::string path;
+        std::string cacheFile;
+        std::shared_ptr<Model> model;
+        uint64_t since = 0;
+    };
+    struct PendingCapture {
+        std::string mapPath;
+        ModelManager *scene = nullptr;
+        uint64_t since = 0;
+    };
+
+    GLuint request(const std::string &path, bool map);
+    void start(const std::string &path, bool map);
+    // pixels nul : vignette introuvable
+    void finish(const std::string &path, const unsigned char *pixels, int width, int height, int channels);
+    bool uploadsSettled(uint64_t since) const;
+    // Libère les vignettes prêtes les moins récemment demandées (ancienneté, puis nombre)
+    void evictUnused();
+    // Rend draw() dans le FBO depuis une caméra qui cadre [minBounds, maxBounds] ; pixels RGBA
+    bool render(const glm::vec3 &minBounds, const glm::vec3 &maxBounds, const std::function<void()> &draw,
+                std::vector<unsigned char> &pixels);
+    bool ensureTarget();
+
+    static std::string CacheFile(uint64_t hash);
+    static bool WriteTga(const std::string &path, const std::vector<unsigned char> &pixels, int width, int height);
+
+    ShaderPermutations &shaders;
+    std::map<std::string, Slot> slots;
+    std::deque<std::string> queue;
+    bool busy = false;
+    std::unique_ptr<PendingRender> pendingRender;
+    std::unique_ptr<PendingCapture> pendingCapture;
+    uint64_t frame = 0;
+
+    GlFramebuffer framebuffer;
+    GlTexture colorTarget;
+    GlRenderbuffer depthTarget;
+    bool targetFailed = false;
+
+    static std::string directory;
+    static ComponentLogger logger;
+};
+
+#endif // THUMBNAIL_RENDERER_H
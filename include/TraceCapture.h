@@ -0,0 +1,53 @@
+#ifndef TRACE_CAPTURE_H
+#define TRACE_CAPTURE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Log.h"
+
+// Capture de toutes les zones PROFILE_ZONE, sur tous les threads, pendant un nombre de frames
+// ou une durée donnés, puis export au format Chrome trace-event (ouvrable dans Perfetto ou
+// chrome://tracing) dans logs/.
+//
+// L'enregistrement est sans verrou : chaque événement réserve sa case par un fetch_add sur un
+// tampon préalloué ; une fois plein, les événements suivants sont comptés puis ignorés.
+class TraceCapture {
+public:
+    // Démarre une capture ; `frames` ou `seconds` à 0 signifie sans limite de ce côté
+    static bool Start(int frames, double seconds = 0.0);
+    static bool IsCapturing() { return capturing.load(std::memory_order_relaxed); }
+
+    // Horloge des événements, en microsecondes
+    static uint64_t Now();
+    // `name` et `category` doivent rester valides jusqu'à l'écriture : chaînes littérales
+    static void Record(const char* name, const char* category, uint64_t startUs, uint64_t endUs);
+
+    // Nom affiché pour le thread appelant (à appeler une fois au démarrage du thread)
+    static void SetThreadName(const std::string& name);
+
+    // À appeler en fin de frame depuis le thread principal : termine la capture quand la limite
+    // est atteinte et écrit le fichier depuis un thread de travail
+    static void EndFrame();
+
+private:
+    struct Event;
+
+    static uint32_t threadIndex();
+    static void finish();
+    static void write(const std::string& path, size_t count);
+
+    static std::atomic<bool> capturing;
+    static std::atomic<bool> writing;
+    static std::atomic<size_t> nextEvent;
+    static std::atomic<size_t> dropped;
+    static std::unique_ptr<Event[]> events;
+    static int framesLeft;
+    static uint64_t deadlineUs;
+
+    static ComponentLogger logger;
+};
+
+#endif // TRACE_CAPTURE_H
@@ -10,14 +10,14 @@
 
 #include <GLFW/glfw3.h>
 
+#include "AssetDatabase.h"
 #include "ModelManager.h"
 #include "Log.h"
 
 class UiModelBrowser {
 public:
-    UiModelBrowser(ModelManager* mgr, const std::string& rootDir)
-        : manager(mgr), root(rootDir), visible(false), selected(0) {
-        loadFiles();
+    UiModelBrowser(ModelManager* mgr, const AssetDatabase* assetDb)
+        : manager(mgr), assets(assetDb), visible(false), selected(0) {
         refreshMatches();
         lastKeyState.clear();
     }
@@ -27,6 +27,7 @@ public:
 
     void handleInput(GLFWwindow* window) {
         if (!visible) return;
+        if (assets && assets->version() != filesVersion) { refreshMatches(); dirty = true; }
         // Navigation
         onKeyEdge(window, GLFW_KEY_UP, [&]{ if (selected > 0) { selected--; dirty = true; } });
         onKeyEdge(window, GLFW_KEY_DOWN, [&]{ if (selected + 1 < (int)matches.size()) { selected++; dirty = true; } });
@@ -52,47 +53,23 @@ public:
 
 private:
     ModelManager* manager;
-    std::string root;
+    const AssetDatabase* assets;
     bool visible;
     bool dirty = false;
     std::string query;
-    std::vector<std::string> files;      // all candidate model files
+    std::shared_ptr<const AssetDatabase::Index> files;   // all candidate model files
+    uint64_t filesVersion = 0;
     std::vector<std::string> matches;    // filtered by query
     int selected;
     std::unordered_map<int,bool> lastKeyState;
     ComponentLogger logger{"UI"};
 
-    void loadFiles() {
-        files.clear();
-        namespace fs = std::filesystem;
-        std::error_code ec;
-        if (!fs::exists(root, ec)) return;
-        for (auto& p : fs::recursive_directory_iterator(root, ec)) {
-            if (p.is_regular_file()) {
-                auto ext = p.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                if (ext == ".obj" || ext == ".fbx" || ext == ".dae" || ext == ".gltf" || ext == ".glb") {
-                    files.push_back(p.path().string());
-                }
-            }
-        }
-        std::sort(files.begin(), files.end());
-    }
-
-    static std::string lower(std::string s) {
-        std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-        return s;
-    }
-
     void refreshMatches() {
         matches.clear();
-        if (query.empty()) {
-            matches = files;
-        } else {
-            auto q = lower(query);
-            for (auto& f : files) {
-                if (lower(f).find(q) != std::string::npos) matches.push_back(f);
-            }
+        if (assets) {
+            files = assets->index();
+            filesVersion = assets->version();
+            for (uint32_t i : files->search(query)) matches.push_back(files->entries()[i].path);
         }
         if (selected >= (int)matches.size()) selected = (int)matches.size() - 1;
         if (selected < 0) selected = 0;
@@ -100,7 +77,7 @@ private:
 
     void dumpToConsole() {
         std::cout << "\n=== Model Browser (type to filter, UP/DOWN select, ENTER=OK, BACKSPACE=del, E=close) ===\n";
-        std::cout << "Root: " << root << " | Query: '" << query << "'\n";
+        std::cout << "Root: " << (assets ? assets->root() : std::string()) << " | Query: '" << query << "'\n";
         int show = std::min((int)matches.size(), 15);
         for (int i = 0; i < show; ++i) {
             std::cout << (i == selected ? "> " : "  ") << matches[i] << "\n";
@@ -13,10 +13,14 @@ class SceneState;
 class EditorState;
 
 class ModelManager;
+class AssetDatabase;
+class ThumbnailRenderer;
 class ModelBrowserPanel;
 class CustomButtonsPanel;
 class ScenePanel;
 class MapPanel;
+class ProfilerPanel;
+class MemoryPanel;
 
 class UiOverlay {
 public:
@@ -34,6 +38,10 @@ public:
               const std::function<bool(const std::string&)>& loadCb,
               const std::function<bool(const std::string&)>& newCb);
     void shutdown();
+    // Vignettes des modèles et des maps ; après init()
+    void setThumbnails(ThumbnailRenderer* renderer);
+    // Fin d'écriture d'une map : son résumé dans le panneau Maps est relu
+    void mapSaved(const std::string& path);
 
     void toggleVisible();
     bool isVisible() const { return visible; }
@@ -48,6 +56,8 @@ public:
     void showOnlyModelBrowser();
     void showOnlyScenePanel();
     void showOnlyCustomButtons();
+    // Profileur et comptabilité mémoire (entrée "Infos/Logs" du menu radial)
+    void showOnlyInfoPanels();
 
 private:
     // Fonction utilitaire pour dessiner un bouton de menu radial
@@ -59,10 +69,16 @@ private:
     SceneState* scene = nullptr;
     EditorState* editor = nullptr;
 
+    // Fichiers des dossiers de modèles et de maps, indexés en arrière-plan pour les panneaux
+    std::unique_ptr<AssetDatabase> modelAssets;
+    std::unique_ptr<AssetDatabase> mapAssets;
+
     std::unique_ptr<ModelBrowserPanel> browser;
     std::unique_ptr<CustomButtonsPanel> buttons;
     std::unique_ptr<ScenePanel> scenePanel;
     std::unique_ptr<MapPanel> mapPanel;
+    std::unique_ptr<ProfilerPanel> profilerPanel;
+    std::unique_ptr<MemoryPanel> memoryPanel;
 };
 
 #endif // UI_OVERLAY_H
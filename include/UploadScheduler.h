@@ -0,0 +1,92 @@
+#ifndef UPLOAD_SCHEDULER_H
+#define UPLOAD_SCHEDULER_H
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "GpuHandle.h"
+#include "Log.h"
+#include "StreamBuffer.h"
+
+// Envois GPU étalés sur les frames.
+// Les contenus de buffers et de textures sont mis en file (depuis n'importe quel thread), puis
+// copiés par process() dans un anneau de staging (StreamBuffer sur GL_PIXEL_UNPACK_BUFFER, régions
+// recyclées par fences) et transférés par glCopyBufferSubData / glTexImage2D depuis le PBO,
+// dans la limite d'un budget d'octets et de temps par frame.
+// Les buffers trop gros pour une frame sont découpés ; une texture plus grosse que l'anneau
+// est envoyée seule dans sa frame, directement depuis la mémoire CPU.
+class UploadScheduler {
+public:
+    // Suivi d'un groupe d'envois de buffers (ex. VBO + EBO d'un maillage).
+    // Le détenteur ne dessine qu'une fois done() ; s'il libère le ticket, les envois restants
+    // sont abandonnés (ses buffers ont pu être supprimés entre-temps).
+    struct Ticket {
+        std::atomic<int> pending{0};
+        bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    struct Stats {
+        size_t bytesLastFrame = 0;
+        double microsLastFrame = 0.0;
+        size_t queuedJobs = 0;
+        size_t queuedBytes = 0;
+    };
+
+    static UploadScheduler& Instance();
+
+    // Le stockage de `buffer` doit déjà être alloué (glBufferData avec nullptr)
+    void uploadBuffer(const std::shared_ptr<Ticket>& ticket, GLuint buffer, const void* data, size_t bytes);
+    // Remplace le niveau 0 de la texture puis régénère ses mipmaps ; abandonné si la texture
+    // est détruite avant son tour
+    void uploadTexture(const std::shared_ptr<GlTexture>& texture, int width, int height,
+                       GLenum internalFormat, GLenum format, std::shared_ptr<unsigned char> pixels);
+
+    // À appeler une fois par frame depuis le thread GL, avant les dessins
+    void process();
+    // Libère l'anneau de staging tant que le contexte existe
+    void shutdown();
+
+    void setBudget(size_t bytesPerFrame, double microsPerFrame);
+    Stats stats() const;
+
+    UploadScheduler(const UploadScheduler&) = delete;
+    UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+private:
+    UploadScheduler() = default;
+
+    struct Job {
+        enum Kind { Buffer, Texture } kind = Buffer;
+        std::weak_ptr<void> owner;      // ticket ou texture : job abandonné s'il a disparu
+        GLuint buffer = 0;
+        std::shared_ptr<const unsigned char> data;
+        size_t bytes = 0;
+        size_t offset = 0;              // octets déjà transférés (buffers découpés)
+        int width = 0, height = 0;
+        GLenum internalFormat = GL_RGBA, format = GL_RGBA;
+    };
+
+    bool runBuffer(Job& job, size_t& frameBytes);
+    bool runTexture(Job& job, size_t& frameBytes);
+
+    std::mutex incomingMutex;
+    std::vector<Job> incoming;
+    std::deque<Job> queue;
+    std::unique_ptr<StreamBuffer> staging;
+
+    size_t budgetBytes = 16u * 1024u * 1024u;
+    double budgetMicros = 2000.0;
+    size_t lastBytes = 0;
+    double lastMicros = 0.0;
+    size_t queuedBytes = 0;
+
+    static ComponentLogger logger;
+};
+
+#endif // UPLOAD_SCHEDULER_H
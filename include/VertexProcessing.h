@@ -0,0 +1,17 @@
+#ifndef VERTEX_PROCESSING_H
+#define VERTEX_PROCESSING_H
+
+#include <vector>
+
+#include "Mesh.h"
+
+// Traitements de sommets des lecteurs intégrés, en remplacement des post-traitements Assimp
+class VertexProcessing {
+public:
+    // Normales lissées quand le fichier n'en fournit pas (équivalent de aiProcess_GenNormals)
+    static void GenerateNormals(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+    // Tangentes par triangle accumulées (équivalent de aiProcess_CalcTangentSpace)
+    static void GenerateTangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+};
+
+#endif // VERTEX_PROCESSING_H
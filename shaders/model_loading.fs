@@ -2,15 +2,26 @@
 out vec4 FragColor;
 
 in vec3 FragPos;
-in vec3 Normal;
 in vec2 TexCoords;
+#ifdef HAS_NORMAL_MAP
+in mat3 TBN;
+#else
+in vec3 Normal;
+#endif
 
 // Structure pour les propriétés du matériau
+// Les textures présentes sont connues à la compilation (HAS_DIFFUSE, HAS_SPECULAR, HAS_NORMAL_MAP)
 struct Material {
+#ifdef HAS_DIFFUSE
     sampler2D texture_diffuse1;
+#endif
+#ifdef HAS_SPECULAR
     sampler2D texture_specular1;
-    bool hasDiffuse;
-    bool hasSpecular;
+#endif
+#ifdef HAS_NORMAL_MAP
+    sampler2D texture_normal1;
+#endif
+    float opacity;
 };
 
 // Structure pour la lumière directionnelle
@@ -26,32 +37,31 @@ uniform Material material;
 uniform DirectionalLight dirLight;
 uniform vec3 viewPos;
 uniform float environmentAmbientBoost;
-uniform bool highlightActive;
+#ifdef HAS_HIGHLIGHT
 uniform vec3 highlightColor;
+#endif
 
 void main()
 {
-    // Couleurs par défaut
+#ifdef HAS_DIFFUSE
+    vec4 diffuseSample = texture(material.texture_diffuse1, TexCoords);
+    vec3 diffuseColor = diffuseSample.rgb;
+#else
     vec3 diffuseColor = vec3(0.8, 0.8, 0.8); // Couleur grise par défaut
-    vec3 specularColor = vec3(0.2, 0.2, 0.2); // Couleur spéculaire par défaut plus foncée
-    
-    // Charger les textures si disponibles
-    if (material.hasDiffuse) {
-        diffuseColor = texture(material.texture_diffuse1, TexCoords).rgb;
-    } else {
-        // Si pas de texture diffuse, utiliser une couleur unie
-        diffuseColor = vec3(0.8, 0.8, 0.8);
-    }
-    
-    if (material.hasSpecular) {
-        specularColor = texture(material.texture_specular1, TexCoords).rgb;
-    } else {
-        // Si pas de texture spéculaire, utiliser une valeur basse
-        specularColor = vec3(0.2, 0.2, 0.2);
-    }
+#endif
+
+#ifdef HAS_SPECULAR
+    vec3 specularColor = texture(material.texture_specular1, TexCoords).rgb;
+#else
+    vec3 specularColor = vec3(0.2, 0.2, 0.2); // Valeur basse sans texture spéculaire
+#endif
 
     // Calcul de la lumière (Blinn-Phong)
+#ifdef HAS_NORMAL_MAP
+    vec3 norm = normalize(TBN * (texture(material.texture_normal1, TexCoords).rgb * 2.0 - 1.0));
+#else
     vec3 norm = normalize(Normal);
+#endif
     vec3 lightDir = normalize(-dirLight.direction);
     vec3 viewDir = normalize(viewPos - FragPos);
     vec3 halfDir = normalize(lightDir + viewDir);
@@ -68,12 +78,21 @@ void main()
     // Combinaison finale
     vec3 result = ambient + diffuse + specular;
 
-    if (highlightActive) {
-        result = mix(result, highlightColor, 0.5);
-    }
+#ifdef HAS_HIGHLIGHT
+    result = mix(result, highlightColor, 0.5);
+#endif
     
     // Correction gamma
     result = pow(result, vec3(1.0/2.2));
-    
+
+#ifdef HAS_ALPHA
+    float alpha = material.opacity;
+#ifdef HAS_DIFFUSE
+    alpha *= diffuseSample.a;
+#endif
+    if (alpha < 0.01) discard;
+    FragColor = vec4(result, alpha);
+#else
     FragColor = vec4(result, 1.0);
+#endif
 }
@@ -2,20 +2,46 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#ifdef HAS_NORMAL_MAP
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+#endif
+#ifdef USE_INSTANCING
+layout (location = 5) in mat4 aInstanceModel;
+layout (location = 9) in mat3 aInstanceNormal;
+#endif
 
 out vec3 FragPos;
-out vec3 Normal;
 out vec2 TexCoords;
+#ifdef HAS_NORMAL_MAP
+out mat3 TBN;
+#else
+out vec3 Normal;
+#endif
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+#ifndef USE_INSTANCING
+uniform mat4 model;
+uniform mat3 normalMatrix; // transpose(inverse(model)), calculée côté CPU
+#endif
 
 void main()
 {
+#ifdef USE_INSTANCING
+    mat4 model = aInstanceModel;
+    mat3 normalMatrix = aInstanceNormal;
+#endif
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
     TexCoords = aTexCoords;
-    
+#ifdef HAS_NORMAL_MAP
+    vec3 T = normalize(mat3(model) * aTangent);
+    vec3 B = normalize(mat3(model) * aBitangent);
+    vec3 N = normalize(normalMatrix * aNormal);
+    TBN = mat3(T, B, N);
+#else
+    Normal = normalMatrix * aNormal;
+#endif
+
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
@@ -1,4 +1,5 @@
 #include "App.h"
+#include "StreamBuffer.h"
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -27,7 +28,8 @@ bool App::init(unsigned int width, unsigned int height, const char* title) {
     glfwSetScrollCallback(window.getGLFW(), scroll_callback);
 
     // Shaders
-    ourShader = Shader("../shaders/model.vs", "../shaders/model.fs");
+    modelShaders = std::make_unique<ShaderPermutations>("../shaders/model_loading.vs", "../shaders/model_loading.fs");
+    gridShader = std::make_unique<Shader>("../shaders/grid.vs", "../shaders/grid.fs");
 
     // Grille
     grid = Grid();
@@ -72,10 +74,11 @@ int App::run() {
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        renderer.render(ourShader, manager, grid, camera, deltaTime, editorState);
+        renderer.render(*modelShaders, *gridShader, manager, grid, camera, sceneState, editorState);
 
         overlay.draw();
         overlay.endFrame();
+        StreamBuffer::EndFrameAll();
 
         window.swapBuffers();
     }
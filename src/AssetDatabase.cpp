@@ -0,0 +1,245 @@
+#include "AssetDatabase.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <numeric>
+
+namespace fs = std::filesystem;
+
+ComponentLogger AssetDatabase::logger("Assets");
+
+namespace {
+uint32_t trigram(const char *s)
+{
+    return (uint32_t(uint8_t(s[0])) << 16) | (uint32_t(uint8_t(s[1])) << 8) | uint32_t(uint8_t(s[2]));
+}
+
+std::string lowerCase(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+bool readEntry(const fs::path &path, const std::string &root, AssetDatabase::Entry &entry)
+{
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return false;
+    const auto stamp = fs::last_write_time(path, ec);
+    if (ec) return false;
+    entry.path = path.string();
+    std::string relative = path.lexically_relative(root).generic_string();
+    entry.lower = lowerCase(relative.empty() ? path.filename().string() : relative);
+    entry.bytes = static_cast<uint64_t>(size);
+    entry.modified = static_cast<int64_t>(stamp.time_since_epoch().count());
+    return true;
+}
+
+void scanDirectory(const std::string &dir, const std::string &root, bool recursive, const AssetDatabase::Filter &filter,
+                   std::vector<AssetDatabase::Entry> &out)
+{
+    std::error_code ec;
+    auto visit = [&](const fs::directory_entry &file) {
+        std::error_code typeError;
+        if (!file.is_regular_file(typeError) || !filter(file.path().string())) return;
+        AssetDatabase::Entry entry;
+        if (readEntry(file.path(), root, entry)) out.push_back(std::move(entry));
+    };
+    if (recursive) {
+        for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            visit(*it);
+        }
+    } else {
+        for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            visit(*it);
+        }
+    }
+}
+
+// path est-il l'un des chemins donnés, ou situé dans l'un d'eux
+bool isUnder(const std::string &path, const std::vector<std::string> &paths)
+{
+    for (const auto &p : paths) {
+        if (path.compare(0, p.size(), p) == 0 && (path.size() == p.size() || path[p.size()] == '/')) return true;
+    }
+    return false;
+}
+}
+
+void AssetDatabase::Index::build()
+{
+    std::sort(items.begin(), items.end(), [](const Entry &a, const Entry &b) { return a.path < b.path; });
+
+    // (trigramme << 32 | entrée), trié : les listes de chaque trigramme sortent déjà croissantes
+    std::vector<uint64_t> pairs;
+    std::vector<uint32_t> keys;
+    for (uint32_t i = 0; i < items.size(); ++i) {
+        const std::string &s = items[i].lower;
+        keys.clear();
+        for (size_t c = 0; c + 3 <= s.size(); ++c) keys.push_back(trigram(s.data() + c));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        for (uint32_t key : keys) pairs.push_back((uint64_t(key) << 32) | i);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    trigramKeys.clear();
+    offsets.clear();
+    postings.resize(pairs.size());
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        const uint32_t key = uint32_t(pairs[p] >> 32);
+        if (trigramKeys.empty() || trigramKeys.back() != key) {
+            trigramKeys.push_back(key);
+            offsets.push_back(uint32_t(p));
+        }
+        postings[p] = uint32_t(pairs[p]);
+    }
+    offsets.push_back(uint32_t(pairs.size()));
+}
+
+std::vector<uint32_t> AssetDatabase::Index::search(const std::string &query) const
+{
+    const std::string q = lowerCase(query);
+    std::vector<uint32_t> result;
+    if (q.empty()) {
+        result.resize(items.size());
+        std::iota(result.begin(), result.end(), 0u);
+        return result;
+    }
+    if (q.size() < 3) {
+        for (uint32_t i = 0; i < items.size(); ++i) {
+            if (items[i].lower.find(q) != std::string::npos) result.push_back(i);
+        }
+        return result;
+    }
+
+    using Range = std::pair<const uint32_t *, const uint32_t *>;
+    std::vector<Range> lists;
+    for (size_t c = 0; c + 3 <= q.size(); ++c) {
+        const uint32_t key = trigram(q.data() + c);
+        auto it = std::lower_bound(trigramKeys.begin(), trigramKeys.end(), key);
+        if (it == trigramKeys.end() || *it != key) return result;
+        const size_t k = size_t(it - trigramKeys.begin());
+        lists.emplace_back(postings.data() + offsets[k], postings.data() + offsets[k + 1]);
+    }
+    // Intersection en partant de la liste la plus courte
+    std::sort(lists.begin(), lists.end(), [](const Range &a, const Range &b) { return a.second - a.first < b.second - b.first; });
+    result.assign(lists[0].first, lists[0].second);
+    std::vector<uint32_t> kept;
+    for (size_t l = 1; l < lists.size() && !result.empty(); ++l) {
+        kept.clear();
+        std::set_intersection(result.begin(), result.end(), lists[l].first, lists[l].second, std::back_inserter(kept));
+        result.swap(kept);
+    }
+    // Tous les trigrammes présents ne garantissent pas qu'ils se suivent
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [&](uint32_t i) { return items[i].lower.find(q) == std::string::npos; }),
+                 result.end());
+    return result;
+}
+
+const AssetDatabase::Entry *AssetDatabase::Index::find(const std::string &path) const
+{
+    auto it = std::lower_bound(items.begin(), items.end(), path, [](const Entry &e, const std::string &p) { return e.path < p; });
+    return it != items.end() && it->path == path ? &*it : nullptr;
+}
+
+AssetDatabase::AssetDatabase(const std::string &root, Filter fileFilter, bool recurse)
+    : rootDir(root)
+    , filter(std::move(fileFilter))
+    , recursive(recurse)
+    , watcher(std::make_shared<FileWatcher>())
+    , current(std::make_shared<Index>())
+{
+    startJob(true);
+}
+
+void AssetDatabase::update()
+{
+    // Le parcours initial pose les surveillances : le watcher n'est pas lu avant sa fin
+    if (!watching) return;
+
+    std::vector<std::string> gone;
+    const std::vector<std::string> fresh = watcher->poll(&gone);
+    for (const auto &path : gone) {
+        changed.erase(path);
+        removed.insert(path);
+    }
+    for (const auto &path : fresh) {
+        removed.erase(path);
+        changed.insert(path);
+    }
+    if (watcher->takeOverflow()) {
+        rescan();
+        return;
+    }
+    if (!indexing && (!changed.empty() || !removed.empty())) startJob(false);
+}
+
+void AssetDatabase::rescan()
+{
+    if (indexing) rescanRequested = true;
+    else startJob(true);
+}
+
+void AssetDatabase::startJob(bool full)
+{
+    indexing = true;
+    std::shared_ptr<FileWatcher> watchRoot = watching ? nullptr : watcher;
+    const std::shared_ptr<const Index> base = current;
+    std::vector<std::string> changedPaths(changed.begin(), changed.end());
+    std::vector<std::string> removedPaths(removed.begin(), removed.end());
+    changed.clear();
+    removed.clear();
+
+    JobSystem::Instance().submit([this, full, base, watchRoot, changedPaths, removedPaths,
+                                  root = rootDir, filter = filter, recursive = recursive]() {
+        PROFILE_ZONE_CAT("AssetDatabase::index", "io");
+        if (watchRoot) watchRoot->watch(root, recursive);
+
+        auto next = std::make_shared<Index>();
+        if (full) {
+            scanDirectory(root, root, recursive, filter, next->items);
+        } else {
+            // Entrées conservées hors des chemins supprimés ou modifiés, ces derniers relus
+            for (const auto &entry : base->items) {
+                if (!isUnder(entry.path, removedPaths) && !isUnder(entry.path, changedPaths)) next->items.push_back(entry);
+            }
+            const fs::path rootPath = fs::path(root).lexically_normal();
+            for (const auto &path : changedPaths) {
+                if (!recursive && fs::path(path).parent_path().lexically_normal() != rootPath) continue;
+                std::error_code ec;
+                if (fs::is_directory(path, ec)) {
+                    if (recursive) scanDirectory(path, root, true, filter, next->items);
+                } else if (filter(path)) {
+                    Entry entry;
+                    if (readEntry(path, root, entry)) next->items.push_back(std::move(entry));
+                }
+            }
+        }
+        next->build();
+
+        JobSystem::Instance().runOnMainThread([this, next, full, watched = bool(watchRoot)]() {
+            if (watched) watching = true;
+            if (full) logger.info("Index: " + std::to_string(next->items.size()) + " fichiers sous " + rootDir);
+            publish(next);
+        });
+    });
+}
+
+void AssetDatabase::publish(std::shared_ptr<Index> next)
+{
+    current = std::move(next);
+    ++published;
+    indexing = false;
+    if (rescanRequested) {
+        rescanRequested = false;
+        startJob(true);
+    } else if (!changed.empty() || !removed.empty()) {
+        startJob(false);
+    }
+}
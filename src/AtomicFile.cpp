@@ -0,0 +1,40 @@
+#include "AtomicFile.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+bool syncPath(const std::string &path, int flags)
+{
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0) return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+}
+
+std::string AtomicFile::TempPath(const std::string &path)
+{
+    return path + ".tmp";
+}
+
+bool AtomicFile::Replace(const std::string &tmp, const std::string &path)
+{
+    if (!syncPath(tmp, O_RDONLY) || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    // Le renommage lui-même n'est durable qu'une fois le dossier synchronisé
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    syncPath(dir.empty() ? "." : dir, O_RDONLY | O_DIRECTORY);
+    return true;
+}
+
+bool AtomicFile::Sync(const std::string &path)
+{
+    return syncPath(path, O_WRONLY);
+}
@@ -0,0 +1,356 @@
+#include "BinaryMap.h"
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+
+static ComponentLogger mapLogger("Map");
+
+namespace {
+const char kMagic[8] = {'S', 'B', 'M', 'A', 'P', '\r', '\n', '\x1a'};
+const uint32_t kFlagCompressed = 1u;
+// Expansion maximale du codec : chaque octet d'extension de longueur ajoute 255 octets de copie
+const uint64_t kMaxExpansion = 255;
+const size_t kSettingsFloats = 16;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t instanceCount;
+    uint32_t assetCount;
+    uint64_t payloadBytes;     // taille décompressée
+    uint64_t storedBytes;      // taille dans le fichier
+    uint64_t payloadHash;      // xxHash64 des octets stockés
+};
+static_assert(sizeof(Header) == 48, "en-tete .sbmap de taille fixe");
+
+inline size_t align4(size_t n) { return (n + 3u) & ~size_t(3u); }
+
+// --- Compression LZ par blocs (jetons façon LZ4 : littéraux puis copie à distance <= 64 Ko) ---
+
+void writeLength(std::vector<unsigned char> &out, size_t extra)
+{
+    while (extra >= 255) {
+        out.push_back(255);
+        extra -= 255;
+    }
+    out.push_back(static_cast<unsigned char>(extra));
+}
+
+void emitSequence(std::vector<unsigned char> &out, const unsigned char *literals, size_t literalCount,
+                  size_t offset, size_t matchLength)
+{
+    const size_t matchCode = matchLength ? matchLength - 4 : 0;
+    out.push_back(static_cast<unsigned char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+    if (literalCount >= 15) writeLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (!matchLength) return;
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+std::vector<unsigned char> compress(const unsigned char *src, size_t size)
+{
+    const int kHashBits = 16;
+    std::vector<uint32_t> table(size_t(1) << kHashBits, UINT32_MAX);
+    std::vector<unsigned char> out;
+    out.reserve(size / 2 + 16);
+
+    size_t anchor = 0, pos = 0;
+    while (pos + 4 <= size) {
+        uint32_t seq;
+        std::memcpy(&seq, src + pos, 4);
+        const uint32_t h = (seq * 2654435761u) >> (32 - kHashBits);
+        const uint32_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(pos);
+        uint32_t other;
+        if (candidate != UINT32_MAX && pos - candidate <= 0xFFFF &&
+            (std::memcpy(&other, src + candidate, 4), other == seq)) {
+            size_t length = 4;
+            while (pos + length < size && src[candidate + length] == src[pos + length]) ++length;
+            emitSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+            pos += length;
+            anchor = pos;
+        } else {
+            ++pos;
+        }
+    }
+    // Dernière séquence : littéraux seuls, marque la fin du bloc
+    emitSequence(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+bool readLength(const unsigned char *&ip, const unsigned char *end, size_t &length)
+{
+    unsigned char b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool decompress(const unsigned char *ip, size_t size, unsigned char *out, size_t outSize)
+{
+    const unsigned char *end = ip + size;
+    size_t op = 0;
+    while (ip < end) {
+        const unsigned char token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(ip, end, literals)) return false;
+        if (literals > static_cast<size_t>(end - ip) || literals > outSize - op) return false;
+        std::memcpy(out + op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == end) break;
+
+        if (end - ip < 2) return false;
+        const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t length = token & 0x0F;
+        if (length == 15 && !readLength(ip, end, length)) return false;
+        length += 4;
+        if (offset == 0 || offset > op || length > outSize - op) return false;
+        // Copie octet par octet : source et destination peuvent se chevaucher
+        for (size_t i = 0; i < length; ++i, ++op) out[op] = out[op - offset];
+    }
+    return op == outSize;
+}
+
+template <typename T>
+void append(std::vector<unsigned char> &out, const T *data, size_t count)
+{
+    const size_t bytes = count * sizeof(T);
+    const size_t at = out.size();
+    out.resize(align4(at + bytes));
+    if (bytes) std::memcpy(out.data() + at, data, bytes);
+}
+
+// Curseur de lecture borné sur la charge utile
+struct Reader {
+    const unsigned char *data;
+    size_t size;
+    size_t pos = 0;
+
+    const unsigned char *take(size_t bytes)
+    {
+        if (bytes > size - pos) return nullptr;
+        const unsigned char *p = data + pos;
+        pos = std::min(size, align4(pos + bytes));
+        return p;
+    }
+};
+
+glm::vec3 readVec3(const unsigned char *p, size_t index)
+{
+    glm::vec3 v;
+    std::memcpy(&v.x, p + index * 12, 4);
+    std::memcpy(&v.y, p + index * 12 + 4, 4);
+    std::memcpy(&v.z, p + index * 12 + 8, 4);
+    return v;
+}
+}
+
+bool BinaryMap::IsBinaryPath(const std::string &path)
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == Extension;
+}
+
+bool BinaryMap::Save(const std::string &path, const SceneSnapshot &snapshot, bool compressPayload)
+{
+    PROFILE_ZONE_CAT("BinaryMap::Save", "io");
+    const size_t count = snapshot.models.size();
+
+    // Table des chemins : un exemplaire par asset, les instances n'en gardent que l'index
+    std::vector<std::string> assets;
+    std::map<std::string, uint32_t> assetIndex;
+    std::vector<uint32_t> indices(count);
+    std::vector<float> positions(count * 3), rotations(count * 3), scales(count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        const auto &m = snapshot.models[i];
+        auto it = assetIndex.find(m.path);
+        if (it == assetIndex.end()) {
+            it = assetIndex.emplace(m.path, static_cast<uint32_t>(assets.size())).first;
+            assets.push_back(m.path);
+        }
+        indices[i] = it->second;
+        std::memcpy(&positions[i * 3], &m.position.x, 12);
+        std::memcpy(&rotations[i * 3], &m.rotation.x, 12);
+        std::memcpy(&scales[i * 3], &m.scale.x, 12);
+    }
+
+    const auto &l = snapshot.light;
+    const auto &e = snapshot.environment;
+    const float settings[kSettingsFloats] = {
+        l.direction.x, l.direction.y, l.direction.z, l.ambient.x, l.ambient.y, l.ambient.z,
+        l.diffuse.x, l.diffuse.y, l.diffuse.z, l.specular.x, l.specular.y, l.specular.z, l.intensity,
+        e.skyColor.x, e.skyColor.y, e.skyColor.z};
+    const float ambientBoost = e.ambientBoost;
+
+    std::vector<uint32_t> offsets(assets.size() + 1, 0);
+    std::string strings;
+    for (size_t i = 0; i < assets.size(); ++i) {
+        offsets[i] = static_cast<uint32_t>(strings.size());
+        strings += assets[i];
+    }
+    offsets[assets.size()] = static_cast<uint32_t>(strings.size());
+
+    std::vector<unsigned char> payload;
+    payload.reserve(128 + strings.size() + count * 40);
+    append(payload, settings, kSettingsFloats);
+    append(payload, &ambientBoost, 1);
+    append(payload, offsets.data(), offsets.size());
+    append(payload, strings.data(), strings.size());
+    append(payload, indices.data(), indices.size());
+    append(payload, positions.data(), positions.size());
+    append(payload, rotations.data(), rotations.size());
+    append(payload, scales.data(), scales.size());
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = Version;
+    header.flags = 0;
+    header.instanceCount = static_cast<uint32_t>(count);
+    header.assetCount = static_cast<uint32_t>(assets.size());
+    header.payloadBytes = payload.size();
+
+    std::vector<unsigned char> packed;
+    if (compressPayload) {
+        packed = compress(payload.data(), payload.size());
+        // Gardée seulement si elle fait gagner de la place
+        if (packed.size() < payload.size()) header.flags |= kFlagCompressed;
+    }
+    const std::vector<unsigned char> &stored = (header.flags & kFlagCompressed) ? packed : payload;
+    header.storedBytes = stored.size();
+    header.payloadHash = ContentHash::Hash(stored.data(), stored.size());
+
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(stored.data()), static_cast<std::streamsize>(stored.size()));
+    if (!out) return false;
+
+    mapLogger.info("Map binaire ecrite: " + path + " (" + std::to_string(count) + " instances, " +
+                   std::to_string(assets.size()) + " assets, " + std::to_string(stored.size() / 1024) + " Ko" +
+                   ((header.flags & kFlagCompressed) ? ", compressee depuis " + std::to_string(payload.size() / 1024) + " Ko" : "") + ")");
+    return true;
+}
+
+std::optional<SceneSnapshot> BinaryMap::Load(const std::string &path)
+{
+    PROFILE_ZONE_CAT("BinaryMap::Load", "io");
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(Header)) {
+        mapLogger.error("Map binaire illisible: " + path);
+        return std::nullopt;
+    }
+    file.adviseSequential();
+
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != Version) {
+        mapLogger.error("Map binaire de format ou version inconnu: " + path);
+        return std::nullopt;
+    }
+    const unsigned char *stored = file.data() + sizeof(Header);
+    if (header.storedBytes != file.size() - sizeof(Header) ||
+        ContentHash::Hash(stored, header.storedBytes) != header.payloadHash) {
+        mapLogger.error("Map binaire tronquee ou corrompue: " + path);
+        return std::nullopt;
+    }
+
+    // Charge utile lue en place dans la projection, ou décompressée en un seul tampon
+    std::vector<unsigned char> inflated;
+    const unsigned char *payload = stored;
+    if (header.flags & kFlagCompressed) {
+        // Taille annoncée bornée avant allocation : un octet compressé en donne au plus kMaxExpansion
+        if (header.payloadBytes > header.storedBytes * kMaxExpansion) {
+            mapLogger.error("Map binaire incoherente: " + path);
+            return std::nullopt;
+        }
+        inflated.resize(header.payloadBytes);
+        if (!decompress(stored, header.storedBytes, inflated.data(), inflated.size())) {
+            mapLogger.error("Decompression impossible: " + path);
+            return std::nullopt;
+        }
+        payload = inflated.data();
+    } else if (header.payloadBytes != header.storedBytes) {
+        mapLogger.error("Map binaire incoherente: " + path);
+        return std::nullopt;
+    }
+
+    const size_t count = header.instanceCount;
+    const size_t assetCount = header.assetCount;
+    Reader reader{payload, static_cast<size_t>(header.payloadBytes)};
+    const unsigned char *settingsBytes = reader.take(kSettingsFloats * 4);
+    const unsigned char *boostBytes = reader.take(4);
+    const unsigned char *offsetBytes = reader.take((assetCount + 1) * 4);
+    if (!settingsBytes || !boostBytes || !offsetBytes) {
+        mapLogger.error("Map binaire incoherente: " + path);
+        return std::nullopt;
+    }
+    uint32_t stringBytes;
+    std::memcpy(&stringBytes, offsetBytes + assetCount * 4, 4);
+    const unsigned char *strings = reader.take(stringBytes);
+    const unsigned char *indexBytes = reader.take(count * 4);
+    const unsigned char *positions = reader.take(count * 12);
+    const unsigned char *rotations = reader.take(count * 12);
+    const unsigned char *scales = reader.take(count * 12);
+    if (!strings || !indexBytes || !positions || !rotations || !scales) {
+        mapLogger.error("Map binaire incoherente: " + path);
+        return std::nullopt;
+    }
+
+    SceneSnapshot snapshot;
+    float settings[kSettingsFloats];
+    std::memcpy(settings, settingsBytes, sizeof(settings));
+    snapshot.light.direction = glm::vec3(settings[0], settings[1], settings[2]);
+    snapshot.light.ambient = glm::vec3(settings[3], settings[4], settings[5]);
+    snapshot.light.diffuse = glm::vec3(settings[6], settings[7], settings[8]);
+    snapshot.light.specular = glm::vec3(settings[9], settings[10], settings[11]);
+    snapshot.light.intensity = settings[12];
+    snapshot.environment.skyColor = glm::vec3(settings[13], settings[14], settings[15]);
+    std::memcpy(&snapshot.environment.ambientBoost, boostBytes, 4);
+
+    std::vector<std::string> assets(assetCount);
+    for (size_t i = 0; i < assetCount; ++i) {
+        uint32_t begin, end;
+        std::memcpy(&begin, offsetBytes + i * 4, 4);
+        std::memcpy(&end, offsetBytes + (i + 1) * 4, 4);
+        if (begin > end || end > stringBytes) {
+            mapLogger.error("Table des chemins invalide: " + path);
+            return std::nullopt;
+        }
+        assets[i].assign(reinterpret_cast<const char *>(strings) + begin, end - begin);
+    }
+
+    snapshot.models.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t asset;
+        std::memcpy(&asset, indexBytes + i * 4, 4);
+        if (asset >= assetCount) {
+            mapLogger.error("Index d'asset hors limites: " + path);
+            return std::nullopt;
+        }
+        ModelInstanceData &data = snapshot.models[i];
+        data.path = assets[asset];
+        data.position = readVec3(positions, i);
+        data.rotation = readVec3(rotations, i);
+        data.scale = readVec3(scales, i);
+    }
+    return snapshot;
+}
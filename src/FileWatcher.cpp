@@ -0,0 +1,141 @@
+#include "FileWatcher.h"
+
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+ComponentLogger FileWatcher::logger("HotReload");
+
+FileWatcher::FileWatcher(std::chrono::milliseconds debounceDelay)
+    : debounce(debounceDelay)
+{
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        logger.error("inotify_init1 a echoue, errno=" + std::to_string(errno));
+    }
+#else
+    logger.info("Surveillance des fichiers indisponible sur cette plateforme");
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (fd >= 0) close(fd);
+#endif
+}
+
+bool FileWatcher::SamePath(const std::string &a, const std::string &b)
+{
+    if (a == b) return true;
+    std::error_code ec;
+    return std::filesystem::equivalent(a, b, ec);
+}
+
+bool FileWatcher::watch(const std::string &directory, bool recursive)
+{
+    if (fd < 0) return false;
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec)) {
+        logger.error("Dossier a surveiller introuvable: " + directory);
+        return false;
+    }
+    if (!addWatch(directory, recursive)) return false;
+    if (!recursive) return true;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_directory(ec)) addWatch(it->path().string(), true);
+    }
+    return true;
+}
+
+bool FileWatcher::addWatch(const std::string &directory, bool recursive)
+{
+#ifdef __linux__
+    // CLOSE_WRITE pour les écritures en place, MOVED_TO pour les éditeurs qui écrivent puis renomment
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR;
+    int wd = inotify_add_watch(fd, directory.c_str(), mask);
+    if (wd < 0) {
+        logger.error("inotify_add_watch a echoue pour " + directory + ", errno=" + std::to_string(errno));
+        return false;
+    }
+    directories[wd] = Watched{directory, recursive};
+    logger.debug("Surveillance de " + directory);
+    return true;
+#else
+    (void)directory;
+    (void)recursive;
+    return false;
+#endif
+}
+
+void FileWatcher::readEvents()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        if (len <= 0) break;   // EAGAIN : plus rien à lire
+
+        const Clock::time_point now = Clock::now();
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            auto *event = reinterpret_cast<inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                logger.error("File inotify saturee, evenements perdus");
+                overflowed = true;
+                continue;
+            }
+            auto dir = directories.find(event->wd);
+            if (dir == directories.end() || event->len == 0) continue;
+            const std::string path = dir->second.path + "/" + event->name;
+
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending.erase(path);
+                removedPaths.push_back(path);
+                continue;
+            }
+            if (event->mask & IN_ISDIR) {
+                // Un dossier ajouté sous une racine surveillée récursivement l'est aussi (ex: nouveau
+                // modèle copié) ; sans récursion il n'intéresse pas l'appelant
+                if (dir->second.recursive && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                    watch(path, true);
+                    pending[path] = now;
+                }
+                continue;
+            }
+            // IN_CREATE seul précède l'écriture : on attend le CLOSE_WRITE correspondant
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) pending[path] = now;
+        }
+    }
+#endif
+}
+
+std::vector<std::string> FileWatcher::poll(std::vector<std::string> *removed)
+{
+    std::vector<std::string> changed;
+    if (fd < 0) return changed;
+
+    readEvents();
+    if (removed) removed->insert(removed->end(), removedPaths.begin(), removedPaths.end());
+    removedPaths.clear();
+
+    const Clock::time_point now = Clock::now();
+    for (auto it = pending.begin(); it != pending.end(); ) {
+        if (now - it->second >= debounce) {
+            changed.push_back(it->first);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return changed;
+}
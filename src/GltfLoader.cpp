@@ -0,0 +1,515 @@
+#include "GltfLoader.h"
+#include "MappedFile.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "VertexProcessing.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+
+using json = nlohmann::json;
+
+static ComponentLogger gltfLogger("Model");
+
+namespace {
+const uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+const uint32_t kChunkJson = 0x4E4F534A;     // "JSON"
+const uint32_t kChunkBin = 0x004E4942;      // "BIN\0"
+
+const int kFloat = 5126;
+const int kUnsignedInt = 5125;
+const int kUnsignedShort = 5123;
+const int kShort = 5122;
+const int kUnsignedByte = 5121;
+const int kByte = 5120;
+
+const int kModeTriangles = 4;
+
+uint32_t readU32(const unsigned char *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Une plage d'octets : soit dans une projection mmap, soit dans un tampon décodé (URI data:)
+struct BufferData {
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+};
+
+// Vue typée sur les éléments d'un accesseur, lus en place
+struct AccessorView {
+    const unsigned char *data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int componentType = kFloat;
+    int components = 1;
+    bool normalized = false;
+
+    bool valid() const { return data != nullptr || count == 0; }
+
+    float component(size_t index, int c) const
+    {
+        const unsigned char *p = data + index * stride;
+        switch (componentType) {
+            case kFloat: { float v; std::memcpy(&v, p + c * 4, 4); return v; }
+            case kUnsignedByte: { uint8_t v = p[c]; return normalized ? v / 255.0f : v; }
+            case kByte: { int8_t v; std::memcpy(&v, p + c, 1); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+            case kUnsignedShort: { uint16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? v / 65535.0f : v; }
+            case kShort: { int16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+            case kUnsignedInt: { uint32_t v; std::memcpy(&v, p + c * 4, 4); return static_cast<float>(v); }
+            default: return 0.0f;
+        }
+    }
+
+    unsigned int index(size_t i) const
+    {
+        const unsigned char *p = data + i * stride;
+        switch (componentType) {
+            case kUnsignedByte: return p[0];
+            case kUnsignedShort: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+            case kUnsignedInt: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+            default: return 0;
+        }
+    }
+};
+
+int componentSize(int componentType)
+{
+    switch (componentType) {
+        case kByte: case kUnsignedByte: return 1;
+        case kShort: case kUnsignedShort: return 2;
+        case kFloat: case kUnsignedInt: return 4;
+        default: return 0;
+    }
+}
+
+int componentCount(const std::string &type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+std::string percentDecode(const std::string &uri)
+{
+    std::string out;
+    out.reserve(uri.size());
+    for (size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            out += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += uri[i];
+        }
+    }
+    return out;
+}
+
+std::vector<unsigned char> base64Decode(const std::string &text, size_t start)
+{
+    static const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<unsigned char> out;
+    out.reserve((text.size() - start) * 3 / 4);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = start; i < text.size(); ++i) {
+        const char ch = text[i];
+        if (ch == '=') break;
+        const size_t v = alphabet.find(ch);
+        if (v == std::string::npos) continue;
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<unsigned char>((acc >> bits) & 0xFF));
+        }
+    }
+    return out;
+}
+
+// État d'un chargement : documents JSON, projections et tampons décodés gardés en vie
+struct Document {
+    std::string path;
+    std::string directory;
+    json root;
+    MappedFile file;                               // .glb ou .gltf
+    std::vector<MappedFile> externalFiles;         // .bin référencés
+    std::vector<std::vector<unsigned char>> decoded; // URI data:
+    std::vector<BufferData> buffers;
+};
+
+bool openDocument(Document &doc)
+{
+    doc.file = MappedFile(doc.path);
+    if (!doc.file.isOpen() || doc.file.size() < 12) {
+        gltfLogger.error("glTF illisible: " + doc.path);
+        return false;
+    }
+    doc.file.adviseSequential();
+
+    BufferData glbBin;
+    const unsigned char *base = doc.file.data();
+    if (readU32(base) == kGlbMagic) {
+        const uint32_t version = readU32(base + 4);
+        const size_t total = std::min<size_t>(readU32(base + 8), doc.file.size());
+        if (version != 2) {
+            gltfLogger.error("Version GLB non geree (" + std::to_string(version) + "): " + doc.path);
+            return false;
+        }
+        size_t offset = 12;
+        bool haveJson = false;
+        while (offset + 8 <= total) {
+            const uint32_t chunkLength = readU32(base + offset);
+            const uint32_t chunkType = readU32(base + offset + 4);
+            const unsigned char *chunk = base + offset + 8;
+            if (offset + 8 + chunkLength > total) break;
+            if (chunkType == kChunkJson && !haveJson) {
+                doc.root = json::parse(chunk, chunk + chunkLength);
+                haveJson = true;
+            } else if (chunkType == kChunkBin && !glbBin.data) {
+                glbBin.data = chunk;
+                glbBin.size = chunkLength;
+            }
+            offset += 8 + ((chunkLength + 3u) & ~3u);
+        }
+        if (!haveJson) {
+            gltfLogger.error("GLB sans chunk JSON: " + doc.path);
+            return false;
+        }
+    } else {
+        doc.root = json::parse(base, base + doc.file.size());
+    }
+
+    // Buffers : chunk BIN du GLB, fichiers externes projetés, ou URI base64
+    const json &buffers = doc.root.value("buffers", json::array());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const json &buffer = buffers[i];
+        BufferData data;
+        if (!buffer.contains("uri")) {
+            data = glbBin;
+        } else {
+            const std::string uri = buffer["uri"].get<std::string>();
+            if (uri.compare(0, 5, "data:") == 0) {
+                const size_t comma = uri.find(',');
+                if (comma == std::string::npos || uri.find(";base64") == std::string::npos) {
+                    gltfLogger.error("URI data: non geree dans " + doc.path);
+                    return false;
+                }
+                doc.decoded.push_back(base64Decode(uri, comma + 1));
+                data.data = doc.decoded.back().data();
+                data.size = doc.decoded.back().size();
+            } else {
+                doc.externalFiles.emplace_back(doc.directory + "/" + percentDecode(uri));
+                const MappedFile &file = doc.externalFiles.back();
+                if (!file.isOpen()) {
+                    gltfLogger.error("Buffer glTF introuvable: " + doc.directory + "/" + uri);
+                    return false;
+                }
+                data.data = file.data();
+                data.size = file.size();
+            }
+        }
+        const size_t declared = buffer.value("byteLength", size_t(0));
+        if (data.size < declared) {
+            gltfLogger.error("Buffer glTF tronque (" + std::to_string(i) + ") dans " + doc.path);
+            return false;
+        }
+        doc.buffers.push_back(data);
+    }
+    return true;
+}
+
+// Plage d'octets d'une bufferView, avec son pas
+bool bufferView(const Document &doc, size_t index, const unsigned char *&data, size_t &length, size_t &stride)
+{
+    const json &views = doc.root["bufferViews"];
+    if (index >= views.size()) return false;
+    const json &view = views[index];
+    const size_t buffer = view.value("buffer", size_t(0));
+    if (buffer >= doc.buffers.size()) return false;
+    const size_t offset = view.value("byteOffset", size_t(0));
+    length = view.value("byteLength", size_t(0));
+    stride = view.value("byteStride", size_t(0));
+    if (offset + length > doc.buffers[buffer].size) return false;
+    data = doc.buffers[buffer].data + offset;
+    return true;
+}
+
+bool accessor(const Document &doc, size_t index, AccessorView &out)
+{
+    const json &accessors = doc.root["accessors"];
+    if (index >= accessors.size()) return false;
+    const json &acc = accessors[index];
+    if (acc.contains("sparse")) {
+        gltfLogger.error("Accesseur glTF sparse non gere");
+        return false;
+    }
+
+    out.componentType = acc.value("componentType", kFloat);
+    out.components = componentCount(acc.value("type", std::string("SCALAR")));
+    out.count = acc.value("count", size_t(0));
+    out.normalized = acc.value("normalized", false);
+    const size_t elementSize = static_cast<size_t>(componentSize(out.componentType)) * out.components;
+    if (elementSize == 0) return false;
+
+    if (!acc.contains("bufferView")) {
+        // Accesseur sans données : zéros selon la spécification
+        static const unsigned char zeros[64] = {};
+        out.data = zeros;
+        out.stride = 0;
+        return elementSize <= sizeof(zeros);
+    }
+
+    const unsigned char *data = nullptr;
+    size_t length = 0, stride = 0;
+    if (!bufferView(doc, acc["bufferView"].get<size_t>(), data, length, stride)) return false;
+    const size_t offset = acc.value("byteOffset", size_t(0));
+    out.stride = stride ? stride : elementSize;
+    if (out.count > 0 && offset + (out.count - 1) * out.stride + elementSize > length) return false;
+    out.data = data + offset;
+    return true;
+}
+
+glm::mat4 nodeTransform(const json &node)
+{
+    if (node.contains("matrix") && node["matrix"].size() == 16) {
+        float m[16];
+        for (int i = 0; i < 16; ++i) m[i] = node["matrix"][i].get<float>();
+        return glm::make_mat4(m);   // colonne par colonne, comme glTF
+    }
+    glm::vec3 t(0.0f), s(1.0f);
+    glm::quat r(1.0f, 0.0f, 0.0f, 0.0f);
+    if (node.contains("translation")) t = glm::vec3(node["translation"][0], node["translation"][1], node["translation"][2]);
+    if (node.contains("rotation")) {
+        // glTF stocke x, y, z, w ; glm::quat prend w en premier
+        r = glm::quat(node["rotation"][3].get<float>(), node["rotation"][0].get<float>(),
+                      node["rotation"][1].get<float>(), node["rotation"][2].get<float>());
+    }
+    if (node.contains("scale")) s = glm::vec3(node["scale"][0], node["scale"][1], node["scale"][2]);
+    return glm::translate(glm::mat4(1.0f), t) * glm::mat4_cast(r) * glm::scale(glm::mat4(1.0f), s);
+}
+
+bool loadPrimitive(const Document &doc, const json &prim, GltfLoader::Primitive &out)
+{
+    if (prim.value("mode", kModeTriangles) != kModeTriangles) {
+        gltfLogger.debug("Primitive glTF ignoree (mode " + std::to_string(prim.value("mode", 0)) + ")");
+        return false;
+    }
+    const json &attributes = prim["attributes"];
+    if (!attributes.contains("POSITION")) return false;
+
+    AccessorView positions, normals, uvs, tangents;
+    if (!accessor(doc, attributes["POSITION"].get<size_t>(), positions) || positions.components != 3) return false;
+    const bool hasNormals = attributes.contains("NORMAL") && accessor(doc, attributes["NORMAL"].get<size_t>(), normals) &&
+                            normals.count == positions.count;
+    const bool hasUvs = attributes.contains("TEXCOORD_0") && accessor(doc, attributes["TEXCOORD_0"].get<size_t>(), uvs) &&
+                        uvs.count == positions.count;
+    const bool hasTangents = attributes.contains("TANGENT") && accessor(doc, attributes["TANGENT"].get<size_t>(), tangents) &&
+                             tangents.count == positions.count && tangents.components == 4;
+
+    // Écriture directe depuis les buffers projetés vers la disposition entrelacée du moteur
+    const size_t count = positions.count;
+    out.vertices.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Vertex &v = out.vertices[i];
+        v.Position = glm::vec3(positions.component(i, 0), positions.component(i, 1), positions.component(i, 2));
+        v.Normal = hasNormals ? glm::vec3(normals.component(i, 0), normals.component(i, 1), normals.component(i, 2)) : glm::vec3(0.0f);
+        // Même convention que aiProcess_FlipUVs : les images sont retournées au décodage
+        v.TexCoords = hasUvs ? glm::vec2(uvs.component(i, 0), 1.0f - uvs.component(i, 1)) : glm::vec2(0.0f);
+        v.Tangent = v.Bitangent = glm::vec3(0.0f);
+    }
+
+    if (prim.contains("indices")) {
+        AccessorView idx;
+        if (!accessor(doc, prim["indices"].get<size_t>(), idx) || idx.components != 1) return false;
+        out.indices.resize(idx.count);
+        if (idx.componentType == kUnsignedInt && idx.stride == 4) {
+            std::memcpy(out.indices.data(), idx.data, idx.count * 4);
+        } else {
+            for (size_t i = 0; i < idx.count; ++i) out.indices[i] = idx.index(i);
+        }
+        for (unsigned int index : out.indices) {
+            if (index >= count) {
+                gltfLogger.error("Indice glTF hors limites dans " + doc.path);
+                return false;
+            }
+        }
+    } else {
+        out.indices.resize(count);
+        for (size_t i = 0; i < count; ++i) out.indices[i] = static_cast<unsigned int>(i);
+    }
+    out.indices.resize(out.indices.size() / 3 * 3);
+
+    if (!hasNormals) VertexProcessing::GenerateNormals(out.vertices, out.indices);
+    if (hasTangents) {
+        for (size_t i = 0; i < count; ++i) {
+            Vertex &v = out.vertices[i];
+            // Le retournement des UV inverse le sens de la bitangente
+            v.Tangent = glm::vec3(tangents.component(i, 0), tangents.component(i, 1), tangents.component(i, 2));
+            v.Bitangent = glm::cross(v.Normal, v.Tangent) * -tangents.component(i, 3);
+        }
+    } else if (hasUvs) {
+        VertexProcessing::GenerateTangents(out.vertices, out.indices);
+    }
+    return true;
+}
+
+void loadMaterial(const json &root, const json &prim, GltfLoader::Primitive &out)
+{
+    if (!prim.contains("material")) return;
+    const size_t index = prim["material"].get<size_t>();
+    const json &materials = root.value("materials", json::array());
+    if (index >= materials.size()) return;
+    const json &material = materials[index];
+    const json &textures = root.value("textures", json::array());
+
+    auto addTexture = [&](const json &info, const char *type) {
+        const size_t tex = info.value("index", size_t(0));
+        if (tex >= textures.size() || !textures[tex].contains("source")) return;
+        out.textures.emplace_back(type, textures[tex]["source"].get<int>());
+    };
+
+    if (material.contains("pbrMetallicRoughness")) {
+        const json &pbr = material["pbrMetallicRoughness"];
+        if (pbr.contains("baseColorTexture")) addTexture(pbr["baseColorTexture"], "texture_diffuse");
+        if (material.value("alphaMode", std::string("OPAQUE")) == "BLEND" &&
+            pbr.contains("baseColorFactor") && pbr["baseColorFactor"].size() == 4) {
+            out.opacity = pbr["baseColorFactor"][3].get<float>();
+        }
+    }
+    if (material.contains("normalTexture")) addTexture(material["normalTexture"], "texture_normal");
+}
+
+void collectNodes(const json &nodes, size_t index, const glm::mat4 &parent,
+                  const std::vector<std::vector<unsigned int>> &meshPrimitives,
+                  std::vector<GltfLoader::Node> &out, int depth)
+{
+    // Garde-fou contre les hiérarchies cycliques d'un fichier corrompu
+    if (index >= nodes.size() || depth > 256) return;
+    const json &node = nodes[index];
+    const glm::mat4 world = parent * nodeTransform(node);
+    if (node.contains("mesh")) {
+        const size_t mesh = node["mesh"].get<size_t>();
+        if (mesh < meshPrimitives.size()) {
+            for (unsigned int primitive : meshPrimitives[mesh]) out.push_back(GltfLoader::Node{primitive, world});
+        }
+    }
+    for (const auto &child : node.value("children", json::array())) {
+        collectNodes(nodes, child.get<size_t>(), world, meshPrimitives, out, depth + 1);
+    }
+}
+}
+
+bool GltfLoader::IsGltf(const std::string &path)
+{
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".gltf" || ext == ".glb";
+}
+
+bool GltfLoader::Load(const std::string &path, Scene &scene)
+{
+    PROFILE_ZONE_CAT("glTF import", "import");
+    Document doc;
+    doc.path = path;
+    const size_t slash = path.find_last_of("/\\");
+    doc.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+
+    try {
+        if (!openDocument(doc)) return false;
+        const json &root = doc.root;
+
+        const std::string version = root.value("asset", json::object()).value("version", std::string());
+        if (version.compare(0, 1, "2") != 0) {
+            gltfLogger.error("Version glTF non geree (" + version + "): " + path);
+            return false;
+        }
+        for (const auto &ext : root.value("extensionsRequired", json::array())) {
+            gltfLogger.error("Extension glTF requise non geree: " + ext.get<std::string>());
+            return false;
+        }
+
+        // Images : fichiers résolus par chemin, images intégrées décodées depuis la projection
+        const json &images = root.value("images", json::array());
+        scene.images.resize(images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            const json &image = images[i];
+            ImageSource &source = scene.images[i];
+            if (image.contains("uri")) {
+                const std::string uri = image["uri"].get<std::string>();
+                if (uri.compare(0, 5, "data:") == 0) {
+                    const size_t comma = uri.find(',');
+                    std::vector<unsigned char> bytes = base64Decode(uri, comma == std::string::npos ? uri.size() : comma + 1);
+                    source.key = path + "#image" + std::to_string(i);
+                    source.embedded = Texture2D::DecodeMemory(source.key, bytes.data(), bytes.size());
+                } else {
+                    source.key = doc.directory + "/" + percentDecode(uri);
+                }
+            } else if (image.contains("bufferView")) {
+                const unsigned char *data = nullptr;
+                size_t length = 0, stride = 0;
+                if (bufferView(doc, image["bufferView"].get<size_t>(), data, length, stride)) {
+                    source.key = path + "#image" + std::to_string(i);
+                    source.embedded = Texture2D::DecodeMemory(source.key, data, length);
+                }
+            }
+        }
+
+        // Une primitive par Mesh ; meshPrimitives[m] liste celles du mesh glTF m
+        const json &meshes = root.value("meshes", json::array());
+        std::vector<std::vector<unsigned int>> meshPrimitives(meshes.size());
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            for (const auto &prim : meshes[m].value("primitives", json::array())) {
+                Primitive primitive;
+                if (!loadPrimitive(doc, prim, primitive)) continue;
+                loadMaterial(root, prim, primitive);
+                meshPrimitives[m].push_back(static_cast<unsigned int>(scene.primitives.size()));
+                scene.primitives.push_back(std::move(primitive));
+            }
+        }
+
+        // Nœuds de la scène par défaut, transforms cumulées depuis les racines
+        const json &nodes = root.value("nodes", json::array());
+        std::vector<size_t> roots;
+        const json &scenes = root.value("scenes", json::array());
+        const size_t sceneIndex = root.value("scene", size_t(0));
+        if (sceneIndex < scenes.size()) {
+            for (const auto &n : scenes[sceneIndex].value("nodes", json::array())) roots.push_back(n.get<size_t>());
+        } else {
+            // Sans scène : toutes les racines de la hiérarchie
+            std::vector<bool> isChild(nodes.size(), false);
+            for (const auto &node : nodes) {
+                for (const auto &child : node.value("children", json::array())) {
+                    if (child.get<size_t>() < isChild.size()) isChild[child.get<size_t>()] = true;
+                }
+            }
+            for (size_t i = 0; i < nodes.size(); ++i) if (!isChild[i]) roots.push_back(i);
+        }
+        for (size_t r : roots) collectNodes(nodes, r, glm::mat4(1.0f), meshPrimitives, scene.nodes, 0);
+    } catch (const std::exception &ex) {
+        gltfLogger.error("glTF invalide (" + path + "): " + ex.what());
+        return false;
+    }
+
+    if (scene.primitives.empty()) {
+        gltfLogger.error("glTF sans primitive triangulaire: " + path);
+        return false;
+    }
+    gltfLogger.info("glTF charge: " + path + " (" + std::to_string(scene.primitives.size()) + " primitives, " +
+                    std::to_string(scene.nodes.size()) + " instances de noeuds)");
+    return true;
+}
@@ -0,0 +1,128 @@
+#include "GpuHandle.h"
+#include "MemoryTracker.h"
+#include "Log.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+const size_t kTypeCount = static_cast<size_t>(GpuResourceType::Count);
+
+struct Registry {
+    std::atomic<long> live[kTypeCount] = {};
+    std::mutex mutex;
+    std::vector<std::pair<GpuResourceType, GLuint>> pending;
+
+    // Détruit après les objets qui possèdent des handles (voir ReportLeaks)
+    ~Registry() { GpuResources::ReportLeaks(); }
+};
+
+ComponentLogger& logger()
+{
+    static ComponentLogger instance("Render");
+    return instance;
+}
+
+Registry& registry()
+{
+    // Logger construit avant le registre pour lui survivre lors du rapport de sortie
+    logger();
+    static Registry instance;
+    return instance;
+}
+}
+
+const char* GpuResources::TypeName(GpuResourceType type)
+{
+    switch (type) {
+        case GpuResourceType::Buffer:      return "buffers";
+        case GpuResourceType::VertexArray: return "vertex arrays";
+        case GpuResourceType::Texture:     return "textures";
+        case GpuResourceType::Program:     return "programmes";
+        case GpuResourceType::Framebuffer: return "framebuffers";
+        case GpuResourceType::Renderbuffer: return "renderbuffers";
+        default:                           return "?";
+    }
+}
+
+void GpuResources::Created(GpuResourceType type)
+{
+    registry().live[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void GpuResources::Release(GpuResourceType type, GLuint id)
+{
+    Registry& reg = registry();
+    reg.live[static_cast<size_t>(type)].fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.pending.emplace_back(type, id);
+}
+
+void GpuResources::Flush()
+{
+    std::vector<std::pair<GpuResourceType, GLuint>> batch;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        batch.swap(reg.pending);
+    }
+    for (const auto& entry : batch) {
+        GLuint id = entry.second;
+        switch (entry.first) {
+            case GpuResourceType::Buffer:
+                MemoryTracker::UntrackBuffer(id);
+                glDeleteBuffers(1, &id);
+                break;
+            case GpuResourceType::VertexArray:
+                glDeleteVertexArrays(1, &id);
+                break;
+            case GpuResourceType::Texture:
+                MemoryTracker::UntrackTexture(id);
+                glDeleteTextures(1, &id);
+                break;
+            case GpuResourceType::Program:
+                glDeleteProgram(id);
+                break;
+            case GpuResourceType::Framebuffer:
+                glDeleteFramebuffers(1, &id);
+                break;
+            case GpuResourceType::Renderbuffer:
+                glDeleteRenderbuffers(1, &id);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+size_t GpuResources::LiveCount(GpuResourceType type)
+{
+    long count = registry().live[static_cast<size_t>(type)].load(std::memory_order_relaxed);
+    return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+size_t GpuResources::PendingCount()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.pending.size();
+}
+
+void GpuResources::ReportLeaks()
+{
+    std::string report;
+    for (size_t i = 0; i < kTypeCount; ++i) {
+        size_t count = LiveCount(static_cast<GpuResourceType>(i));
+        if (count) report += " " + std::to_string(count) + " " + TypeName(static_cast<GpuResourceType>(i));
+    }
+    if (report.empty()) {
+        logger().info("Aucune fuite de ressource GPU");
+        return;
+    }
+    std::cerr << "Fuite de ressources GPU:" << report << std::endl;
+    logger().error("Fuite de ressources GPU:" + report);
+}
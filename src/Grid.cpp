@@ -1,5 +1,6 @@
 #include "Grid.h"
 #include "Shader.h"
+#include "MemoryTracker.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
@@ -9,12 +10,6 @@ Grid::Grid()
     buildGrid(20, 1.0f);
 }
 
-Grid::~Grid()
-{
-    if (vbo) glDeleteBuffers(1, &vbo);
-    if (vao) glDeleteVertexArrays(1, &vao);
-}
-
 void Grid::buildGrid(int halfSize, float step)
 {
     // Each line segment has two vertices, each vertex has position (x,y,z) and color (r,g,b)
@@ -46,11 +41,12 @@ void Grid::buildGrid(int halfSize, float step)
 
     vertexCount = static_cast<GLsizei>(data.size() / 6);
 
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    vao = GlVertexArray::Create();
+    vbo = GlBuffer::Create();
+    glBindVertexArray(vao.get());
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.get());
     glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+    MemoryTracker::TrackBuffer(vbo.get(), MemoryKind::VertexBuffer, data.size() * sizeof(float), "Grid");
 
     // position
     glEnableVertexAttribArray(0);
@@ -68,7 +64,7 @@ void Grid::draw(Shader &shader, const glm::mat4 &view, const glm::mat4 &proj)
     shader.setMat4("view", view);
     shader.setMat4("projection", proj);
     shader.setMat4("model", glm::mat4(1.0f));
-    glBindVertexArray(vao);
+    glBindVertexArray(vao.get());
     glDrawArrays(GL_LINES, 0, vertexCount);
     glBindVertexArray(0);
 }
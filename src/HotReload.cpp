@@ -0,0 +1,110 @@
+#include "HotReload.h"
+
+#include "JobSystem.h"
+#include "ModelManager.h"
+#include "ShaderPermutations.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+ComponentLogger HotReload::logger("HotReload");
+
+namespace {
+std::string extensionOf(const std::string &path)
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+bool isOneOf(const std::string &ext, std::initializer_list<const char*> list)
+{
+    for (const char *candidate : list) {
+        if (ext == candidate) return true;
+    }
+    return false;
+}
+}
+
+HotReload::HotReload(ModelManager &modelManager)
+    : models(modelManager)
+{
+}
+
+void HotReload::addShaders(ShaderPermutations *permutations)
+{
+    if (permutations) shaders.push_back(permutations);
+}
+
+void HotReload::watch(const std::string &directory)
+{
+    if (watcher.watch(directory)) {
+        logger.info("Rechargement a chaud actif sur " + directory);
+    }
+}
+
+void HotReload::update()
+{
+    for (const std::string &path : watcher.poll()) {
+        const std::string ext = extensionOf(path);
+        if (isOneOf(ext, {".vs", ".fs", ".vert", ".frag", ".glsl"})) {
+            onShaderChanged(path);
+        } else if (ext == ".mtl") {
+            onMaterialChanged(path);
+        } else if (isOneOf(ext, {".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".ply", ".stl", ".blend"})) {
+            onModelChanged(path);
+        } else if (isOneOf(ext, {".png", ".jpg", ".jpeg", ".tga", ".bmp"})) {
+            onTextureChanged(path);
+        }
+    }
+}
+
+void HotReload::onShaderChanged(const std::string &path)
+{
+    // La compilation reste sur le thread GL ; le cache binaire ne sert pas ici puisque la source a changé
+    for (ShaderPermutations *permutations : shaders) {
+        if (FileWatcher::SamePath(permutations->vertexFile(), path) ||
+            FileWatcher::SamePath(permutations->fragmentFile(), path)) {
+            logger.info("Shader modifie: " + path);
+            permutations->reload();
+        }
+    }
+}
+
+void HotReload::onModelChanged(const std::string &path)
+{
+    logger.info("Modele modifie: " + path);
+    models.reloadAsset(path);
+}
+
+void HotReload::onMaterialChanged(const std::string &path)
+{
+    // Un .mtl n'indique pas quel .obj le référence : on recharge les modèles de son dossier
+    const std::string directory = std::filesystem::path(path).parent_path().string();
+    for (const std::string &asset : models.loadedAssets()) {
+        if (FileWatcher::SamePath(std::filesystem::path(asset).parent_path().string(), directory)) {
+            logger.info("Materiau modifie: " + path + " -> " + asset);
+            models.reloadAsset(asset);
+        }
+    }
+}
+
+void HotReload::onTextureChanged(const std::string &path)
+{
+    for (const std::string &cached : Texture2D::CachedPaths()) {
+        if (!FileWatcher::SamePath(cached, path)) continue;
+
+        logger.info("Texture modifiee: " + cached);
+        JobSystem::Instance().submit([cached]() {
+            Texture2D::Image image = Texture2D::Decode(cached);
+            if (!image.valid()) return;
+            JobSystem::Instance().runOnMainThread([cached, image]() {
+                // Texture partagée avec un fichier identique : ce chemin en reçoit une nouvelle,
+                // reliée aux matériaux par le RelinkHandler
+                Texture2D::Store(cached, image);
+            });
+        });
+    }
+}
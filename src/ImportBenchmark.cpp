@@ -0,0 +1,63 @@
+#include "ImportBenchmark.h"
+#include "Model.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+static ComponentLogger benchLogger("Import");
+
+namespace {
+struct Timing {
+    double minMs = std::numeric_limits<double>::max();
+    double totalMs = 0.0;
+    size_t meshes = 0;
+    size_t vertices = 0;
+};
+
+Timing measure(const std::string &path, int iterations, bool native)
+{
+    Model::SetNativeImporters(native);
+    Timing timing;
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        Model model(path, false, true);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        timing.minMs = std::min(timing.minMs, ms);
+        timing.totalMs += ms;
+        timing.meshes = model.meshes.size();
+        timing.vertices = 0;
+        for (const auto &mesh : model.meshes) timing.vertices += mesh.vertices.size();
+    }
+    return timing;
+}
+
+std::string describe(const char *name, const Timing &t, int iterations)
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-8s min %8.2f ms  moy %8.2f ms  (%zu maillages, %zu sommets)",
+                  name, t.minMs, t.totalMs / iterations, t.meshes, t.vertices);
+    return line;
+}
+}
+
+int ImportBenchmark::Run(const std::string &path, int iterations)
+{
+    iterations = std::max(iterations, 1);
+    const bool previous = Model::UsesNativeImporters();
+
+    const Timing native = measure(path, iterations, true);
+    const Timing assimp = measure(path, iterations, false);
+    Model::SetNativeImporters(previous);
+
+    const std::string header = "Import de " + path + " (" + std::to_string(iterations) + " iterations)";
+    std::cout << header << "\n" << describe("integre", native, iterations) << "\n"
+              << describe("assimp", assimp, iterations) << std::endl;
+    benchLogger.info(header);
+    benchLogger.info(describe("integre", native, iterations));
+    benchLogger.info(describe("assimp", assimp, iterations));
+    return native.meshes > 0 || assimp.meshes > 0 ? 0 : 1;
+}
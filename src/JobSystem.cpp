@@ -0,0 +1,178 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+ComponentLogger JobSystem::logger("Jobs");
+
+namespace {
+// Vrai sur le thread qui exécute un travail de la file de basse priorité
+thread_local bool inBackgroundJob = false;
+}
+
+JobSystem& JobSystem::Instance()
+{
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::JobSystem()
+{
+    // On laisse un cœur au thread de rendu
+    unsigned int hw = std::thread::hardware_concurrency();
+    unsigned int count = std::max(1u, hw > 1 ? hw - 1 : 1u);
+    workers.reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+    logger.info("JobSystem demarre avec " + std::to_string(count) + " threads");
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void JobSystem::submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(job));
+    }
+    queueCv.notify_one();
+}
+
+void JobSystem::submitBackground(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        backgroundQueue.push_back(std::move(job));
+    }
+    queueCv.notify_one();
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0) return;
+    // Un travail de basse priorité n'occupe pas d'autres threads que le sien
+    if (count == 1 || workers.empty() || inBackgroundJob) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    // État partagé avec les assistants : ceux qui démarrent après la fin ne trouvent plus
+    // d'indice à prendre et ne touchent pas à body
+    struct Batch {
+        const std::function<void(size_t)>* body = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->body = &body;
+    batch->count = count;
+
+    auto run = [batch]() {
+        for (;;) {
+            const size_t i = batch->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= batch->count) return;
+            try {
+                (*batch->body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                if (!batch->error) batch->error = std::current_exception();
+            }
+            if (batch->done.fetch_add(1, std::memory_order_acq_rel) + 1 == batch->count) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) submit(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->cv.wait(lock, [&batch] { return batch->done.load(std::memory_order_acquire) == batch->count; });
+    if (batch->error) std::rethrow_exception(batch->error);
+}
+
+void JobSystem::runOnMainThread(Job job)
+{
+    std::lock_guard<std::mutex> lock(mainThreadMutex);
+    mainThreadJobs.push_back(std::move(job));
+}
+
+void JobSystem::drainMainThread()
+{
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        jobs.swap(mainThreadJobs);
+    }
+    for (auto& job : jobs) {
+        PROFILE_ZONE_CAT("Main thread job", "job");
+        try {
+            job();
+        } catch (const std::exception& ex) {
+            logger.error(std::string("Echec d'une tache du thread principal: ") + ex.what());
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned int index)
+{
+    TraceCapture::SetThreadName("Worker " + std::to_string(index));
+    for (;;) {
+        Job job;
+        bool background = false;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCv.wait(lock, [this] {
+                return stopping || !queue.empty() || (!backgroundQueue.empty() && !backgroundRunning);
+            });
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+            } else if (stopping) {
+                return;
+            } else {
+                job = std::move(backgroundQueue.front());
+                backgroundQueue.pop_front();
+                backgroundRunning = background = true;
+            }
+        }
+        {
+            PROFILE_ZONE_CAT(background ? "Background job" : "Job", "job");
+            inBackgroundJob = background;
+            try {
+                job();
+            } catch (const std::exception& ex) {
+                logger.error(std::string("Echec d'une tache en arriere-plan: ") + ex.what());
+            }
+            inBackgroundJob = false;
+        }
+        if (background) {
+            bool more;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                backgroundRunning = false;
+                more = !backgroundQueue.empty();
+            }
+            if (more) queueCv.notify_one();
+        }
+    }
+}
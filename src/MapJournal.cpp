@@ -0,0 +1,440 @@
+#include "MapJournal.h"
+#include "AtomicFile.h"
+#include "ContentHash.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "SceneSerializer.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static ComponentLogger journalLogger("Map");
+
+namespace {
+const char kMagic[8] = {'S', 'B', 'J', 'R', 'N', 'L', '\r', '\n'};
+const uint32_t kVersion = 1;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t baseHash;         // xxHash64 de la map à laquelle s'appliquent les enregistrements
+};
+static_assert(sizeof(JournalHeader) == 24, "en-tete de journal de taille fixe");
+
+// Enregistrement : type et taille (2 x u32), charge utile, somme de contrôle u32
+enum RecordType : uint32_t { Add = 1, Update = 2, Remove = 3, Settings = 4, Checkpoint = 5 };
+const size_t kRecordOverhead = 12;
+const size_t kTransformBytes = 4 + 9 * 4;   // index puis position, rotation, échelle
+const size_t kSettingsBytes = 17 * 4;
+
+uint32_t checksum(uint32_t type, const unsigned char *payload, size_t size)
+{
+    return static_cast<uint32_t>(ContentHash::Hash(payload, size, type));
+}
+
+void putRecord(std::vector<unsigned char> &out, uint32_t type, const std::vector<unsigned char> &payload)
+{
+    const uint32_t head[2] = {type, static_cast<uint32_t>(payload.size())};
+    const uint32_t sum = checksum(type, payload.data(), payload.size());
+    const size_t at = out.size();
+    out.resize(at + kRecordOverhead + payload.size());
+    std::memcpy(out.data() + at, head, 8);
+    if (!payload.empty()) std::memcpy(out.data() + at + 8, payload.data(), payload.size());
+    std::memcpy(out.data() + at + 8 + payload.size(), &sum, 4);
+}
+
+std::vector<unsigned char> instancePayload(const InstanceEdit &edit)
+{
+    const uint32_t index = static_cast<uint32_t>(edit.index);
+    std::vector<unsigned char> payload(edit.kind == InstanceEdit::Kind::Remove ? 4 : kTransformBytes);
+    std::memcpy(payload.data(), &index, 4);
+    if (edit.kind == InstanceEdit::Kind::Remove) return payload;
+    std::memcpy(payload.data() + 4, &edit.data.position.x, 12);
+    std::memcpy(payload.data() + 16, &edit.data.rotation.x, 12);
+    std::memcpy(payload.data() + 28, &edit.data.scale.x, 12);
+    if (edit.kind == InstanceEdit::Kind::Add) payload.insert(payload.end(), edit.data.path.begin(), edit.data.path.end());
+    return payload;
+}
+
+std::vector<unsigned char> settingsPayload(const DirectionalLightSettings &l, const EnvironmentSettings &e)
+{
+    const float values[17] = {
+        l.direction.x, l.direction.y, l.direction.z, l.ambient.x, l.ambient.y, l.ambient.z,
+        l.diffuse.x, l.diffuse.y, l.diffuse.z, l.specular.x, l.specular.y, l.specular.z, l.intensity,
+        e.skyColor.x, e.skyColor.y, e.skyColor.z, e.ambientBoost};
+    std::vector<unsigned char> payload(kSettingsBytes);
+    std::memcpy(payload.data(), values, kSettingsBytes);
+    return payload;
+}
+
+// Avance pos sur l'enregistrement suivant ; false s'il est tronqué ou corrompu
+bool nextRecord(const unsigned char *data, size_t size, size_t &pos, uint32_t &type,
+                const unsigned char *&payload, size_t &payloadSize)
+{
+    if (size - pos < kRecordOverhead) return false;
+    uint32_t head[2];
+    std::memcpy(head, data + pos, 8);
+    if (head[1] > size - pos - kRecordOverhead) return false;
+    uint32_t sum;
+    std::memcpy(&sum, data + pos + 8 + head[1], 4);
+    if (sum != checksum(head[0], data + pos + 8, head[1])) return false;
+    type = head[0];
+    payload = data + pos + 8;
+    payloadSize = head[1];
+    pos += kRecordOverhead + head[1];
+    return true;
+}
+
+bool applyRecord(SceneSnapshot &snapshot, uint32_t type, const unsigned char *payload, size_t size)
+{
+    auto &models = snapshot.models;
+    if (type == Checkpoint) return true;
+    if (type == Settings) {
+        if (size != kSettingsBytes) return false;
+        float v[17];
+        std::memcpy(v, payload, kSettingsBytes);
+        snapshot.light.direction = glm::vec3(v[0], v[1], v[2]);
+        snapshot.light.ambient = glm::vec3(v[3], v[4], v[5]);
+        snapshot.light.diffuse = glm::vec3(v[6], v[7], v[8]);
+        snapshot.light.specular = glm::vec3(v[9], v[10], v[11]);
+        snapshot.light.intensity = v[12];
+        snapshot.environment.skyColor = glm::vec3(v[13], v[14], v[15]);
+        snapshot.environment.ambientBoost = v[16];
+        return true;
+    }
+
+    if (size < 4) return false;
+    uint32_t index;
+    std::memcpy(&index, payload, 4);
+    if (type == Remove) {
+        if (size != 4 || index >= models.size()) return false;
+        models.erase(models.begin() + index);
+        return true;
+    }
+
+    if (size < kTransformBytes) return false;
+    ModelInstanceData data;
+    std::memcpy(&data.position.x, payload + 4, 12);
+    std::memcpy(&data.rotation.x, payload + 16, 12);
+    std::memcpy(&data.scale.x, payload + 28, 12);
+    if (type == Add) {
+        if (index > models.size() || size == kTransformBytes) return false;
+        data.path.assign(reinterpret_cast<const char *>(payload + kTransformBytes), size - kTransformBytes);
+        models.insert(models.begin() + index, std::move(data));
+        return true;
+    }
+    if (type != Update || size != kTransformBytes || index >= models.size()) return false;
+    data.path = std::move(models[index].path);
+    models[index] = std::move(data);
+    return true;
+}
+
+// Remplace le journal par un en-tête suivi de tail, via un fichier temporaire renommé
+bool writeJournal(const std::string &path, uint64_t baseHash, const unsigned char *tail, size_t size)
+{
+    JournalHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.reserved = 0;
+    header.baseHash = baseHash;
+
+    const std::string tmp = AtomicFile::TempPath(path);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (size) out.write(reinterpret_cast<const char *>(tail), static_cast<std::streamsize>(size));
+        out.flush();
+        if (!out) return false;
+    }
+    return AtomicFile::Replace(tmp, path);
+}
+
+bool appendToFile(const std::string &path, const std::vector<unsigned char> &bytes)
+{
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        out.flush();
+        if (!out) return false;
+    }
+    return AtomicFile::Sync(path);
+}
+}
+
+std::string MapJournal::JournalPath(const std::string &mapPath)
+{
+    return mapPath + ".journal";
+}
+
+std::optional<SceneSnapshot> MapJournal::Read(const std::string &mapPath)
+{
+    auto snapshot = SceneSerializer::Load(mapPath);
+    if (!snapshot) return std::nullopt;
+    uint64_t hash = 0;
+    ContentHash::HashFile(mapPath, hash);
+    Replay(mapPath, hash, *snapshot, nullptr);
+    return snapshot;
+}
+
+std::optional<SceneSnapshot> MapJournal::load(const std::string &mapPath)
+{
+    PROFILE_ZONE_CAT("MapJournal::load", "io");
+    waitIdle();
+    detach();
+    auto snapshot = SceneSerializer::Load(mapPath);
+    if (!snapshot) return std::nullopt;
+
+    uint64_t hash = 0;
+    ContentHash::HashFile(mapPath, hash);
+    std::vector<unsigned char> tail;
+    Replay(mapPath, hash, *snapshot, &tail);
+
+    if (!attach(mapPath, *snapshot, tail)) journalLogger.error("Journal inutilisable, sauvegardes completes: " + mapPath);
+    return snapshot;
+}
+
+void MapJournal::Replay(const std::string &mapPath, uint64_t mapHash, SceneSnapshot &snapshot, std::vector<unsigned char> *tail)
+{
+    MappedFile file(JournalPath(mapPath));
+    JournalHeader header;
+    if (!file.isOpen() || file.size() < sizeof(header)) return;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return;
+
+    const unsigned char *data = file.data();
+    const size_t size = file.size();
+    uint32_t type;
+    const unsigned char *payload;
+    size_t payloadSize;
+
+    size_t pos = sizeof(header), lastCheckpoint = 0;
+    while (nextRecord(data, size, pos, type, payload, payloadSize)) {
+        if (type == Checkpoint) lastCheckpoint = pos;
+    }
+    size_t end = pos;
+    if (end < size) journalLogger.error("Journal tronque, fin ignoree: " + JournalPath(mapPath));
+
+    // Map réécrite par une compaction dont le journal n'a pas été remis à zéro :
+    // seuls les enregistrements postérieurs à son point de reprise restent à rejouer
+    size_t start = sizeof(header);
+    if (header.baseHash != mapHash) {
+        if (lastCheckpoint) {
+            start = lastCheckpoint;
+        } else {
+            journalLogger.error("Journal ignore, la map a ete modifiee hors de l'editeur: " + mapPath);
+            start = end;
+        }
+    }
+
+    size_t replayed = 0;
+    for (pos = start; pos < end; ++replayed) {
+        const size_t recordStart = pos;
+        nextRecord(data, size, pos, type, payload, payloadSize);
+        if (!applyRecord(snapshot, type, payload, payloadSize)) {
+            journalLogger.error("Enregistrement de journal incoherent, rejeu arrete: " + mapPath);
+            end = recordStart;
+            break;
+        }
+    }
+    if (tail) tail->assign(data + start, data + end);
+    if (replayed) journalLogger.info("Journal rejoue: " + std::to_string(replayed) + " enregistrements, " + mapPath);
+}
+
+void MapJournal::save(const std::string &mapPath, const DirectionalLightSettings &light, const EnvironmentSettings &environment,
+                      InstanceSource instances, Completion done)
+{
+    // Rattaché tout de suite : les modifications faites pendant l'écriture s'accumulent déjà
+    // et partiront dans le journal neuf
+    detach();
+    attachedPath = mapPath;
+    committedSettings = settingsPayload(light, environment);
+    const uint64_t savedGeneration = generation;
+
+    runSerial([this, mapPath, savedGeneration, light, environment, instances = std::move(instances), done = std::move(done)]() mutable {
+        PROFILE_ZONE_CAT("MapJournal::save", "io");
+        SceneSnapshot snapshot;
+        snapshot.light = light;
+        snapshot.environment = environment;
+        snapshot.models = instances();
+        uint64_t hash = 0;
+        const bool ok = SceneSerializer::Save(mapPath, snapshot) && ContentHash::HashFile(mapPath, hash) &&
+                        writeJournal(JournalPath(mapPath), hash, nullptr, 0);
+        JobSystem::Instance().runOnMainThread([this, mapPath, savedGeneration, ok, done, instances = std::move(instances)]() {
+            if (savedGeneration == generation) {
+                if (ok) journalBytes += sizeof(JournalHeader);
+                else detach();
+            }
+            if (!ok) journalLogger.error("Sauvegarde de la map impossible: " + mapPath);
+            if (done) done(ok);
+        });
+    });
+}
+
+bool MapJournal::create(const std::string &mapPath, Completion done)
+{
+    if (isAttachedTo(mapPath)) return false;
+
+    runSerial([mapPath, done = std::move(done)]() {
+        PROFILE_ZONE_CAT("MapJournal::create", "io");
+        // Un journal laissé par une ancienne map du même nom serait rejoué sur la nouvelle
+        std::error_code ec;
+        std::filesystem::remove(JournalPath(mapPath), ec);
+        const bool ok = !ec && SceneSerializer::Save(mapPath, SceneSnapshot());
+        JobSystem::Instance().runOnMainThread([mapPath, ok, done]() {
+            if (!ok) journalLogger.error("Creation de la map impossible: " + mapPath);
+            if (done) done(ok);
+        });
+    });
+    return true;
+}
+
+bool MapJournal::attach(const std::string &mapPath, const SceneSnapshot &state, const std::vector<unsigned char> &tail)
+{
+    detach();
+    uint64_t hash = 0;
+    if (!ContentHash::HashFile(mapPath, hash) ||
+        !writeJournal(JournalPath(mapPath), hash, tail.data(), tail.size())) {
+        return false;
+    }
+    attachedPath = mapPath;
+    journalBytes = sizeof(JournalHeader) + tail.size();
+    committedSettings = settingsPayload(state.light, state.environment);
+    return true;
+}
+
+void MapJournal::detach()
+{
+    attachedPath.clear();
+    pending.clear();
+    lastUpdateOffset = SIZE_MAX;
+    journalBytes = 0;
+    ++generation;
+}
+
+void MapJournal::record(const InstanceEdit &edit)
+{
+    if (attachedPath.empty()) return;
+    std::vector<unsigned char> payload = instancePayload(edit);
+
+    // Réglages successifs d'une même instance (glisser une valeur) : seul le dernier est gardé
+    if (edit.kind == InstanceEdit::Kind::Update && lastUpdateOffset != SIZE_MAX && lastUpdateIndex == edit.index) {
+        pending.resize(lastUpdateOffset);
+    } else {
+        lastUpdateOffset = SIZE_MAX;
+    }
+    if (edit.kind == InstanceEdit::Kind::Update) {
+        lastUpdateOffset = pending.size();
+        lastUpdateIndex = edit.index;
+    }
+    const uint32_t type = edit.kind == InstanceEdit::Kind::Add ? Add : edit.kind == InstanceEdit::Kind::Update ? Update : Remove;
+    putRecord(pending, type, payload);
+}
+
+bool MapJournal::commit(const std::string &mapPath, const DirectionalLightSettings &light, const EnvironmentSettings &environment,
+                        Completion done)
+{
+    if (!isAttachedTo(mapPath)) return false;
+
+    std::vector<unsigned char> settings = settingsPayload(light, environment);
+    if (settings != committedSettings) {
+        putRecord(pending, Settings, settings);
+        committedSettings = std::move(settings);
+    }
+    if (pending.empty()) {
+        if (done) done(true);
+        return true;
+    }
+
+    std::vector<unsigned char> bytes = std::move(pending);
+    pending.clear();
+    lastUpdateOffset = SIZE_MAX;
+    const uint64_t committedGeneration = generation;
+    runSerial([this, mapPath, committedGeneration, bytes = std::move(bytes), done = std::move(done)]() {
+        PROFILE_ZONE_CAT("MapJournal::commit", "io");
+        const bool ok = appendToFile(JournalPath(mapPath), bytes);
+        const size_t size = bytes.size();
+        JobSystem::Instance().runOnMainThread([this, mapPath, committedGeneration, ok, size, done]() {
+            if (committedGeneration == generation) {
+                // Enregistrements perdus : seule une sauvegarde complète redonne un état sûr
+                if (ok) journalBytes += size;
+                else detach();
+            }
+            if (!ok) journalLogger.error("Ecriture du journal impossible: " + JournalPath(mapPath));
+            if (done) done(ok);
+        });
+    });
+    return true;
+}
+
+void MapJournal::compact(const DirectionalLightSettings &light, const EnvironmentSettings &environment, InstanceSource instances)
+{
+    if (!wantsCompaction()) return;
+    compacting = true;
+    const uint64_t compactedGeneration = generation;
+    const std::string mapPath = attachedPath;
+    journalLogger.info("Compaction du journal en arriere-plan: " + mapPath);
+
+    // Écritures en série : le journal ne contient alors que ce que l'instantané inclut déjà
+    runSerial([this, mapPath, compactedGeneration, light, environment, instances = std::move(instances)]() mutable {
+        PROFILE_ZONE_CAT("MapJournal::compact", "io");
+        SceneSnapshot snapshot;
+        snapshot.light = light;
+        snapshot.environment = environment;
+        snapshot.models = instances();
+        // Point de reprise : si la map est remplacée mais que le journal n'est pas remis à zéro
+        // (crash entre les deux), le chargement ne rejoue que ce qui le suit
+        std::vector<unsigned char> checkpoint;
+        putRecord(checkpoint, Checkpoint, {});
+        uint64_t hash = 0;
+        const bool ok = appendToFile(JournalPath(mapPath), checkpoint) && SceneSerializer::Save(mapPath, snapshot) &&
+                        ContentHash::HashFile(mapPath, hash) && writeJournal(JournalPath(mapPath), hash, nullptr, 0);
+
+        JobSystem::Instance().runOnMainThread([this, mapPath, compactedGeneration, ok, instances = std::move(instances)]() {
+            compacting = false;
+            if (!ok) {
+                journalLogger.error("Compaction echouee: " + mapPath);
+                if (compactedGeneration == generation) detach();
+                return;
+            }
+            // Les ajouts soumis après la compaction sont comptés par leurs propres fins d'écriture
+            if (compactedGeneration == generation) journalBytes = sizeof(JournalHeader);
+            journalLogger.info("Map compactee: " + mapPath);
+        });
+    });
+}
+
+void MapJournal::runSerial(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(ioMutex);
+    ioTasks.push_back(std::move(task));
+    if (ioRunning) return;
+    ioRunning = true;
+    JobSystem::Instance().submit([this]() {
+        for (;;) {
+            std::function<void()> next;
+            {
+                std::lock_guard<std::mutex> lock(ioMutex);
+                if (ioTasks.empty()) {
+                    ioRunning = false;
+                    ioIdle.notify_all();
+                    return;
+                }
+                next = std::move(ioTasks.front());
+                ioTasks.pop_front();
+            }
+            next();
+        }
+    });
+}
+
+void MapJournal::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(ioMutex);
+    ioIdle.wait(lock, [this]() { return !ioRunning; });
+}
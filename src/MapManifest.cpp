@@ -0,0 +1,162 @@
+#include "MapManifest.h"
+#include "AtomicFile.h"
+#include "ContentHash.h"
+#include "Log.h"
+#include "MapJournal.h"
+#include "Profiler.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static ComponentLogger manifestLogger("Map");
+
+namespace {
+const int kVersion = 1;
+
+// Taille et date de modification de la map et de son journal, au moment de la construction
+struct Source {
+    uint64_t mapBytes = 0;
+    int64_t mapTime = 0;
+    uint64_t journalBytes = 0;
+    int64_t journalTime = 0;
+
+    bool operator==(const Source &o) const
+    {
+        return mapBytes == o.mapBytes && mapTime == o.mapTime && journalBytes == o.journalBytes && journalTime == o.journalTime;
+    }
+};
+
+bool statFile(const std::string &path, uint64_t &bytes, int64_t &time)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    const auto stamp = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    bytes = static_cast<uint64_t>(size);
+    time = static_cast<int64_t>(stamp.time_since_epoch().count());
+    return true;
+}
+
+bool currentSource(const std::string &mapPath, Source &source)
+{
+    if (!statFile(mapPath, source.mapBytes, source.mapTime)) return false;
+    statFile(MapJournal::JournalPath(mapPath), source.journalBytes, source.journalTime);
+    return true;
+}
+
+json sourceJson(const Source &s)
+{
+    return json{{"mapBytes", s.mapBytes}, {"mapTime", s.mapTime}, {"journalBytes", s.journalBytes}, {"journalTime", s.journalTime}};
+}
+}
+
+uint64_t MapManifest::estimatedBytes() const
+{
+    uint64_t total = 0;
+    for (const auto &asset : assets) total += asset.bytes;
+    return total;
+}
+
+std::vector<std::string> MapManifest::assetPaths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(assets.size());
+    for (const auto &asset : assets) paths.push_back(asset.path);
+    return paths;
+}
+
+std::string MapManifest::SidecarPath(const std::string &mapPath)
+{
+    return mapPath + ".manifest";
+}
+
+std::optional<MapManifest> MapManifest::Read(const std::string &mapPath)
+{
+    Source source;
+    if (!currentSource(mapPath, source)) return std::nullopt;
+
+    std::ifstream in(SidecarPath(mapPath), std::ios::binary);
+    if (!in) return std::nullopt;
+    const json doc = json::parse(in, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object() || doc.value("version", 0) != kVersion) return std::nullopt;
+
+    try {
+        const json &s = doc.at("source");
+        Source stored;
+        stored.mapBytes = s.at("mapBytes").get<uint64_t>();
+        stored.mapTime = s.at("mapTime").get<int64_t>();
+        stored.journalBytes = s.at("journalBytes").get<uint64_t>();
+        stored.journalTime = s.at("journalTime").get<int64_t>();
+        if (!(stored == source)) return std::nullopt;
+
+        MapManifest manifest;
+        manifest.instanceCount = doc.at("instances").get<size_t>();
+        for (const auto &a : doc.at("assets")) {
+            Asset asset;
+            asset.path = a.at("path").get<std::string>();
+            asset.bytes = a.at("bytes").get<uint64_t>();
+            asset.hash = a.at("hash").get<uint64_t>();
+            asset.instances = a.at("instances").get<size_t>();
+            manifest.assets.push_back(std::move(asset));
+        }
+        return manifest;
+    } catch (const json::exception &) {
+        return std::nullopt;
+    }
+}
+
+std::optional<MapManifest> MapManifest::Build(const std::string &mapPath)
+{
+    PROFILE_ZONE_CAT("MapManifest::Build", "io");
+    // Relevé avant lecture : une map réécrite pendant la construction laisse un manifeste périmé
+    Source source;
+    if (!currentSource(mapPath, source)) return std::nullopt;
+    const auto snapshot = MapJournal::Read(mapPath);
+    if (!snapshot) return std::nullopt;
+
+    MapManifest manifest;
+    manifest.instanceCount = snapshot->models.size();
+    std::map<std::string, size_t> uses;
+    for (const auto &instance : snapshot->models) {
+        if (!instance.path.empty()) ++uses[instance.path];
+    }
+    for (const auto &use : uses) {
+        Asset asset;
+        asset.path = use.first;
+        asset.instances = use.second;
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(asset.path, ec);
+        if (!ec) {
+            asset.bytes = static_cast<uint64_t>(size);
+            ContentHash::HashFile(asset.path, asset.hash);
+        }
+        manifest.assets.push_back(std::move(asset));
+    }
+
+    json assets = json::array();
+    for (const auto &asset : manifest.assets) {
+        assets.push_back({{"path", asset.path}, {"bytes", asset.bytes}, {"hash", asset.hash}, {"instances", asset.instances}});
+    }
+    const json doc = {{"version", kVersion}, {"source", sourceJson(source)}, {"instances", manifest.instanceCount}, {"assets", assets}};
+
+    const std::string path = SidecarPath(mapPath);
+    const std::string tmp = AtomicFile::TempPath(path);
+    bool written;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << doc.dump(1);
+        written = static_cast<bool>(out);
+    }
+    if (!written || !AtomicFile::Replace(tmp, path)) {
+        std::remove(tmp.c_str());
+        manifestLogger.error("Ecriture du manifeste impossible: " + path);
+    }
+    return manifest;
+}
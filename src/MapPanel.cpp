@@ -1,5 +1,9 @@
 #include "MapPanel.h"
 #include "EditorState.h"
+#include "JobSystem.h"
+#include "ModelManager.h"
+#include "SceneSerializer.h"
+#include "ThumbnailRenderer.h"
 
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
@@ -7,38 +11,31 @@
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 
 namespace fs = std::filesystem;
 
-namespace {
-std::string toLower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
-    return s;
-}
-
-bool matchesFilter(const std::string& value, const std::string& filter) {
-    if (filter.empty()) return true;
-    return toLower(value).find(toLower(filter)) != std::string::npos;
-}
-}
-
 MapPanel::MapPanel(const std::string& root,
                    SaveCallback saveCb,
                    LoadCallback loadCb,
                    NewCallback newCb,
-                   EditorState* editorState)
+                   EditorState* editorState,
+                   AssetDatabase* mapAssets,
+                   ModelManager* modelManager)
     : mapsRoot(root)
     , save(std::move(saveCb))
     , load(std::move(loadCb))
     , createNew(std::move(newCb))
     , editor(editorState)
+    , maps(mapAssets)
+    , models(modelManager)
 {
     scanFiles();
 }
 
 void MapPanel::rescan()
 {
-    scanFiles();
+    if (maps) maps->rescan();
 }
 
 void MapPanel::draw(bool* open)
@@ -50,6 +47,12 @@ void MapPanel::draw(bool* open)
         }
         ImGui::SameLine();
         ImGui::InputText("Filter", &filter);
+        if (maps && maps->version() != listingVersion) {
+            scanFiles();
+        } else if (listing && filter != matchedFilter) {
+            matches = listing->search(filter);
+            matchedFilter = filter;
+        }
 
         ImGui::TextDisabled("Root: %s", mapsRoot.c_str());
         if (editor) {
@@ -58,24 +61,35 @@ void MapPanel::draw(bool* open)
 
         ImGui::Separator();
         ImGui::BeginChild("maps_list", ImVec2(0, 180), true);
-        for (int i = 0; i < static_cast<int>(files.size()); ++i) {
+        for (uint32_t match : matches) {
+            const int i = static_cast<int>(match);
             const std::string& path = files[i];
             std::string name = displayName(path);
-            if (!matchesFilter(name, filter)) continue;
             bool selectedEntry = (i == selected);
             if (ImGui::Selectable(name.c_str(), selectedEntry)) {
                 selected = i;
+                prefetch(path);
+            }
+            if (ImGui::IsItemHovered()) {
+                if (hoveredPath != path) {
+                    hoveredPath = path;
+                    hoverStart = ImGui::GetTime();
+                } else if (ImGui::GetTime() - hoverStart >= HoverDelay) {
+                    prefetch(path);
+                }
+            } else if (hoveredPath == path) {
+                hoveredPath.clear();
             }
         }
         ImGui::EndChild();
 
         bool hasSelection = selected >= 0 && selected < static_cast<int>(files.size());
         std::string activePath = hasSelection ? files[selected] : pathForCurrentMap();
+        drawManifest(!hoveredPath.empty() ? hoveredPath : selectedPath());
 
         if (ImGui::Button("Save")) {
             if (save && !activePath.empty()) {
                 if (save(activePath)) {
-                    scanFiles();
                     selectPath(activePath);
                 }
             }
@@ -96,7 +110,6 @@ void MapPanel::draw(bool* open)
             if (createNew) {
                 std::string newPath = resolvePath(newMapName.empty() ? "new_map" : newMapName);
                 if (!newPath.empty() && createNew(newPath)) {
-                    scanFiles();
                     selectPath(newPath);
                 }
             }
@@ -107,21 +120,36 @@ void MapPanel::draw(bool* open)
 
 void MapPanel::scanFiles()
 {
+    if (!maps) return;
+    const std::string previous = wantedSelection.empty() ? selectedPath() : wantedSelection;
+    listing = maps->index();
+    listingVersion = maps->version();
     files.clear();
-    std::error_code ec;
-    if (!mapsRoot.empty() && fs::exists(mapsRoot, ec)) {
-        for (auto& entry : fs::directory_iterator(mapsRoot, ec)) {
-            if (entry.is_regular_file()) {
-                std::string ext = toLower(entry.path().extension().string());
-                if (ext == ".json") {
-                    files.push_back(entry.path().string());
-                }
-            }
-        }
+    for (const auto& entry : listing->entries()) files.push_back(entry.path);
+    matches = listing->search(filter);
+    matchedFilter = filter;
+    selected = -1;
+    if (!previous.empty()) selectPath(previous);
+
+    // Seules les maps nouvelles ou modifiées relisent leur manifeste
+    std::map<std::string, Stamp> seen;
+    for (const auto& entry : listing->entries()) {
+        const Stamp stamp(entry.bytes, entry.modified);
+        auto known = manifestStamps.find(entry.path);
+        if (known == manifestStamps.end() || known->second != stamp) requestManifest(entry.path);
+        seen.emplace(entry.path, stamp);
     }
-    std::sort(files.begin(), files.end());
-    if (selected >= static_cast<int>(files.size())) {
-        selected = files.empty() ? -1 : static_cast<int>(files.size()) - 1;
+    for (auto it = manifests.begin(); it != manifests.end();) {
+        it = seen.count(it->first) ? std::next(it) : manifests.erase(it);
+    }
+    manifestStamps = std::move(seen);
+}
+
+void MapPanel::mapSaved(const std::string& path)
+{
+    const fs::path saved = fs::path(path).lexically_normal();
+    for (const auto& file : files) {
+        if (fs::path(file).lexically_normal() == saved) requestManifest(file);
     }
 }
 
@@ -140,11 +168,7 @@ std::string MapPanel::resolvePath(const std::string& name) const
     sanitized.erase(std::remove_if(sanitized.begin(), sanitized.end(), [](unsigned char c){ return std::isspace(c); }), sanitized.end());
     if (sanitized.empty()) return std::string();
     fs::path p = mapsRoot;
-    fs::path filename = sanitized;
-    if (filename.extension() != ".json") {
-        filename.replace_extension(".json");
-    }
-    p /= filename;
+    p /= SceneSerializer::WithMapExtension(sanitized);
     return p.string();
 }
 
@@ -156,7 +180,7 @@ std::string MapPanel::displayName(const std::string& path) const
 std::string MapPanel::pathForCurrentMap() const
 {
     if (!editor || editor->currentMapName.empty()) return std::string();
-    return resolvePath(editor->currentMapName);
+    return resolvePath(editor->currentMapName + editor->currentMapExtension);
 }
 
 void MapPanel::selectPath(const std::string& path)
@@ -164,7 +188,62 @@ void MapPanel::selectPath(const std::string& path)
     for (int i = 0; i < static_cast<int>(files.size()); ++i) {
         if (files[i] == path) {
             selected = i;
-            break;
+            wantedSelection.clear();
+            return;
         }
     }
+    // Écriture en arrière-plan : le fichier entre dans l'index un peu plus tard
+    wantedSelection = path;
+}
+
+void MapPanel::requestManifest(const std::string& path)
+{
+    if (manifestsPending.count(path)) {
+        manifestsStale.insert(path);
+        return;
+    }
+    manifestsPending.insert(path);
+    // Lecture comprise : le thread de l'interface n'ouvre aucun fichier. L'ancien manifeste reste
+    // affiché en attendant.
+    JobSystem::Instance().submitBackground([this, path]() {
+        auto manifest = MapManifest::Read(path);
+        if (!manifest) manifest = MapManifest::Build(path);
+        JobSystem::Instance().runOnMainThread([this, path, manifest]() {
+            manifestsPending.erase(path);
+            if (manifest) {
+                manifests[path] = *manifest;
+                if (path == prefetchTarget && models) models->prefetchAssets(manifest->assetPaths());
+            } else {
+                manifests.erase(path);
+            }
+            if (manifestsStale.erase(path)) requestManifest(path);
+        });
+    });
+}
+
+void MapPanel::prefetch(const std::string& path)
+{
+    if (!models || path == prefetchTarget) return;
+    prefetchTarget = path;
+    // Sans manifeste, le préchargement part à la fin de sa construction
+    auto it = manifests.find(path);
+    if (it != manifests.end()) models->prefetchAssets(it->second.assetPaths());
+}
+
+void MapPanel::drawManifest(const std::string& path) const
+{
+    if (path.empty()) return;
+    const GLuint thumbnail = thumbnails ? thumbnails->mapThumbnail(path) : 0;
+    if (thumbnail) {
+        const float size = static_cast<float>(ThumbnailRenderer::Size);
+        ImGui::Image((ImTextureID)(intptr_t)thumbnail, ImVec2(size, size), ImVec2(0, 1), ImVec2(1, 0));
+    }
+    auto it = manifests.find(path);
+    if (it == manifests.end()) {
+        ImGui::TextDisabled("%s", manifestsPending.count(path) ? "Reading map..." : "No manifest");
+        return;
+    }
+    const MapManifest& manifest = it->second;
+    ImGui::TextDisabled("%zu instances, %zu assets, ~%.1f MB", manifest.instanceCount, manifest.assets.size(),
+                        static_cast<double>(manifest.estimatedBytes()) / (1024.0 * 1024.0));
 }
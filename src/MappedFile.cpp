@@ -0,0 +1,70 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) {
+            opened = true;
+        } else {
+            void *ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                bytes = static_cast<const unsigned char *>(ptr);
+                opened = true;
+            } else {
+                length = 0;
+            }
+        }
+    }
+    // La projection reste valide après fermeture du descripteur
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(other.bytes), length(other.length), opened(other.opened)
+{
+    other.bytes = nullptr;
+    other.length = 0;
+    other.opened = false;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        bytes = other.bytes;
+        length = other.length;
+        opened = other.opened;
+        other.bytes = nullptr;
+        other.length = 0;
+        other.opened = false;
+    }
+    return *this;
+}
+
+void MappedFile::adviseSequential() const
+{
+    if (bytes) madvise(const_cast<unsigned char *>(bytes), length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::close()
+{
+    if (bytes) munmap(const_cast<unsigned char *>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+}
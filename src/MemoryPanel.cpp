@@ -0,0 +1,124 @@
+#include "MemoryPanel.h"
+#include "MemoryTracker.h"
+#include "TextureResidency.h"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <vector>
+
+namespace {
+std::string formatBytes(size_t bytes)
+{
+    char buf[32];
+    if (bytes >= 1024u * 1024u) snprintf(buf, sizeof(buf), "%.2f Mo", bytes / (1024.0 * 1024.0));
+    else snprintf(buf, sizeof(buf), "%.1f Ko", bytes / 1024.0);
+    return buf;
+}
+
+struct AssetUsage {
+    std::string owner;
+    size_t gpu = 0;
+    size_t cpu = 0;
+};
+}
+
+MemoryPanel::MemoryPanel()
+{
+}
+
+void MemoryPanel::draw(bool* open)
+{
+    if (open && !(*open)) return;
+
+    ImGui::SetNextWindowSize(ImVec2(460, 520), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Memoire", open)) {
+        std::vector<MemoryTracker::Entry> entries = MemoryTracker::Snapshot();
+
+        size_t gpuTotal = 0, cpuTotal = 0;
+        for (int k = 0; k < static_cast<int>(MemoryKind::Count); ++k) {
+            MemoryKind kind = static_cast<MemoryKind>(k);
+            (MemoryTracker::IsGpu(kind) ? gpuTotal : cpuTotal) += MemoryTracker::Total(kind);
+        }
+
+        if (ImGui::CollapsingHeader("Totaux", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Text("GPU: %s", formatBytes(gpuTotal).c_str());
+            ImGui::SameLine(200);
+            ImGui::Text("CPU: %s", formatBytes(cpuTotal).c_str());
+            for (int k = 0; k < static_cast<int>(MemoryKind::Count); ++k) {
+                MemoryKind kind = static_cast<MemoryKind>(k);
+                ImGui::BulletText("%-13s %s", MemoryTracker::KindName(kind), formatBytes(MemoryTracker::Total(kind)).c_str());
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Residence des textures", ImGuiTreeNodeFlags_DefaultOpen)) {
+            TextureResidency::Stats stats = TextureResidency::GetStats();
+            int budgetMb = static_cast<int>(stats.budget / (1024 * 1024));
+            if (ImGui::SliderInt("Budget (Mo)", &budgetMb, 64, 8192)) {
+                TextureResidency::SetBudget(static_cast<size_t>(budgetMb) * 1024u * 1024u);
+            }
+            ImGui::Text("Resident: %s / pleine resolution: %s", formatBytes(stats.resident).c_str(), formatBytes(stats.full).c_str());
+            ImGui::Text("%zu textures, %zu reduites, %zu evincees, %zu en chargement",
+                        stats.textures, stats.demoted, stats.evicted, stats.loading);
+            ImGui::Text("Niveaux en attente d'envoi: %zu", stats.queuedUploads);
+        }
+
+        if (ImGui::CollapsingHeader("Par asset", ImGuiTreeNodeFlags_DefaultOpen)) {
+            std::map<std::string, AssetUsage> byOwner;
+            for (const auto& e : entries) {
+                AssetUsage& usage = byOwner[e.owner];
+                usage.owner = e.owner;
+                (MemoryTracker::IsGpu(e.kind) ? usage.gpu : usage.cpu) += e.bytes;
+            }
+            std::vector<AssetUsage> assets;
+            for (auto& entry : byOwner) assets.push_back(entry.second);
+            std::sort(assets.begin(), assets.end(), [](const AssetUsage& a, const AssetUsage& b) {
+                return a.gpu + a.cpu > b.gpu + b.cpu;
+            });
+
+            if (ImGui::BeginTable("assets", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0, 180))) {
+                ImGui::TableSetupColumn("Asset");
+                ImGui::TableSetupColumn("GPU", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+                ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+                ImGui::TableHeadersRow();
+                for (const auto& usage : assets) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(usage.owner.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(formatBytes(usage.gpu).c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(formatBytes(usage.cpu).c_str());
+                }
+                ImGui::EndTable();
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Plus gros consommateurs", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::SliderInt("N", &topCount, 5, 50);
+            const size_t n = std::min(entries.size(), static_cast<size_t>(topCount));
+            std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                              [](const MemoryTracker::Entry& a, const MemoryTracker::Entry& b) { return a.bytes > b.bytes; });
+            for (size_t i = 0; i < n; ++i) {
+                ImGui::Text("%10s  %-12s %s", formatBytes(entries[i].bytes).c_str(),
+                            MemoryTracker::KindName(entries[i].kind), entries[i].owner.c_str());
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::Button("Exporter CSV")) {
+            std::time_t t = std::time(nullptr);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&t));
+            std::string path = std::string("logs/memory_") + stamp + ".csv";
+            lastExport = MemoryTracker::ExportCsv(path) ? path : std::string("Echec de l'export");
+        }
+        if (!lastExport.empty()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", lastExport.c_str());
+        }
+    }
+    ImGui::End();
+}
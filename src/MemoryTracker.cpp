@@ -0,0 +1,141 @@
+#include "MemoryTracker.h"
+
+#include <filesystem>
+#include <fstream>
+
+std::mutex MemoryTracker::mutex;
+std::map<std::pair<int, GLuint>, MemoryTracker::Entry> MemoryTracker::gpu;
+std::map<std::pair<std::string, MemoryKind>, size_t> MemoryTracker::cpu;
+size_t MemoryTracker::totals[static_cast<size_t>(MemoryKind::Count)] = {};
+ComponentLogger MemoryTracker::logger("Memory");
+
+namespace {
+thread_local std::string currentOwner = "(inconnu)";
+}
+
+const std::string& MemoryTracker::CurrentOwner()
+{
+    return currentOwner;
+}
+
+MemoryTracker::OwnerScope::OwnerScope(const std::string& owner)
+    : previous(currentOwner)
+{
+    currentOwner = owner;
+}
+
+MemoryTracker::OwnerScope::~OwnerScope()
+{
+    currentOwner = previous;
+}
+
+const char* MemoryTracker::KindName(MemoryKind kind)
+{
+    switch (kind) {
+        case MemoryKind::VertexBuffer: return "VertexBuffer";
+        case MemoryKind::IndexBuffer:  return "IndexBuffer";
+        case MemoryKind::StreamBuffer: return "StreamBuffer";
+        case MemoryKind::Texture:      return "Texture";
+        case MemoryKind::CpuMesh:      return "CpuMesh";
+        case MemoryKind::CpuTexture:   return "CpuTexture";
+        default:                       return "?";
+    }
+}
+
+void MemoryTracker::TrackBuffer(GLuint id, MemoryKind kind, size_t bytes, const std::string& owner)
+{
+    if (!id) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(static_cast<int>(BufferDomain), id);
+    auto it = gpu.find(key);
+    if (it != gpu.end()) totals[static_cast<size_t>(it->second.kind)] -= it->second.bytes;
+    gpu[key] = Entry{owner, kind, bytes};
+    totals[static_cast<size_t>(kind)] += bytes;
+}
+
+void MemoryTracker::UntrackBuffer(GLuint id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = gpu.find(std::make_pair(static_cast<int>(BufferDomain), id));
+    if (it == gpu.end()) return;
+    totals[static_cast<size_t>(it->second.kind)] -= it->second.bytes;
+    gpu.erase(it);
+}
+
+void MemoryTracker::TrackTexture(GLuint id, size_t bytes, const std::string& owner)
+{
+    if (!id) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(static_cast<int>(TextureDomain), id);
+    auto it = gpu.find(key);
+    if (it != gpu.end()) totals[static_cast<size_t>(it->second.kind)] -= it->second.bytes;
+    gpu[key] = Entry{owner, MemoryKind::Texture, bytes};
+    totals[static_cast<size_t>(MemoryKind::Texture)] += bytes;
+}
+
+void MemoryTracker::UntrackTexture(GLuint id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = gpu.find(std::make_pair(static_cast<int>(TextureDomain), id));
+    if (it == gpu.end()) return;
+    totals[static_cast<size_t>(MemoryKind::Texture)] -= it->second.bytes;
+    gpu.erase(it);
+}
+
+void MemoryTracker::SetCpu(const std::string& owner, MemoryKind kind, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(owner, kind);
+    auto it = cpu.find(key);
+    if (it != cpu.end()) {
+        totals[static_cast<size_t>(kind)] -= it->second;
+        if (bytes == 0) {
+            cpu.erase(it);
+            return;
+        }
+        it->second = bytes;
+    } else if (bytes != 0) {
+        cpu.emplace(key, bytes);
+    }
+    totals[static_cast<size_t>(kind)] += bytes;
+}
+
+std::vector<MemoryTracker::Entry> MemoryTracker::Snapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> entries;
+    entries.reserve(gpu.size() + cpu.size());
+    for (const auto& e : gpu) entries.push_back(e.second);
+    for (const auto& e : cpu) entries.push_back(Entry{e.first.first, e.first.second, e.second});
+    return entries;
+}
+
+size_t MemoryTracker::Total(MemoryKind kind)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals[static_cast<size_t>(kind)];
+}
+
+bool MemoryTracker::ExportCsv(const std::string& path)
+{
+    std::vector<Entry> entries = Snapshot();
+
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        logger.error("Impossible d'ecrire l'export memoire: " + path);
+        return false;
+    }
+
+    out << "owner,kind,domain,bytes\n";
+    for (const auto& e : entries) {
+        // Les chemins peuvent contenir des virgules : champ entre guillemets, guillemets doublés
+        std::string owner;
+        for (char c : e.owner) owner += (c == '"') ? std::string("\"\"") : std::string(1, c);
+        out << '"' << owner << "\"," << KindName(e.kind) << ',' << (IsGpu(e.kind) ? "gpu" : "cpu") << ',' << e.bytes << '\n';
+    }
+    logger.info("Export memoire ecrit: " + path + " (" + std::to_string(entries.size()) + " entrees)");
+    return true;
+}
@@ -1,115 +1,196 @@
 #include "Mesh.h"
+#include "ShaderPermutations.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "ContentHash.h"
+#include "Log.h"
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+static ComponentLogger meshLogger("Model");
+
+// Buffers GPU déjà créés, par empreinte de contenu ; thread GL uniquement
+static std::unordered_map<uint64_t, std::weak_ptr<void>> sharedBuffers;
+static size_t sharedBufferBytes = 0;
+// Taille de sharedBuffers après le dernier balayage des entrées expirées
+static size_t sharedBuffersSwept = 0;
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, float opacity, bool uploadNow)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->opacity = opacity;
 
     // Calculate mesh bounds
-    for (const auto& vertex : vertices) {
+    for (const auto& vertex : this->vertices) {
         minBounds = glm::min(minBounds, vertex.Position);
         maxBounds = glm::max(maxBounds, vertex.Position);
     }
 
+    contentHash = ContentHash::Hash(this->indices.data(), this->indices.size() * sizeof(unsigned int),
+                                    ContentHash::Hash(this->vertices.data(), this->vertices.size() * sizeof(Vertex)));
+
+    resolveMaterial();
+
     // now that we have all the required data, set the vertex buffers and its attribute pointers.
-    setupMesh();
+    if (uploadNow) setupMesh();
 }
 
-// render the mesh
-void Mesh::Draw(Shader &shader) 
+void Mesh::upload()
+{
+    if (!gpu) setupMesh();
+}
+
+void Mesh::release()
+{
+    gpu.reset();
+}
+
+void Mesh::resolveMaterial()
 {
-    // bind appropriate textures
-    bool hasDiffuse = false;
-    bool hasSpecular = false;
-    bool hasNormal = false;
-    bool hasHeight = false;
-    bool hasAmbient = false;
-
-    // Reset texture units
+    diffuseTexture = specularTexture = normalTexture = 0;
+    unsigned int heightTexture = 0;
+    for (const auto& tex : textures) {
+        if (tex.type == "texture_diffuse" && !diffuseTexture) diffuseTexture = tex.id;
+        else if (tex.type == "texture_specular" && !specularTexture) specularTexture = tex.id;
+        else if (tex.type == "texture_normal" && !normalTexture) normalTexture = tex.id;
+        else if (tex.type == "texture_height" && !heightTexture) heightTexture = tex.id;
+    }
+    // Les .obj exportent leur normal map en map_Bump, qu'Assimp range dans HEIGHT
+    if (!normalTexture) normalTexture = heightTexture;
+
+    features = ShaderFeature::None;
+    if (diffuseTexture) features |= ShaderFeature::Diffuse;
+    if (specularTexture) features |= ShaderFeature::Specular;
+    if (normalTexture) features |= ShaderFeature::NormalMap;
+    if (opacity < 1.0f) features |= ShaderFeature::Alpha;
+}
+
+void Mesh::bindMaterial(Shader &shader)
+{
+    if (features & ShaderFeature::Diffuse) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, diffuseTexture);
+    }
+    if (features & ShaderFeature::Specular) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, specularTexture);
+    }
+    if (features & ShaderFeature::NormalMap) {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, normalTexture);
+    }
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    for(unsigned int i = 0; i < textures.size(); i++)
-    {
-        std::string name = textures[i].type;
-        
-        if (name == "texture_diffuse" && !hasDiffuse) {
-            // Activate texture unit 0 for diffuse
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-            shader.setInt("material.texture_diffuse1", 0);
-            hasDiffuse = true;
-        }
-        else if (name == "texture_specular" && !hasSpecular) {
-            // Activate texture unit 1 for specular
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-            shader.setInt("material.texture_specular1", 1);
-            hasSpecular = true;
-        }
-        else if (name == "texture_normal" && !hasNormal) {
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-            shader.setInt("material.texture_normal1", 2);
-            hasNormal = true;
-        }
-        else if (name == "texture_height" && !hasHeight) {
-            glActiveTexture(GL_TEXTURE3);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-            shader.setInt("material.texture_height1", 3);
-            hasHeight = true;
-        }
-        else if (name == "texture_ambient" && !hasAmbient) {
-            glActiveTexture(GL_TEXTURE4);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-            shader.setInt("material.texture_ambient1", 4);
-            hasAmbient = true;
-        }
+
+    if (features & ShaderFeature::Alpha) {
+        shader.setFloat("material.opacity", opacity);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
-    
-    // Mettre à jour les états des textures dans le shader
-    shader.setBool("material.hasDiffuse", hasDiffuse);
-    shader.setBool("material.hasSpecular", hasSpecular);
-    shader.setBool("material.hasNormal", hasNormal);
-    shader.setBool("material.hasHeight", hasHeight);
-    shader.setBool("material.hasAmbient", hasAmbient);
-
-    // draw mesh
-    glBindVertexArray(VAO);
+}
+
+// render the mesh
+void Mesh::Draw(Shader &shader) 
+{
+    if (!isUploaded()) return;
+    bindMaterial(shader);
+
+    glBindVertexArray(gpu->VAO.get());
     glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 
-    // always good practice to set everything back to defaults once configured.
-    glActiveTexture(GL_TEXTURE0);
+    if (features & ShaderFeature::Alpha) glDisable(GL_BLEND);
+}
+
+void Mesh::DrawInstanced(Shader &shader, GLuint instanceBuffer, GLintptr offset, GLsizei count)
+{
+    if (!isUploaded()) return;
+    bindMaterial(shader);
+
+    glBindVertexArray(gpu->VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const GLsizei stride = sizeof(InstanceTransform);
+    for (unsigned int i = 0; i < 4; ++i) {
+        glEnableVertexAttribArray(5 + i);
+        glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offset + offsetof(InstanceTransform, model) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(5 + i, 1);
+    }
+    for (unsigned int i = 0; i < 3; ++i) {
+        glEnableVertexAttribArray(9 + i);
+        glVertexAttribPointer(9 + i, 3, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offset + offsetof(InstanceTransform, normal) + i * sizeof(glm::vec3)));
+        glVertexAttribDivisor(9 + i, 1);
+    }
+
+    glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, count);
+
+    for (unsigned int i = 5; i < 12; ++i) glDisableVertexAttribArray(i);
+    glBindVertexArray(0);
+
+    if (features & ShaderFeature::Alpha) glDisable(GL_BLEND);
 }
 
 // initializes all the buffer objects/arrays
 void Mesh::setupMesh()
 {
+    PROFILE_ZONE_CAT("Mesh upload", "gpu-upload");
+    const size_t bytes = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int);
+
+    // identical geometry under another file name (or already loaded by another model): reuse its buffers
+    auto known = sharedBuffers.find(contentHash);
+    if (known != sharedBuffers.end()) {
+        auto existing = std::static_pointer_cast<GpuBuffers>(known->second.lock());
+        if (!existing) sharedBuffers.erase(known);
+        else if (existing->vertexCount == vertices.size() && existing->indexCount == indices.size()) {
+            gpu = existing;
+            sharedBufferBytes += bytes;
+            meshLogger.info("Maillage identique partage (" + std::to_string(bytes / 1024) + " Ko evites, total " +
+                            std::to_string(sharedBufferBytes / 1024) + " Ko)");
+            return;
+        }
+    }
+
     // create buffers/arrays
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    gpu = std::make_shared<GpuBuffers>();
+    gpu->vertexCount = vertices.size();
+    gpu->indexCount = indices.size();
+    gpu->VAO = GlVertexArray::Create();
+    gpu->VBO = GlBuffer::Create();
+    gpu->EBO = GlBuffer::Create();
+    sharedBuffers[contentHash] = gpu;
+    // the buffers of unloaded meshes are gone: sweep their entries once the table has doubled,
+    // so it stays proportional to the meshes alive
+    if (sharedBuffers.size() >= 2 * std::max<size_t>(sharedBuffersSwept, 64)) {
+        for (auto it = sharedBuffers.begin(); it != sharedBuffers.end();) {
+            if (it->second.expired()) it = sharedBuffers.erase(it);
+            else ++it;
+        }
+        sharedBuffersSwept = sharedBuffers.size();
+    }
 
-    glBindVertexArray(VAO);
-    // load data into vertex buffers
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindVertexArray(gpu->VAO.get());
+    // allocate the storage only: the contents are copied by the UploadScheduler over the next frames
+    // and the mesh is not drawn until its ticket completes.
     // A great thing about structs is that their memory layout is sequential for all its items.
     // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
     // again translates to 3/2 floats which translates to a byte array.
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+    glBindBuffer(GL_ARRAY_BUFFER, gpu->VBO.get());
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu->EBO.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    gpu->pendingUpload = std::make_shared<UploadScheduler::Ticket>();
+    UploadScheduler::Instance().uploadBuffer(gpu->pendingUpload, gpu->VBO.get(), vertices.data(), vertices.size() * sizeof(Vertex));
+    UploadScheduler::Instance().uploadBuffer(gpu->pendingUpload, gpu->EBO.get(), indices.data(), indices.size() * sizeof(unsigned int));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    // owner comes from the MemoryTracker::OwnerScope opened by the Model being loaded
+    MemoryTracker::TrackBuffer(gpu->VBO.get(), MemoryKind::VertexBuffer, vertices.size() * sizeof(Vertex));
+    MemoryTracker::TrackBuffer(gpu->EBO.get(), MemoryKind::IndexBuffer, indices.size() * sizeof(unsigned int));
 
     // set the vertex attribute pointers
     // vertex Positions
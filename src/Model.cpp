@@ -1,6 +1,12 @@
 #include "Model.h"
 #include "Texture.h"
 #include "Log.h"
+#include "ShaderPermutations.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "GltfLoader.h"
+#include "ObjLoader.h"
+#include "JobSystem.h"
 
 #include <iostream>
 #include <vector>
@@ -22,24 +28,196 @@ static std::mutex textureMutex;
 
 static ComponentLogger modelLogger("Model");
 
-Model::Model(std::string const &path, bool gamma) : gammaCorrection(gamma)
+bool Model::nativeImporters = true;
+
+Model::Model(std::string const &path, bool gamma, bool deferGpuUpload) : sourcePath(path), gammaCorrection(gamma), deferUpload(deferGpuUpload)
 {
+    MemoryTracker::OwnerScope owner(sourcePath);
     loadModel(path);
+
+    size_t cpuBytes = 0;
+    for (const auto &mesh : meshes) {
+        cpuBytes += mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(unsigned int);
+    }
+    MemoryTracker::SetCpu(sourcePath, MemoryKind::CpuMesh, cpuBytes);
 }
 
-void Model::Draw(Shader &shader)
+Model::~Model()
 {
-    // Activer le shader
-    shader.use();
-    
-    // Dessiner tous les maillages
+    // Un modèle vidé par déplacement (rechargement à chaud) ne possède plus ces données
+    if (!meshes.empty()) MemoryTracker::SetCpu(sourcePath, MemoryKind::CpuMesh, 0);
+}
+
+unsigned int Model::loadTextureFile(const std::string &fullPath)
+{
+    if (!deferUpload) {
+        unsigned int id = Texture2D::Load(fullPath);
+        if (id) textureRefs.push_back(Texture2D::Find(fullPath));
+        return id;
+    }
+
+    if (pendingImages.count(fullPath)) return PendingTextureId;
+    Texture2D::Image image = Texture2D::Decode(fullPath);
+    if (!image.valid()) return 0;
+    pendingImages[fullPath] = std::move(image);
+    return PendingTextureId;
+}
+
+unsigned int Model::loadTextureImage(const std::string &key, Texture2D::Image &&image)
+{
+    if (!deferUpload) {
+        unsigned int id = 0;
+        if (auto existing = Texture2D::Find(key)) id = existing->get();
+        else if (image.valid()) id = Texture2D::Store(key, image);
+        if (id) textureRefs.push_back(Texture2D::Find(key));
+        return id;
+    }
+
+    if (pendingImages.count(key)) return PendingTextureId;
+    if (!image.valid()) return 0;
+    pendingImages[key] = std::move(image);
+    return PendingTextureId;
+}
+
+void Model::uploadToGpu(bool shareTextures)
+{
+    MemoryTracker::OwnerScope owner(sourcePath);
+    std::map<std::string, unsigned int> ids;
+    for (const auto &pending : pendingImages) {
+        std::shared_ptr<GlTexture> texture;
+        if (shareTextures) {
+            if (Texture2D::Store(pending.first, pending.second)) texture = Texture2D::Find(pending.first);
+        } else {
+            // a texture already cached is reused as is, without replacing its content
+            texture = Texture2D::Find(pending.first);
+            if (!texture) texture = Texture2D::CreateUncached(pending.second, sourcePath);
+        }
+        ids[pending.first] = texture ? texture->get() : 0;
+        if (texture) textureRefs.push_back(std::move(texture));
+    }
+    pendingImages.clear();
+
+    auto patch = [&ids](Texture &tex) {
+        if (tex.id != PendingTextureId) return;
+        auto it = ids.find(tex.path);
+        tex.id = it != ids.end() ? it->second : 0;
+    };
+    for (auto &tex : textures_loaded) patch(tex);
+    for (auto &mesh : meshes) {
+        for (auto &tex : mesh.textures) patch(tex);
+        mesh.resolveMaterial();
+        mesh.upload();
+    }
+    deferUpload = false;
+    modelLogger.debug("Modele envoye au GPU: " + std::to_string(meshes.size()) + " maillages, " + std::to_string(ids.size()) + " textures");
+}
+
+void Model::releaseGpu()
+{
+    for (auto &mesh : meshes) mesh.release();
+    textureRefs.clear();
+}
+
+void Model::retargetTexture(const std::string &path, unsigned int id)
+{
+    bool used = false;
+    for (auto &tex : textures_loaded) {
+        if (tex.path == path) tex.id = id;
+    }
+    for (auto &mesh : meshes) {
+        bool changed = false;
+        for (auto &tex : mesh.textures) {
+            if (tex.path == path && tex.id != id && tex.id != PendingTextureId) {
+                tex.id = id;
+                changed = true;
+            }
+        }
+        if (changed) {
+            mesh.resolveMaterial();
+            used = true;
+        }
+    }
+    // the previous texture stays referenced: other meshes may still use it through another path
+    if (used) textureRefs.push_back(Texture2D::Find(path));
+}
+
+void Model::Draw(ShaderPermutations &shaders, unsigned int drawFeatures, const glm::mat4 &model)
+{
+    if (!nodes.empty()) {
+        for (const auto &node : nodes) DrawMesh(node.mesh, shaders, drawFeatures, model * node.transform);
+        return;
+    }
+
+    // Matrice normale calculée une fois par instance plutôt qu'à chaque sommet
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+
     for(unsigned int i = 0; i < meshes.size(); i++) {
+        Shader &shader = shaders.get(meshes[i].features | drawFeatures);
+        shader.setMat4("model", model);
+        shader.setMat3("normalMatrix", normalMatrix);
         meshes[i].Draw(shader);
     }
 }
 
+glm::vec3 Model::getModelSize() const
+{
+    if (meshes.empty()) return glm::vec3(1.0f);
+
+    glm::vec3 minBounds, maxBounds;
+    getBounds(minBounds, maxBounds);
+    return maxBounds - minBounds;
+}
+
+void Model::getBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const
+{
+    minBounds = glm::vec3(FLT_MAX);
+    maxBounds = glm::vec3(-FLT_MAX);
+    if (nodes.empty()) {
+        for (const auto& mesh : meshes) {
+            minBounds = glm::min(minBounds, mesh.minBounds);
+            maxBounds = glm::max(maxBounds, mesh.maxBounds);
+        }
+    } else {
+        // Boîte englobante des huit coins de chaque maillage placé par son nœud
+        for (const auto& node : nodes) {
+            const Mesh &mesh = meshes[node.mesh];
+            for (int corner = 0; corner < 8; ++corner) {
+                glm::vec3 p((corner & 1) ? mesh.maxBounds.x : mesh.minBounds.x,
+                            (corner & 2) ? mesh.maxBounds.y : mesh.minBounds.y,
+                            (corner & 4) ? mesh.maxBounds.z : mesh.minBounds.z);
+                p = glm::vec3(node.transform * glm::vec4(p, 1.0f));
+                minBounds = glm::min(minBounds, p);
+                maxBounds = glm::max(maxBounds, p);
+            }
+        }
+    }
+}
+
+void Model::DrawMesh(unsigned int index, ShaderPermutations &shaders, unsigned int drawFeatures, const glm::mat4 &model)
+{
+    Shader &shader = shaders.get(meshes[index].features | drawFeatures);
+    shader.setMat4("model", model);
+    shader.setMat3("normalMatrix", glm::mat3(glm::transpose(glm::inverse(model))));
+    meshes[index].Draw(shader);
+}
+
+void Model::DrawMeshInstanced(unsigned int index, ShaderPermutations &shaders, unsigned int drawFeatures, GLuint instanceBuffer, GLintptr offset, GLsizei count)
+{
+    Shader &shader = shaders.get(meshes[index].features | drawFeatures | ShaderFeature::Instancing);
+    meshes[index].DrawInstanced(shader, instanceBuffer, offset, count);
+}
+
+void Model::DrawInstanced(ShaderPermutations &shaders, unsigned int drawFeatures, GLuint instanceBuffer, GLintptr offset, GLsizei count)
+{
+    for(unsigned int i = 0; i < meshes.size(); i++) {
+        Shader &shader = shaders.get(meshes[i].features | drawFeatures | ShaderFeature::Instancing);
+        meshes[i].DrawInstanced(shader, instanceBuffer, offset, count);
+    }
+}
+
 void Model::loadModel(std::string const &path)
 {
+    PROFILE_ZONE_CAT("Model import", "import");
     modelLogger.info(std::string("Chargement du modele: ") + path);
     
     // Vérifier si le fichier existe
@@ -54,6 +232,14 @@ void Model::loadModel(std::string const &path)
         return;
     }
     file.close();
+
+    if (nativeImporters && GltfLoader::IsGltf(path)) {
+        if (loadGltf(path)) return;
+        modelLogger.info(std::string("Lecteur glTF en echec, repli sur Assimp: ") + path);
+    } else if (nativeImporters && ObjLoader::IsObj(path)) {
+        if (loadObj(path)) return;
+        modelLogger.info(std::string("Lecteur OBJ en echec, repli sur Assimp: ") + path);
+    }
     
     // read file via ASSIMP
     Assimp::Importer importer;
@@ -177,34 +363,91 @@ void Model::loadModel(std::string const &path)
         modelLogger.error("Le repertoire n'existe pas ou n'est pas accessible");
     }
 
-    // process ASSIMP's root node recursively
-    processNode(scene->mRootNode, scene);
+    // process ASSIMP's root node recursively, collecting the unique meshes in traversal order
+    std::vector<aiMesh*> work;
+    std::map<unsigned int, unsigned int> meshSlots;
+    processNode(scene->mRootNode, scene, glm::mat4(1.0f), work, meshSlots);
+    const size_t firstMesh = meshes.size();
+    processMeshes(work, scene);
+
+    // Les nœuds ne servent que si un maillage est répété ou déplacé : sinon chemin sans nœuds
+    bool needNodes = nodes.size() != work.size();
+    for (const auto &node : nodes) needNodes |= node.transform != glm::mat4(1.0f);
+    if (!needNodes) {
+        nodes.clear();
+        return;
+    }
+    for (auto &node : nodes) node.mesh += static_cast<unsigned int>(firstMesh);
+    std::stable_sort(nodes.begin(), nodes.end(), [](const MeshNode &a, const MeshNode &b) { return a.mesh < b.mesh; });
+    modelLogger.debug("Hierarchie conservee: " + std::to_string(work.size()) + " maillages uniques, " +
+                      std::to_string(nodes.size()) + " instances de noeuds");
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene)
+void Model::processNode(aiNode *node, const aiScene *scene, const glm::mat4 &parent, std::vector<aiMesh*> &work,
+                        std::map<unsigned int, unsigned int> &meshSlots)
 {
-    // process each mesh located at the current node
+    // aiMatrix4x4 est rangée par lignes, glm par colonnes
+    const glm::mat4 world = parent * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+
+    // each mesh located at the current node is converted once, the node only records where it goes
     for(unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         // the node object only contains indices to index the actual objects in the scene. 
         // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        auto slot = meshSlots.find(node->mMeshes[i]);
+        if (slot == meshSlots.end()) {
+            slot = meshSlots.emplace(node->mMeshes[i], static_cast<unsigned int>(work.size())).first;
+            work.push_back(scene->mMeshes[node->mMeshes[i]]);
+        }
+        nodes.push_back(MeshNode{slot->second, world});
     }
     
     // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
     for(unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, world, work, meshSlots);
     }
 }
 
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+void Model::processMeshes(const std::vector<aiMesh*> &work, const aiScene *scene)
 {
-    // data to fill
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+    PROFILE_ZONE_CAT("Mesh conversion", "import");
+
+    // Matériaux sur ce thread, une fois par matériau : textures_loaded et les chargements
+    // immédiats de textures (contexte GL) ne se partagent pas entre threads
+    struct MaterialData {
+        std::vector<Texture> textures;
+        float opacity = 1.0f;
+    };
+    std::map<unsigned int, MaterialData> materials;
+    for (const aiMesh *mesh : work) {
+        if (materials.count(mesh->mMaterialIndex)) continue;
+        MaterialData &data = materials[mesh->mMaterialIndex];
+        aiMaterial* material = mesh->mMaterialIndex < scene->mNumMaterials ? scene->mMaterials[mesh->mMaterialIndex] : nullptr;
+        processMaterial(material, data.textures, data.opacity);
+    }
+
+    // Géométrie convertie en parallèle, chaque résultat rangé à l'indice de son maillage
+    std::vector<std::vector<Vertex>> vertices(work.size());
+    std::vector<std::vector<unsigned int>> indices(work.size());
+    JobSystem::Instance().parallelFor(work.size(), [&](size_t i) {
+        convertGeometry(work[i], vertices[i], indices[i]);
+    });
+
+    // Objets Mesh (et buffers GL en mode immédiat) créés ici, dans l'ordre du parcours
+    meshes.reserve(meshes.size() + work.size());
+    for (size_t i = 0; i < work.size(); ++i) {
+        const MaterialData &data = materials[work[i]->mMaterialIndex];
+        meshes.emplace_back(std::move(vertices[i]), std::move(indices[i]), data.textures, data.opacity, !deferUpload);
+    }
+    this->textures_loaded_flag = true;
+    modelLogger.debug("Maillages convertis: " + std::to_string(work.size()) + ", materiaux: " + std::to_string(materials.size()));
+}
+
+void Model::convertGeometry(const aiMesh *mesh, std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+{
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(mesh->mNumFaces * 3);
 
     // walk through each of the mesh's vertices
     for(unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -263,13 +506,10 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
         for(unsigned int j = 0; j < face.mNumIndices; j++)
             indices.push_back(face.mIndices[j]);
     }
-    
-    // process materials: use the mesh's material index directly
-    aiMaterial* material = nullptr;
-    if (mesh->mMaterialIndex >= 0 && mesh->mMaterialIndex < scene->mNumMaterials) {
-        material = scene->mMaterials[mesh->mMaterialIndex];
-    }
-    
+}
+
+void Model::processMaterial(aiMaterial *material, std::vector<Texture> &textures, float &opacity)
+{
     if (material) {
         // Afficher les informations sur le matériau
         aiString matName;
@@ -323,6 +563,8 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
             loadAndAddTextures(aiTextureType_AMBIENT, "texture_ambient");
         }
         
+        material->Get(AI_MATKEY_OPACITY, opacity);
+
         // Afficher la couleur diffuse du matériau
         aiColor3D diffuseColor(0.6f, 0.6f, 0.6f); // Couleur par défaut
         if (AI_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColor)) {
@@ -340,7 +582,7 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
             std::string diffusePath = directory + "/diffuse.jpg";
             if (std::ifstream(diffusePath)) {
                 Texture diffuseTex;
-                diffuseTex.id = Texture2D::Load(diffusePath);
+                diffuseTex.id = loadTextureFile(diffusePath);
                 diffuseTex.type = "texture_diffuse";
                 diffuseTex.path = diffusePath;
                 textures.push_back(diffuseTex);
@@ -351,7 +593,7 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
             std::string specularPath = directory + "/specular.jpg";
             if (std::ifstream(specularPath)) {
                 Texture specularTex;
-                specularTex.id = Texture2D::Load(specularPath);
+                specularTex.id = loadTextureFile(specularPath);
                 specularTex.type = "texture_specular";
                 specularTex.path = specularPath;
                 textures.push_back(specularTex);
@@ -381,7 +623,7 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
                 if (file.good()) {
                     file.close();
                     modelLogger.debug(std::string("Fichier de texture trouve: ") + fullPath);
-                    unsigned int textureID = Texture2D::Load(fullPath);
+                    unsigned int textureID = loadTextureFile(fullPath);
                     if (textureID > 0) {
                         Texture texture;
                         texture.id = textureID;
@@ -398,9 +640,6 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
         }
     }
 
-    // return a mesh object created from the extracted mesh data
-    this->textures_loaded_flag = true;
-    return Mesh(vertices, indices, textures);
 }
 
 // Variable statique pour suivre les textures déjà chargées
@@ -456,7 +695,7 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType
                         file.close();
                         modelLogger.info(std::string("LOAD ") + typeName + ": " + fullPath);
                         
-                        unsigned int textureID = Texture2D::Load(fullPath);
+                        unsigned int textureID = loadTextureFile(fullPath);
                         
                         if (textureID > 0) {
                             Texture texture;
@@ -518,7 +757,7 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType
                 file.close();
                 modelLogger.info(std::string("LOAD default ") + typeName + ": " + fullPath);
                 
-                unsigned int textureID = Texture2D::Load(fullPath);
+                unsigned int textureID = loadTextureFile(fullPath);
                 
                 if (textureID > 0) {
                     Texture texture;
@@ -541,3 +780,91 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType
     modelLogger.debug(std::string("Repertoire de recherche: ") + directory);
     return textures;
 }
+
+bool Model::loadGltf(std::string const &path)
+{
+    GltfLoader::Scene scene;
+    if (!GltfLoader::Load(path, scene)) return false;
+
+    size_t lastSlash = path.find_last_of("/\\");
+    directory = lastSlash != std::string::npos ? path.substr(0, lastSlash) : ".";
+
+    // Une texture par image référencée, partagée par les primitives qui l'utilisent
+    std::vector<Texture> imageTextures(scene.images.size());
+    std::vector<bool> imageLoaded(scene.images.size(), false);
+    auto imageTexture = [&](int index, const std::string &type) {
+        Texture texture{0, type, ""};
+        if (index < 0 || static_cast<size_t>(index) >= scene.images.size()) return texture;
+        GltfLoader::ImageSource &source = scene.images[index];
+        if (!imageLoaded[index]) {
+            imageLoaded[index] = true;
+            imageTextures[index].path = source.key;
+            imageTextures[index].id = source.embedded.valid() ? loadTextureImage(source.key, std::move(source.embedded))
+                                                              : loadTextureFile(source.key);
+            if (imageTextures[index].id) {
+                textures_loaded.push_back(Texture{imageTextures[index].id, type, source.key});
+            } else {
+                modelLogger.error(std::string("Echec du chargement texture: ") + source.key);
+            }
+        }
+        texture.id = imageTextures[index].id;
+        texture.path = imageTextures[index].path;
+        return texture;
+    };
+
+    meshes.reserve(scene.primitives.size());
+    for (auto &primitive : scene.primitives) {
+        std::vector<Texture> textures;
+        for (const auto &ref : primitive.textures) {
+            Texture texture = imageTexture(ref.second, ref.first);
+            if (texture.id) textures.push_back(texture);
+        }
+        meshes.emplace_back(std::move(primitive.vertices), std::move(primitive.indices), std::move(textures),
+                            primitive.opacity, !deferUpload);
+    }
+
+    nodes.reserve(scene.nodes.size());
+    for (const auto &node : scene.nodes) nodes.push_back(MeshNode{node.primitive, node.transform});
+    std::stable_sort(nodes.begin(), nodes.end(), [](const MeshNode &a, const MeshNode &b) { return a.mesh < b.mesh; });
+    this->textures_loaded_flag = true;
+    return true;
+}
+
+bool Model::loadObj(std::string const &path)
+{
+    ObjLoader::Scene scene;
+    if (!ObjLoader::Load(path, scene)) return false;
+
+    size_t lastSlash = path.find_last_of("/\\");
+    directory = lastSlash != std::string::npos ? path.substr(0, lastSlash) : ".";
+
+    auto loadTexture = [this](const std::string &type, const std::string &fullPath) {
+        for (const auto &loadedTex : textures_loaded) {
+            if (loadedTex.path == fullPath) return Texture{loadedTex.id, type, fullPath};
+        }
+        Texture texture{loadTextureFile(fullPath), type, fullPath};
+        if (texture.id) {
+            textures_loaded.push_back(texture);
+        } else {
+            modelLogger.error(std::string("Echec du chargement texture: ") + fullPath);
+        }
+        return texture;
+    };
+
+    meshes.reserve(scene.groups.size());
+    for (auto &group : scene.groups) {
+        std::vector<Texture> textures;
+        float opacity = 1.0f;
+        if (group.material >= 0) {
+            const ObjLoader::Material &material = scene.materials[group.material];
+            opacity = material.opacity;
+            for (const auto &ref : material.textures) {
+                Texture texture = loadTexture(ref.first, ref.second);
+                if (texture.id) textures.push_back(texture);
+            }
+        }
+        meshes.emplace_back(std::move(group.vertices), std::move(group.indices), std::move(textures), opacity, !deferUpload);
+    }
+    this->textures_loaded_flag = true;
+    return true;
+}
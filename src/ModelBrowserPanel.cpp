@@ -1,67 +1,100 @@
 #include "ModelBrowserPanel.h"
 #include "ModelManager.h"
+#include "ThumbnailRenderer.h"
 
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
-#include <filesystem>
-#include <algorithm>
 
-namespace fs = std::filesystem;
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 
-ModelBrowserPanel::ModelBrowserPanel(ModelManager* mgr, const std::string& rootDir)
-    : manager(mgr), root(rootDir)
+ModelBrowserPanel::ModelBrowserPanel(ModelManager* mgr, AssetDatabase* assetDb)
+    : manager(mgr), assets(assetDb)
 {
-    scanFiles();
 }
 
-void ModelBrowserPanel::scanFiles()
+void ModelBrowserPanel::refreshMatches()
 {
-    files.clear();
-    std::error_code ec;
-    if (!fs::exists(root, ec)) return;
-    for (auto& p : fs::recursive_directory_iterator(root, ec)) {
-        if (p.is_regular_file()) {
-            auto ext = p.path().extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-            if (ext == ".obj" || ext == ".fbx" || ext == ".dae" || ext == ".gltf" || ext == ".glb") {
-                files.push_back(p.path().string());
-            }
-        }
-    }
-    std::sort(files.begin(), files.end());
+    if (!assets) return;
+    if (listing && listingVersion == assets->version() && listedFilter == filter) return;
+    listing = assets->index();
+    listingVersion = assets->version();
+    listedFilter = filter;
+    matches = listing->search(filter);
 }
 
-bool ModelBrowserPanel::exists(const std::string& path) const
+void ModelBrowserPanel::drawCell(const AssetDatabase::Entry& entry, float cellSize)
 {
-    std::error_code ec; return fs::exists(path, ec);
+    ImGui::PushID(entry.path.c_str());
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float textHeight = ImGui::GetTextLineHeight();
+    if (ImGui::Selectable("##cell", entry.path == selected, 0, ImVec2(cellSize, cellSize + textHeight))) selected = entry.path;
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", entry.path.c_str());
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 imageMax(origin.x + cellSize, origin.y + cellSize);
+    const GLuint texture = thumbnails ? thumbnails->modelThumbnail(entry.path) : 0;
+    if (texture) {
+        drawList->AddImage((ImTextureID)(intptr_t)texture, origin, imageMax, ImVec2(0, 1), ImVec2(1, 0));
+    } else {
+        drawList->AddRect(origin, imageMax, ImGui::GetColorU32(ImGuiCol_Text, 0.2f));
+    }
+
+    const std::string name = std::filesystem::path(entry.path).filename().string();
+    const ImVec2 textMin(origin.x, imageMax.y);
+    drawList->PushClipRect(textMin, ImVec2(imageMax.x, imageMax.y + textHeight), true);
+    drawList->AddText(textMin, ImGui::GetColorU32(ImGuiCol_Text), name.c_str());
+    drawList->PopClipRect();
+    ImGui::PopID();
 }
 
 void ModelBrowserPanel::draw(bool* open)
 {
     if (!open || !(*open)) return;
     if (ImGui::Begin("Models", open)) {
-        if (ImGui::Button("Rescan")) { scanFiles(); }
+        if (ImGui::Button("Rescan") && assets) { assets->rescan(); }
         ImGui::SameLine();
         ImGui::InputText("Filter", &filter);
+        refreshMatches();
 
         ImGui::Separator();
         ImGui::BeginChild("files", ImVec2(0, 300), true);
-        int idx = 0;
-        for (auto& f : files) {
-            if (!filter.empty()) {
-                std::string lowf = f; std::transform(lowf.begin(), lowf.end(), lowf.begin(), ::tolower);
-                std::string lowq = filter; std::transform(lowq.begin(), lowq.end(), lowq.begin(), ::tolower);
-                if (lowf.find(lowq) == std::string::npos) { idx++; continue; }
+        if (listing) {
+            // Grille de vignettes : seules les rangées visibles sont soumises à ImGui (et demandent leurs vignettes)
+            const float cellSize = static_cast<float>(ThumbnailRenderer::Size) * 0.75f;
+            const ImGuiStyle& style = ImGui::GetStyle();
+            const float cellWidth = cellSize + style.ItemSpacing.x;
+            const int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + style.ItemSpacing.x) / cellWidth));
+            const int rows = static_cast<int>((matches.size() + columns - 1) / columns);
+            const float rowHeight = cellSize + ImGui::GetTextLineHeightWithSpacing();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(rows, rowHeight);
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    for (int column = 0; column < columns; ++column) {
+                        const size_t index = static_cast<size_t>(row) * columns + column;
+                        if (index >= matches.size()) break;
+                        if (column > 0) ImGui::SameLine();
+                        drawCell(listing->entries()[matches[index]], cellSize);
+                    }
+                }
             }
-            bool sel = (idx == selected);
-            if (ImGui::Selectable(f.c_str(), sel)) selected = idx;
-            idx++;
+            clipper.End();
         }
         ImGui::EndChild();
 
-        bool canLoad = (selected >= 0 && selected < (int)files.size());
-        if (ImGui::Button("OK") && canLoad) {
-            if (manager) manager->beginPlacement(files[selected]);
+        if (assets && assets->isIndexing()) ImGui::TextDisabled("Indexing...");
+        else if (listing) ImGui::TextDisabled("%zu / %zu files", matches.size(), listing->entries().size());
+        const AssetDatabase::Entry* entry = listing && !selected.empty() ? listing->find(selected) : nullptr;
+        if (entry) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("| %.1f KB", static_cast<double>(entry->bytes) / 1024.0);
+        }
+
+        if (ImGui::Button("OK") && entry) {
+            if (manager) manager->beginPlacement(entry->path);
         }
     }
     ImGui::End();
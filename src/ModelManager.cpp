@@ -1,13 +1,192 @@
 #include "ModelManager.h"
+#include "FileWatcher.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "TextureResidency.h"
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 ComponentLogger ModelManager::logger("Model");
+size_t ModelManager::historyBudget = 64u * 1024u * 1024u;
+
+namespace {
+// Transforms par frame : de quoi dessiner ~40k instances avant de retomber sur des appels unitaires
+const size_t kInstanceStreamBytes = 4u * 1024u * 1024u;
+
+glm::mat4 entryMatrix(const ModelManager::Entry &e)
+{
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, e.position);
+    model = glm::rotate(model, glm::radians(e.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(e.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(e.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::scale(model, e.scale == glm::vec3(0.0f) ? glm::vec3(1.0f) : e.scale);
+    return model;
+}
+}
 
 ModelManager::ModelManager() {}
-ModelManager::~ModelManager() {}
+
+ModelManager::~ModelManager()
+{
+    // Un préchargement ou un rechargement encore en file ou en cours ne touche plus au gestionnaire
+    ++*prefetchGeneration;
+    *alive = false;
+}
+
+std::shared_ptr<Model> ModelManager::acquireModel(const std::string &path)
+{
+    auto it = assets.find(path);
+    if (it != assets.end()) {
+        if (auto existing = it->second.lock()) {
+            logger.debug(std::string("Modele deja en memoire: ") + path);
+            return existing;
+        }
+    }
+    auto model = takeWarm(path);
+    if (model) model->uploadToGpu();
+    else model = std::make_shared<Model>(path);
+    assets[path] = model;
+    return model;
+}
+
+std::shared_ptr<Model> ModelManager::takeWarm(const std::string &path)
+{
+    auto it = warmAssets.find(path);
+    if (it == warmAssets.end()) return nullptr;
+    auto model = std::move(it->second);
+    warmAssets.erase(it);
+    return model;
+}
+
+void ModelManager::prefetchAssets(const std::vector<std::string>& paths)
+{
+    if (paths == prefetchPaths) return;
+    prefetchPaths = paths;
+    const uint64_t generation = ++*prefetchGeneration;
+
+    const std::set<std::string> wanted(paths.begin(), paths.end());
+    for (auto it = warmAssets.begin(); it != warmAssets.end();) {
+        it = wanted.count(it->first) ? std::next(it) : warmAssets.erase(it);
+    }
+    std::vector<std::string> todo;
+    for (const auto &path : wanted) {
+        auto it = assets.find(path);
+        if (warmAssets.count(path) || (it != assets.end() && !it->second.expired())) continue;
+        todo.push_back(path);
+    }
+    if (todo.empty()) return;
+
+    // Une seule tâche de basse priorité, assets importés l'un après l'autre sans parallelFor : le
+    // préchargement n'occupe qu'un thread, quand le pool n'a rien d'autre à faire, et s'arrête
+    // entre deux assets dès qu'une autre map est demandée. Le compteur partagé survit au
+    // gestionnaire : this n'est lu qu'après l'avoir vérifié.
+    JobSystem::Instance().submitBackground([this, current = prefetchGeneration, generation, todo]() {
+        for (const auto &path : todo) {
+            if (*current != generation) return;
+            std::shared_ptr<Model> model;
+            try {
+                model = std::make_shared<Model>(path, false, true);
+            } catch (const std::exception &ex) {
+                logger.error("Echec prechargement: " + path + " (" + ex.what() + ")");
+                continue;
+            }
+            JobSystem::Instance().runOnMainThread([this, current, generation, path, model]() {
+                if (*current != generation || model->meshes.empty()) return;
+                auto it = assets.find(path);
+                if (it != assets.end() && !it->second.expired()) return;
+                warmAssets[path] = model;
+            });
+        }
+    });
+}
+
+bool ModelManager::sceneBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const
+{
+    minBounds = glm::vec3(FLT_MAX);
+    maxBounds = glm::vec3(-FLT_MAX);
+    bool any = false;
+    for (size_t i = 0; i < models.size(); ++i) {
+        const Entry &e = models[i];
+        if (!e.model || e.model->meshes.empty()) continue;
+        glm::vec3 lo, hi;
+        e.model->getBounds(lo, hi);
+        const glm::mat4 matrix = entryMatrix(e);
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 p((corner & 1) ? hi.x : lo.x, (corner & 2) ? hi.y : lo.y, (corner & 4) ? hi.z : lo.z);
+            p = glm::vec3(matrix * glm::vec4(p, 1.0f));
+            minBounds = glm::min(minBounds, p);
+            maxBounds = glm::max(maxBounds, p);
+        }
+        any = true;
+    }
+    return any;
+}
+
+std::vector<std::string> ModelManager::loadedAssets() const
+{
+    std::vector<std::string> paths;
+    for (const auto &asset : assets) {
+        if (!asset.second.expired()) paths.push_back(asset.first);
+    }
+    return paths;
+}
+
+void ModelManager::retargetTexture(const std::string &path, unsigned int id)
+{
+    for (const auto &asset : assets) {
+        if (auto model = asset.second.lock()) model->retargetTexture(path, id);
+    }
+}
+
+void ModelManager::reloadAsset(const std::string &path)
+{
+    for (const auto &asset : assets) {
+        auto model = asset.second.lock();
+        if (!model || !FileWatcher::SamePath(asset.first, path)) continue;
+
+        if (reloadsInFlight.count(asset.first)) {
+            reloadsRequeued.insert(asset.first);
+            continue;
+        }
+        startReload(asset.first, model);
+    }
+}
+
+void ModelManager::startReload(const std::string &key, const std::shared_ptr<Model> &model)
+{
+    logger.info("Rechargement en arriere-plan: " + key);
+    reloadsInFlight.insert(key);
+
+    std::weak_ptr<Model> target = model;
+    JobSystem::Instance().submit([this, token = alive, key, target]() {
+        if (!*token) return;
+        // Import Assimp et décodage des textures hors du thread de rendu
+        auto fresh = std::make_shared<Model>(key, false, true);
+
+        JobSystem::Instance().runOnMainThread([this, token, key, target, fresh]() {
+            if (!*token) return;
+            reloadsInFlight.erase(key);
+            auto existing = target.lock();
+            if (existing) {
+                if (fresh->meshes.empty()) {
+                    logger.error("Rechargement ignore, import vide: " + key);
+                } else {
+                    fresh->uploadToGpu();
+                    existing->releaseGpu();
+                    *existing = std::move(*fresh);
+                    logger.info("Modele recharge: " + key);
+                }
+            }
+            if (reloadsRequeued.erase(key) && existing) startReload(key, existing);
+        });
+    });
+}
 
 void ModelManager::addModel(const std::string &path)
 {
@@ -28,47 +207,53 @@ void ModelManager::addModelInstance(const ModelInstanceData& data)
     try {
         logger.info(std::string("Ajout du modèle: ") + data.path);
         Entry e;
-        e.model = std::make_unique<Model>(data.path);
-        e.position = data.position;
-        e.rotation = data.rotation;
-        e.path = data.path;
+        makeEntry(data, e);
+        pushHistory();
+        models.push_back(std::move(e));
+        count++;
+        notifyEdit(InstanceEdit::Kind::Add, models.size() - 1);
+    } catch (const std::exception &ex) {
+        logger.error(std::string("Echec ajout modèle: ") + ex.what());
+    }
+}
+
+void ModelManager::makeEntry(const ModelInstanceData& data, Entry& e)
+{
+    e.model = acquireModel(data.path);
+    e.position = data.position;
+    e.rotation = data.rotation;
+    e.path = data.path;
+    
+    // Calculer l'échelle automatique si nécessaire
+    if (data.autoScale) {
+        // Obtenir la taille du modèle
+        glm::vec3 modelSize = e.model->getModelSize();
         
-        // Calculer l'échelle automatique si nécessaire
-        if (data.autoScale) {
-            // Obtenir la taille du modèle
-            glm::vec3 modelSize = e.model->getModelSize();
+        // Éviter la division par zéro
+        if (modelSize.x > 0.0f && modelSize.y > 0.0f && modelSize.z > 0.0f) {
+            // Calculer l'échelle pour normaliser la plus grande dimension à 1.0
+            float maxDim = std::max({modelSize.x, modelSize.y, modelSize.z});
+            float scaleFactor = 1.0f / maxDim;
             
-            // Éviter la division par zéro
-            if (modelSize.x > 0.0f && modelSize.y > 0.0f && modelSize.z > 0.0f) {
-                // Calculer l'échelle pour normaliser la plus grande dimension à 1.0
-                float maxDim = std::max({modelSize.x, modelSize.y, modelSize.z});
-                float scaleFactor = 1.0f / maxDim;
-                
-                // Appliquer l'échelle de base du modèle
-                e.scale = glm::vec3(scaleFactor) * data.scale;
-                
-                std::stringstream ss;
-                ss << "Mise à l'échelle automatique du modèle: "
-                   << "taille=" << modelSize.x << "x" << modelSize.y << "x" << modelSize.z
-                   << ", facteur d'échelle=" << scaleFactor;
-                logger.info(ss.str());
-            } else {
-                e.scale = glm::vec3(1.0f);
-                logger.info("Impossible de calculer l'échelle automatique, utilisation de l'échelle par défaut");
-            }
+            // Appliquer l'échelle de base du modèle
+            e.scale = glm::vec3(scaleFactor) * data.scale;
+            
+            std::stringstream ss;
+            ss << "Mise à l'échelle automatique du modèle: "
+               << "taille=" << modelSize.x << "x" << modelSize.y << "x" << modelSize.z
+               << ", facteur d'échelle=" << scaleFactor;
+            logger.info(ss.str());
         } else {
-            e.scale = data.scale;
-        }
-        
-        // Éviter une échelle nulle
-        if (e.scale == glm::vec3(0.0f)) {
             e.scale = glm::vec3(1.0f);
+            logger.info("Impossible de calculer l'échelle automatique, utilisation de l'échelle par défaut");
         }
-        
-        models.emplace_back(std::move(e));
-        count++;
-    } catch (const std::exception &ex) {
-        logger.error(std::string("Echec ajout modèle: ") + ex.what());
+    } else {
+        e.scale = data.scale;
+    }
+    
+    // Éviter une échelle nulle
+    if (e.scale == glm::vec3(0.0f)) {
+        e.scale = glm::vec3(1.0f);
     }
 }
 
@@ -77,21 +262,125 @@ void ModelManager::clear()
     models.clear();
     preview.reset();
     count = 0;
+    clearHistory();
+}
+
+void ModelManager::setViewer(const glm::vec3 &eye, float verticalFov, float viewportHeight)
+{
+    viewerPosition = eye;
+    pixelsPerUnit = viewportHeight / (2.0f * std::tan(verticalFov * 0.5f));
+}
+
+float ModelManager::projectedSize(const Entry &e, float radius) const
+{
+    const glm::vec3 scale = e.scale == glm::vec3(0.0f) ? glm::vec3(1.0f) : glm::abs(e.scale);
+    const float scaledRadius = radius * std::max(scale.x, std::max(scale.y, scale.z));
+    const float distance = std::max(glm::length(e.position - viewerPosition), scaledRadius);
+    if (distance <= 0.0f) return 0.0f;
+    return 2.0f * scaledRadius * pixelsPerUnit / distance;
 }
 
-void ModelManager::drawAll(Shader &shader, bool highlight, const glm::vec3& highlightColor)
+void ModelManager::touchTextures(const Model &model, float screenPixels) const
 {
-    for (auto &e : models) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, e.position);
-        model = glm::rotate(model, glm::radians(e.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(e.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(e.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, e.scale == glm::vec3(0.0f) ? glm::vec3(1.0f) : e.scale);
-        shader.setBool("highlightActive", highlight);
-        shader.setVec3("highlightColor", highlightColor);
-        shader.setMat4("model", model);
-        e.model->Draw(shader);
+    for (const auto &tex : model.textures_loaded) TextureResidency::Touch(tex.id, screenPixels);
+}
+
+void ModelManager::drawAll(ShaderPermutations &shaders, bool highlight)
+{
+    const unsigned int drawFeatures = highlight ? ShaderFeature::Highlight : ShaderFeature::None;
+
+    // Trier les instances par modèle pour regrouper celles qui partagent la même géométrie
+    {
+        PROFILE_ZONE("Batching");
+        drawOrder.resize(models.size());
+        for (size_t i = 0; i < models.size(); ++i) drawOrder[i] = i;
+        std::sort(drawOrder.begin(), drawOrder.end(), [this](size_t a, size_t b) {
+            return models[a].model.get() < models[b].model.get();
+        });
+    }
+
+    size_t begin = 0;
+    while (begin < drawOrder.size()) {
+        Model *model = models[drawOrder[begin]].model.get();
+        size_t end = begin + 1;
+        while (end < drawOrder.size() && models[drawOrder[end]].model.get() == model) ++end;
+        const size_t count = end - begin;
+
+        const float radius = 0.5f * glm::length(model->getModelSize());
+        float screenPixels = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            screenPixels = std::max(screenPixels, projectedSize(models[drawOrder[i]], radius));
+        }
+        touchTextures(*model, screenPixels);
+
+        bool drawn = false;
+        if (!model->nodes.empty()) {
+            drawNodes(*model, begin, end, shaders, drawFeatures);
+            drawn = true;
+        } else if (count > 1) {
+            if (!instanceStream) {
+                instanceStream = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, kInstanceStreamBytes);
+            }
+            GLintptr offset = 0;
+            auto *dst = static_cast<InstanceTransform*>(
+                instanceStream->map(count * sizeof(InstanceTransform), sizeof(float), offset));
+            if (dst) {
+                for (size_t i = begin; i < end; ++i, ++dst) {
+                    dst->model = entryMatrix(models[drawOrder[i]]);
+                    dst->normal = glm::mat3(glm::transpose(glm::inverse(dst->model)));
+                }
+                instanceStream->unmap();
+                model->DrawInstanced(shaders, drawFeatures, instanceStream->id(), offset, static_cast<GLsizei>(count));
+                drawn = true;
+            }
+        }
+        if (!drawn) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto &e = models[drawOrder[i]];
+                e.model->Draw(shaders, drawFeatures, entryMatrix(e));
+            }
+        }
+        begin = end;
+    }
+}
+
+void ModelManager::drawNodes(Model &model, size_t begin, size_t end, ShaderPermutations &shaders, unsigned int drawFeatures)
+{
+    // Une transform par (nœud, instance), rangées par nœud : les nœuds d'un même maillage sont
+    // contigus et partent en un seul appel instancié
+    const size_t count = end - begin;
+    const size_t total = count * model.nodes.size();
+    if (total > 1) {
+        if (!instanceStream) {
+            instanceStream = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, kInstanceStreamBytes);
+        }
+        GLintptr offset = 0;
+        auto *dst = static_cast<InstanceTransform*>(
+            instanceStream->map(total * sizeof(InstanceTransform), sizeof(float), offset));
+        if (dst) {
+            for (const auto &node : model.nodes) {
+                for (size_t i = begin; i < end; ++i, ++dst) {
+                    dst->model = entryMatrix(models[drawOrder[i]]) * node.transform;
+                    dst->normal = glm::mat3(glm::transpose(glm::inverse(dst->model)));
+                }
+            }
+            instanceStream->unmap();
+
+            size_t first = 0;
+            while (first < model.nodes.size()) {
+                size_t last = first + 1;
+                while (last < model.nodes.size() && model.nodes[last].mesh == model.nodes[first].mesh) ++last;
+                model.DrawMeshInstanced(model.nodes[first].mesh, shaders, drawFeatures, instanceStream->id(),
+                                        offset + static_cast<GLintptr>(first * count * sizeof(InstanceTransform)),
+                                        static_cast<GLsizei>((last - first) * count));
+                first = last;
+            }
+            return;
+        }
+    }
+    for (size_t i = begin; i < end; ++i) {
+        const auto &e = models[drawOrder[i]];
+        model.Draw(shaders, drawFeatures, entryMatrix(e));
     }
 }
 
@@ -100,7 +389,7 @@ void ModelManager::beginPlacement(const std::string &path)
     try {
         logger.info(std::string("Begin placement: ") + path);
         Entry e;
-        e.model = std::make_unique<Model>(path);
+        e.model = acquireModel(path);
         e.position = glm::vec3(0.0f);
         e.rotation = glm::vec3(0.0f);
         e.scale = glm::vec3(1.0f);
@@ -136,26 +425,19 @@ void ModelManager::cancelPlacement()
     preview.reset();
 }
 
-void ModelManager::drawPreview(Shader &shader, bool highlight, const glm::vec3& highlightColor)
+void ModelManager::drawPreview(ShaderPermutations &shaders, bool highlight)
 {
     if (!preview) return;
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, preview->position);
-    model = glm::rotate(model, glm::radians(preview->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(preview->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(preview->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::scale(model, preview->scale == glm::vec3(0.0f) ? glm::vec3(1.0f) : preview->scale);
-    shader.setBool("highlightActive", highlight);
-    shader.setVec3("highlightColor", highlightColor);
-    shader.setMat4("model", model);
-    preview->model->Draw(shader);
+    touchTextures(*preview->model, projectedSize(*preview, 0.5f * glm::length(preview->model->getModelSize())));
+    preview->model->Draw(shaders, highlight ? ShaderFeature::Highlight : ShaderFeature::None, entryMatrix(*preview));
 }
 
-std::vector<ModelInstanceData> ModelManager::serializeInstances() const
+std::vector<ModelInstanceData> ModelManager::ToInstanceData(const Instances& instances)
 {
     std::vector<ModelInstanceData> result;
-    result.reserve(models.size());
-    for (const auto& entry : models) {
+    result.reserve(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const Entry& entry = instances[i];
         ModelInstanceData data;
         data.path = entry.path;
         data.position = entry.position;
@@ -183,10 +465,85 @@ void ModelManager::DropCallback(GLFWwindow* window, int count, const char** path
 
 void ModelManager::loadInstances(const std::vector<ModelInstanceData>& data)
 {
-    clear();
+    PROFILE_ZONE_CAT("ModelManager::loadInstances", "io");
+    // L'ancienne scène garde ses modèles en vie pendant la bascule : les assets communs
+    // aux deux maps ne sont pas réimportés, ceux qui ne servent plus partent à la fin
+    const Instances previous = models;
+
+    std::vector<std::string> missing;
+    std::set<std::string> seen;
     for (const auto& entry : data) {
-        addModelInstance(entry);
+        if (entry.path.empty() || !seen.insert(entry.path).second) continue;
+        auto it = assets.find(entry.path);
+        if (it == assets.end() || it->second.expired()) missing.push_back(entry.path);
+    }
+    const std::vector<std::shared_ptr<Model>> imported = importAssets(missing);
+
+    // Instances reprises à la même place : seules celles qui diffèrent sont modifiées,
+    // les blocs inchangés restent partagés avec l'ancienne scène
+    Instances next = previous;
+    size_t out = 0, kept = 0;
+    for (const auto& entry : data) {
+        if (entry.path.empty()) {
+            logger.error("Chemin vide pour loadInstances");
+            continue;
+        }
+        try {
+            if (out < next.size() && next[out].path == entry.path && next[out].model && !entry.autoScale) {
+                const glm::vec3 scale = entry.scale == glm::vec3(0.0f) ? glm::vec3(1.0f) : entry.scale;
+                const Entry& current = next[out];
+                if (current.position != entry.position || current.rotation != entry.rotation || current.scale != scale) {
+                    Entry& e = next.edit(out);
+                    e.position = entry.position;
+                    e.rotation = entry.rotation;
+                    e.scale = scale;
+                }
+                ++kept;
+            } else {
+                Entry e;
+                makeEntry(entry, e);
+                if (out < next.size()) next.edit(out) = std::move(e);
+                else next.push_back(std::move(e));
+            }
+            ++out;
+        } catch (const std::exception &ex) {
+            logger.error(std::string("Echec ajout modèle: ") + ex.what());
+        }
+    }
+    while (next.size() > out) next.erase(next.size() - 1);
+
+    models = next;
+    preview.reset();
+    count = static_cast<int>(models.size());
+    clearHistory();
+    logger.info("Instances chargees: " + std::to_string(models.size()) + " (" + std::to_string(kept) +
+                " reprises, " + std::to_string(missing.size()) + " assets importes)");
+}
+
+std::vector<std::shared_ptr<Model>> ModelManager::importAssets(const std::vector<std::string>& paths)
+{
+    // Imports sans appel GL répartis sur le JobSystem, envoyés au GPU ensuite depuis ce thread ;
+    // les assets déjà préchargés ne sont pas réimportés
+    std::vector<std::shared_ptr<Model>> imported(paths.size());
+    size_t warm = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if ((imported[i] = takeWarm(paths[i]))) ++warm;
     }
+    JobSystem::Instance().parallelFor(paths.size(), [&](size_t i) {
+        if (imported[i]) return;
+        try {
+            imported[i] = std::make_shared<Model>(paths[i], false, true);
+        } catch (const std::exception &ex) {
+            logger.error("Echec import: " + paths[i] + " (" + ex.what() + ")");
+        }
+    });
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!imported[i]) continue;
+        imported[i]->uploadToGpu();
+        assets[paths[i]] = imported[i];
+    }
+    if (warm) logger.debug("Assets precharges repris: " + std::to_string(warm));
+    return imported;
 }
 
 bool ModelManager::raycast(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, size_t& outIndex) {
@@ -224,13 +581,144 @@ bool ModelManager::raycast(const glm::vec3& rayOrigin, const glm::vec3& rayDirec
 
 void ModelManager::updateModel(size_t index, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale, float opacity) {
     if (index < models.size()) {
-        models[index].position = position;
-        models[index].rotation = rotation;
-        models[index].scale = scale;
+        pushHistory();
+        Entry &e = models.edit(index);
+        e.position = position;
+        e.rotation = rotation;
+        e.scale = scale;
         // L'opacité devra être gérée dans le shader
+        notifyEdit(InstanceEdit::Kind::Update, index);
+    }
+}
+
+void ModelManager::removeModel(size_t index)
+{
+    if (index >= models.size()) return;
+    logger.info("Suppression du modele: " + models[index].path);
+    pushHistory();
+    models.erase(index);
+    notifyEdit(InstanceEdit::Kind::Remove, index);
+}
+
+void ModelManager::notifyEdit(InstanceEdit::Kind kind, size_t index)
+{
+    if (!editListener) return;
+    InstanceEdit edit;
+    edit.kind = kind;
+    edit.index = index;
+    if (kind != InstanceEdit::Kind::Remove) {
+        const Entry &e = models[index];
+        edit.data.path = e.path;
+        edit.data.position = e.position;
+        edit.data.rotation = e.rotation;
+        edit.data.scale = e.scale;
+    }
+    editListener(edit);
+}
+
+void ModelManager::pushHistory()
+{
+    // Blocs recopiés depuis l'étape précédente : seule celle-ci retient encore leur ancienne version
+    const size_t copied = models.takeCopiedBytes();
+    if (!undoSteps.empty()) {
+        undoSteps.back().bytes += copied;
+        historyUsed += copied;
+    }
+    undoSteps.push_back({models, 0});
+    for (const auto &step : redoSteps) historyUsed -= step.bytes;
+    redoSteps.clear();
+
+    while (historyUsed > historyBudget && undoSteps.size() > 1) {
+        historyUsed -= undoSteps.front().bytes;
+        undoSteps.pop_front();
     }
 }
 
+void ModelManager::clearHistory()
+{
+    undoSteps.clear();
+    redoSteps.clear();
+    historyUsed = 0;
+    models.takeCopiedBytes();
+}
+
+bool ModelManager::undo()
+{
+    if (undoSteps.empty()) return false;
+    HistoryStep step = undoSteps.back();
+    undoSteps.pop_back();
+    historyUsed -= step.bytes;
+    models.takeCopiedBytes();
+    redoSteps.push_back({models, 0});
+    restore(step.instances);
+    logger.debug("Annulation, " + std::to_string(undoSteps.size()) + " etapes restantes");
+    return true;
+}
+
+bool ModelManager::redo()
+{
+    if (redoSteps.empty()) return false;
+    HistoryStep step = redoSteps.back();
+    redoSteps.pop_back();
+    historyUsed -= step.bytes;
+    models.takeCopiedBytes();
+    undoSteps.push_back({models, 0});
+    restore(step.instances);
+    return true;
+}
+
+void ModelManager::restore(Instances target)
+{
+    const Instances previous = models;
+    models = target;
+    if (!editListener) return;
+
+    auto same = [](const Entry &a, const Entry &b) {
+        return a.model == b.model && a.path == b.path && a.position == b.position &&
+               a.rotation == b.rotation && a.scale == b.scale;
+    };
+    const size_t oldSize = previous.size();
+    const size_t newSize = models.size();
+
+    // Même taille : comparaison bloc par bloc, les blocs partagés sont identiques d'office
+    if (oldSize == newSize) {
+        for (size_t i = 0; i < newSize; ++i) {
+            if (i % Instances::ChunkLength == 0 && previous.sharesChunk(models, i / Instances::ChunkLength)) {
+                i += Instances::ChunkLength - 1;
+                continue;
+            }
+            const Entry &before = previous[i];
+            const Entry &after = models[i];
+            if (same(before, after)) continue;
+            if (before.model == after.model && before.path == after.path) {
+                notifyEdit(InstanceEdit::Kind::Update, i);
+            } else {
+                notifyEdit(InstanceEdit::Kind::Remove, i);
+                notifyEdit(InstanceEdit::Kind::Add, i);
+            }
+        }
+        return;
+    }
+
+    // Sinon : préfixe et suffixe communs gardés, le milieu est supprimé puis réinséré
+    const size_t common = std::min(oldSize, newSize);
+    size_t front = 0;
+    while (front < common) {
+        if (front % Instances::ChunkLength == 0 && front + Instances::ChunkLength <= common &&
+            previous.sharesChunk(models, front / Instances::ChunkLength)) {
+            front += Instances::ChunkLength;
+            continue;
+        }
+        if (!same(previous[front], models[front])) break;
+        ++front;
+    }
+    size_t back = 0;
+    while (back < common - front && same(previous[oldSize - 1 - back], models[newSize - 1 - back])) ++back;
+
+    for (size_t i = front; i < oldSize - back; ++i) notifyEdit(InstanceEdit::Kind::Remove, front);
+    for (size_t i = front; i < newSize - back; ++i) notifyEdit(InstanceEdit::Kind::Add, i);
+}
+
 const ModelManager::Entry* ModelManager::getModel(size_t index) const {
     if (index < models.size()) {
         return &models[index];
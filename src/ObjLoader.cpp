@@ -0,0 +1,518 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include "VertexProcessing.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+static ComponentLogger objLogger("Model");
+
+namespace {
+const int kMissing = INT_MIN;
+// En dessous, un seul bloc : le découpage coûterait plus qu'il ne rapporte
+const size_t kMinChunkBytes = 256u * 1024u;
+const size_t kMinParallelCorners = 64u * 1024u;
+const size_t kBlockCorners = 16u * 1024u;
+
+// Un coin de face : indices 0-based de position, coordonnée de texture et normale
+struct Corner {
+    int v = kMissing, vt = kMissing, vn = kMissing;
+    bool operator==(const Corner &o) const { return v == o.v && vt == o.vt && vn == o.vn; }
+};
+
+struct CornerHash {
+    size_t operator()(const Corner &c) const
+    {
+        uint64_t h = static_cast<uint32_t>(c.v) * 0x9E3779B97F4A7C15ull;
+        h ^= (static_cast<uint32_t>(c.vt) + 0x7F4A7C15ull + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+        h ^= (static_cast<uint32_t>(c.vn) + 0x165667B1ull + (h << 6) + (h >> 2)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+// Indices négatifs (relatifs à la fin de la liste) : résolus dans le bloc, décalés à la fusion
+enum RelativeBits : unsigned char { RelativeV = 1, RelativeVt = 2, RelativeVn = 4 };
+
+struct MaterialRun {
+    size_t firstCorner;
+    std::string name;
+};
+
+struct Chunk {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texcoords;
+    std::vector<Corner> corners;                // 3 par triangle
+    std::vector<unsigned char> relative;        // RelativeBits par coin
+    std::vector<MaterialRun> runs;              // usemtl rencontrés dans le bloc
+    std::vector<std::string> libraries;         // mtllib
+    size_t badLines = 0;
+    size_t basePositions = 0, baseTexcoords = 0, baseNormals = 0;
+};
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+inline const char *skipBlank(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline bool parseFloat(const char *&p, const char *end, float &out)
+{
+    p = skipBlank(p, end);
+    if (p < end && *p == '+') ++p;
+    const auto result = std::from_chars(p, end, out);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+inline bool parseIndex(const char *&p, const char *end, int &out)
+{
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    if (p >= end || *p < '0' || *p > '9') return false;
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > INT_MAX) return false;
+        ++p;
+    }
+    out = static_cast<int>(negative ? -value : value);
+    return true;
+}
+
+// Mot-clé suivi d'un blanc ; `rest` pointe ensuite sur l'argument
+inline bool keyword(const char *p, const char *end, const char *word, const char *&rest)
+{
+    const size_t len = std::strlen(word);
+    if (static_cast<size_t>(end - p) <= len || std::memcmp(p, word, len) != 0 || !isBlank(p[len])) return false;
+    rest = skipBlank(p + len, end);
+    return true;
+}
+
+std::string trimmed(const char *p, const char *end)
+{
+    p = skipBlank(p, end);
+    while (end > p && (isBlank(end[-1]) || end[-1] == '\r')) --end;
+    return std::string(p, end);
+}
+
+inline void resolveIndex(int index, size_t localCount, int &out, unsigned char &relative, unsigned char bit)
+{
+    if (index > 0) {
+        out = index - 1;
+    } else {
+        out = static_cast<int>(localCount) + index;
+        relative |= bit;
+    }
+}
+
+void parseFace(Chunk &c, const char *p, const char *end, std::vector<Corner> &poly, std::vector<unsigned char> &polyRelative)
+{
+    poly.clear();
+    polyRelative.clear();
+    for (;;) {
+        p = skipBlank(p, end);
+        if (p >= end) break;
+        Corner corner;
+        unsigned char relative = 0;
+        int index = 0;
+        if (!parseIndex(p, end, index) || index == 0) { ++c.badLines; return; }
+        resolveIndex(index, c.positions.size(), corner.v, relative, RelativeV);
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/' && !isBlank(*p)) {
+                if (!parseIndex(p, end, index) || index == 0) { ++c.badLines; return; }
+                resolveIndex(index, c.texcoords.size(), corner.vt, relative, RelativeVt);
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                if (!parseIndex(p, end, index) || index == 0) { ++c.badLines; return; }
+                resolveIndex(index, c.normals.size(), corner.vn, relative, RelativeVn);
+            }
+        }
+        if (p < end && !isBlank(*p)) { ++c.badLines; return; }
+        poly.push_back(corner);
+        polyRelative.push_back(relative);
+    }
+    // Polygones triangulés en éventail (équivalent de aiProcess_Triangulate pour des faces convexes)
+    for (size_t i = 1; i + 1 < poly.size(); ++i) {
+        const size_t tri[3] = {0, i, i + 1};
+        for (size_t k : tri) {
+            c.corners.push_back(poly[k]);
+            c.relative.push_back(polyRelative[k]);
+        }
+    }
+}
+
+void parseChunk(Chunk &c)
+{
+    PROFILE_ZONE_CAT("OBJ chunk", "import");
+    std::vector<Corner> poly;
+    std::vector<unsigned char> polyRelative;
+    const char *p = c.begin;
+    while (p < c.end) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', c.end - p));
+        if (!lineEnd) lineEnd = c.end;
+        const char *eol = lineEnd;
+        if (eol > p && eol[-1] == '\r') --eol;
+        const char *q = skipBlank(p, eol);
+        p = lineEnd + 1;
+        if (q + 1 >= eol) continue;
+
+        const char *rest = nullptr;
+        if (q[0] == 'v' && isBlank(q[1])) {
+            glm::vec3 v;
+            q += 1;
+            if (!parseFloat(q, eol, v.x) || !parseFloat(q, eol, v.y) || !parseFloat(q, eol, v.z)) { ++c.badLines; continue; }
+            c.positions.push_back(v);
+        } else if (q[0] == 'v' && q[1] == 't' && q + 2 < eol && isBlank(q[2])) {
+            glm::vec2 t(0.0f);
+            q += 2;
+            if (!parseFloat(q, eol, t.x)) { ++c.badLines; continue; }
+            parseFloat(q, eol, t.y);
+            c.texcoords.push_back(t);
+        } else if (q[0] == 'v' && q[1] == 'n' && q + 2 < eol && isBlank(q[2])) {
+            glm::vec3 n;
+            q += 2;
+            if (!parseFloat(q, eol, n.x) || !parseFloat(q, eol, n.y) || !parseFloat(q, eol, n.z)) { ++c.badLines; continue; }
+            c.normals.push_back(n);
+        } else if (q[0] == 'f' && isBlank(q[1])) {
+            parseFace(c, q + 1, eol, poly, polyRelative);
+        } else if (keyword(q, eol, "usemtl", rest)) {
+            c.runs.push_back(MaterialRun{c.corners.size(), trimmed(rest, eol)});
+        } else if (keyword(q, eol, "mtllib", rest)) {
+            c.libraries.push_back(trimmed(rest, eol));
+        }
+        // o, g, s, l, p et commentaires : ignorés (un maillage par matériau)
+    }
+}
+
+std::string resolveTexture(const std::string &directory, std::string file)
+{
+    std::replace(file.begin(), file.end(), '\\', '/');
+    const std::string direct = directory + "/" + file;
+    if (std::ifstream(direct).good()) return direct;
+    const std::string flat = directory + "/" + file.substr(file.find_last_of('/') + 1);
+    if (std::ifstream(flat).good()) return flat;
+    return direct;
+}
+
+// Nom de fichier d'une ligne map_* après ses options (-bm 0.5, -o u v w, -clamp on...)
+std::string textureFile(const char *p, const char *end)
+{
+    p = skipBlank(p, end);
+    while (p < end && *p == '-') {
+        const char *option = p;
+        while (p < end && !isBlank(*p)) ++p;
+        const std::string name(option, p);
+        p = skipBlank(p, end);
+        if (name == "-imfchan" || name == "-type") {
+            while (p < end && !isBlank(*p)) ++p;
+            p = skipBlank(p, end);
+            continue;
+        }
+        // Arguments numériques ou on/off, en nombre variable
+        for (;;) {
+            const char *token = p;
+            float value;
+            if (parseFloat(token, end, value) && (token == end || isBlank(*token))) { p = skipBlank(token, end); continue; }
+            if (end - p >= 2 && std::memcmp(p, "on", 2) == 0 && (p + 2 == end || isBlank(p[2]))) { p = skipBlank(p + 2, end); continue; }
+            if (end - p >= 3 && std::memcmp(p, "off", 3) == 0 && (p + 3 == end || isBlank(p[3]))) { p = skipBlank(p + 3, end); continue; }
+            break;
+        }
+    }
+    return trimmed(p, end);
+}
+
+void parseMaterialLibrary(const std::string &path, const std::string &directory, std::vector<ObjLoader::Material> &materials)
+{
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        objLogger.error("Bibliotheque de materiaux introuvable: " + path);
+        return;
+    }
+    const char *p = reinterpret_cast<const char *>(file.data());
+    const char *end = p + file.size();
+    ObjLoader::Material *current = nullptr;
+    bool hasDissolve = false;
+    while (p < end) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        const char *eol = lineEnd;
+        if (eol > p && eol[-1] == '\r') --eol;
+        const char *q = skipBlank(p, eol);
+        p = lineEnd + 1;
+
+        const char *rest = nullptr;
+        if (keyword(q, eol, "newmtl", rest)) {
+            materials.push_back(ObjLoader::Material{trimmed(rest, eol), {}, 1.0f});
+            current = &materials.back();
+            hasDissolve = false;
+            continue;
+        }
+        if (!current) continue;
+
+        // Mêmes types que le chemin Assimp : map_Bump atterrit dans HEIGHT
+        const char *type = nullptr;
+        if (keyword(q, eol, "map_Kd", rest)) type = "texture_diffuse";
+        else if (keyword(q, eol, "map_Ks", rest)) type = "texture_specular";
+        else if (keyword(q, eol, "map_Ka", rest)) type = "texture_ambient";
+        else if (keyword(q, eol, "map_Bump", rest) || keyword(q, eol, "map_bump", rest) || keyword(q, eol, "bump", rest)) type = "texture_height";
+        else if (keyword(q, eol, "norm", rest)) type = "texture_normal";
+        if (type) {
+            const std::string name = textureFile(rest, eol);
+            if (!name.empty()) current->textures.emplace_back(type, resolveTexture(directory, name));
+        } else if (keyword(q, eol, "d", rest)) {
+            parseFloat(rest, eol, current->opacity);
+            hasDissolve = true;
+        } else if (keyword(q, eol, "Tr", rest) && !hasDissolve) {
+            float transparency = 0.0f;
+            if (parseFloat(rest, eol, transparency)) current->opacity = 1.0f - transparency;
+        }
+    }
+}
+
+struct Pools {
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texcoords;
+};
+
+// Fusion des coins identiques : chaque partition de la table est remplie par un thread, puis
+// les sommets sont numérotés dans l'ordre de première apparition (résultat déterministe)
+void buildGroup(const std::vector<Corner> &corners, const Pools &pools, ObjLoader::Group &group)
+{
+    JobSystem &jobs = JobSystem::Instance();
+    const size_t n = corners.size();
+    const size_t shards = n < kMinParallelCorners ? 1 : jobs.workerCount() + 1;
+    const size_t blocks = (n + kBlockCorners - 1) / kBlockCorners;
+
+    std::vector<uint32_t> shardOf(n);
+    jobs.parallelFor(blocks, [&](size_t b) {
+        const size_t last = std::min(n, (b + 1) * kBlockCorners);
+        for (size_t i = b * kBlockCorners; i < last; ++i) shardOf[i] = static_cast<uint32_t>(CornerHash()(corners[i]) % shards);
+    });
+
+    std::vector<uint32_t> slot(n);
+    std::vector<size_t> shardSizes(shards, 0);
+    jobs.parallelFor(shards, [&](size_t s) {
+        std::unordered_map<Corner, uint32_t, CornerHash> table;
+        table.reserve(n / shards / 2 + 16);
+        for (size_t i = 0; i < n; ++i) {
+            if (shardOf[i] != s) continue;
+            const uint32_t next = static_cast<uint32_t>(table.size());
+            slot[i] = table.emplace(corners[i], next).first->second;
+        }
+        shardSizes[s] = table.size();
+    });
+
+    std::vector<std::vector<uint32_t>> remap(shards);
+    for (size_t s = 0; s < shards; ++s) remap[s].assign(shardSizes[s], UINT32_MAX);
+    std::vector<uint32_t> vertexCorner;
+    group.indices.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t &id = remap[shardOf[i]][slot[i]];
+        if (id == UINT32_MAX) {
+            id = static_cast<uint32_t>(vertexCorner.size());
+            vertexCorner.push_back(static_cast<uint32_t>(i));
+        }
+        group.indices[i] = id;
+    }
+
+    const size_t vertexCount = vertexCorner.size();
+    group.vertices.resize(vertexCount);
+    std::atomic<bool> missingNormals{false}, hasTexcoords{false};
+    jobs.parallelFor((vertexCount + kBlockCorners - 1) / kBlockCorners, [&](size_t b) {
+        const size_t last = std::min(vertexCount, (b + 1) * kBlockCorners);
+        bool noNormal = false, texcoord = false;
+        for (size_t i = b * kBlockCorners; i < last; ++i) {
+            const Corner &c = corners[vertexCorner[i]];
+            Vertex &v = group.vertices[i];
+            v.Position = pools.positions[c.v];
+            v.Normal = c.vn != kMissing ? pools.normals[c.vn] : glm::vec3(0.0f);
+            // Même convention que aiProcess_FlipUVs
+            v.TexCoords = c.vt != kMissing ? glm::vec2(pools.texcoords[c.vt].x, 1.0f - pools.texcoords[c.vt].y) : glm::vec2(0.0f);
+            v.Tangent = v.Bitangent = glm::vec3(0.0f);
+            noNormal |= c.vn == kMissing;
+            texcoord |= c.vt != kMissing;
+        }
+        if (noNormal) missingNormals = true;
+        if (texcoord) hasTexcoords = true;
+    });
+
+    if (missingNormals) VertexProcessing::GenerateNormals(group.vertices, group.indices);
+    if (hasTexcoords) VertexProcessing::GenerateTangents(group.vertices, group.indices);
+}
+}
+
+bool ObjLoader::IsObj(const std::string &path)
+{
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".obj";
+}
+
+bool ObjLoader::Load(const std::string &path, Scene &scene)
+{
+    PROFILE_ZONE_CAT("OBJ import", "import");
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() == 0) {
+        objLogger.error("OBJ illisible: " + path);
+        return false;
+    }
+    file.adviseSequential();
+    const size_t slash = path.find_last_of("/\\");
+    const std::string directory = slash == std::string::npos ? "." : path.substr(0, slash);
+
+    // Blocs coupés après un saut de ligne ; quelques blocs par thread pour équilibrer la charge
+    JobSystem &jobs = JobSystem::Instance();
+    const char *data = reinterpret_cast<const char *>(file.data());
+    const char *end = data + file.size();
+    const size_t chunkCount = std::max<size_t>(1, std::min(file.size() / kMinChunkBytes, (jobs.workerCount() + 1) * 4));
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkCount);
+    const char *start = data;
+    for (size_t i = 1; i <= chunkCount && start < end; ++i) {
+        const char *cut = end;
+        if (i < chunkCount) {
+            cut = std::max(start, data + file.size() / chunkCount * i);
+            const char *newline = static_cast<const char *>(std::memchr(cut, '\n', end - cut));
+            cut = newline ? newline + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = start;
+        chunk.end = cut;
+        chunks.push_back(std::move(chunk));
+        start = cut;
+    }
+    jobs.parallelFor(chunks.size(), [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+    // Concaténation des listes, décalage de chaque bloc dans les listes globales
+    Pools pools;
+    size_t badLines = 0;
+    for (auto &c : chunks) {
+        c.basePositions = pools.positions.size();
+        c.baseTexcoords = pools.texcoords.size();
+        c.baseNormals = pools.normals.size();
+        pools.positions.insert(pools.positions.end(), c.positions.begin(), c.positions.end());
+        pools.texcoords.insert(pools.texcoords.end(), c.texcoords.begin(), c.texcoords.end());
+        pools.normals.insert(pools.normals.end(), c.normals.begin(), c.normals.end());
+        std::vector<glm::vec3>().swap(c.positions);
+        std::vector<glm::vec2>().swap(c.texcoords);
+        std::vector<glm::vec3>().swap(c.normals);
+        badLines += c.badLines;
+    }
+    if (badLines > 0) objLogger.debug("OBJ: " + std::to_string(badLines) + " lignes ignorees dans " + path);
+
+    std::atomic<bool> outOfRange{false};
+    jobs.parallelFor(chunks.size(), [&](size_t i) {
+        Chunk &c = chunks[i];
+        const auto positions = static_cast<long long>(pools.positions.size());
+        const auto texcoords = static_cast<long long>(pools.texcoords.size());
+        const auto normals = static_cast<long long>(pools.normals.size());
+        for (size_t k = 0; k < c.corners.size(); ++k) {
+            Corner &corner = c.corners[k];
+            const unsigned char relative = c.relative[k];
+            if (relative & RelativeV) corner.v += static_cast<int>(c.basePositions);
+            if (relative & RelativeVt) corner.vt += static_cast<int>(c.baseTexcoords);
+            if (relative & RelativeVn) corner.vn += static_cast<int>(c.baseNormals);
+            if (corner.v < 0 || corner.v >= positions ||
+                (corner.vt != kMissing && (corner.vt < 0 || corner.vt >= texcoords)) ||
+                (corner.vn != kMissing && (corner.vn < 0 || corner.vn >= normals))) {
+                outOfRange = true;
+                return;
+            }
+        }
+        std::vector<unsigned char>().swap(c.relative);
+    });
+    if (outOfRange) {
+        objLogger.error("OBJ: indice de face hors limites dans " + path);
+        return false;
+    }
+
+    // Matériaux des bibliothèques référencées, dans l'ordre d'apparition
+    std::vector<std::string> libraries;
+    for (const auto &c : chunks) {
+        for (const auto &lib : c.libraries) {
+            if (std::find(libraries.begin(), libraries.end(), lib) == libraries.end()) libraries.push_back(lib);
+        }
+    }
+    for (const auto &lib : libraries) parseMaterialLibrary(resolveTexture(directory, lib), directory, scene.materials);
+    std::map<std::string, int> materialIndex;
+    for (size_t i = 0; i < scene.materials.size(); ++i) materialIndex.emplace(scene.materials[i].name, static_cast<int>(i));
+
+    // Triangles répartis par matériau dans l'ordre du fichier ; l'usemtl actif traverse les blocs
+    struct Segment {
+        size_t chunk, first, last;
+    };
+    std::vector<int> groupMaterials;
+    std::vector<std::vector<Segment>> groupSegments;
+    auto addSegment = [&](const std::string &name, size_t chunk, size_t first, size_t last) {
+        int material = -1;
+        if (!name.empty()) {
+            auto it = materialIndex.find(name);
+            if (it != materialIndex.end()) material = it->second;
+        }
+        auto found = std::find(groupMaterials.begin(), groupMaterials.end(), material);
+        size_t group = found - groupMaterials.begin();
+        if (found == groupMaterials.end()) {
+            groupMaterials.push_back(material);
+            groupSegments.emplace_back();
+        }
+        groupSegments[group].push_back(Segment{chunk, first, last});
+    };
+    std::string current;
+    for (size_t ci = 0; ci < chunks.size(); ++ci) {
+        const Chunk &c = chunks[ci];
+        size_t position = 0;
+        for (const auto &run : c.runs) {
+            if (run.firstCorner > position) addSegment(current, ci, position, run.firstCorner);
+            current = run.name;
+            position = run.firstCorner;
+        }
+        if (c.corners.size() > position) addSegment(current, ci, position, c.corners.size());
+    }
+
+    size_t vertexCount = 0, cornerCount = 0;
+    for (size_t g = 0; g < groupSegments.size(); ++g) {
+        std::vector<Corner> corners;
+        size_t total = 0;
+        for (const auto &seg : groupSegments[g]) total += seg.last - seg.first;
+        corners.reserve(total);
+        for (const auto &seg : groupSegments[g]) {
+            const auto &src = chunks[seg.chunk].corners;
+            corners.insert(corners.end(), src.begin() + seg.first, src.begin() + seg.last);
+        }
+
+        Group group;
+        group.material = groupMaterials[g];
+        buildGroup(corners, pools, group);
+        cornerCount += corners.size();
+        vertexCount += group.vertices.size();
+        scene.groups.push_back(std::move(group));
+    }
+
+    if (scene.groups.empty()) {
+        objLogger.error("OBJ sans face: " + path);
+        return false;
+    }
+    objLogger.info("OBJ charge: " + path + " (" + std::to_string(chunks.size()) + " blocs, " +
+                   std::to_string(scene.groups.size()) + " maillages, " + std::to_string(cornerCount) +
+                   " coins fusionnes en " + std::to_string(vertexCount) + " sommets)");
+    return true;
+}
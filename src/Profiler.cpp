@@ -0,0 +1,135 @@
+#include "Profiler.h"
+
+#include <algorithm>
+
+bool Profiler::enabled = false;
+
+Profiler& Profiler::Instance()
+{
+    static Profiler instance;
+    return instance;
+}
+
+void Profiler::setEnabled(bool on)
+{
+    enabled = on;
+}
+
+double Profiler::msSinceFrameStart() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+}
+
+void Profiler::beginFrame()
+{
+    if (!enabled) {
+        inFrame = false;
+        return;
+    }
+    mainThread = std::this_thread::get_id();
+    frameStart = Clock::now();
+    zones.clear();
+    openZones.clear();
+    inFrame = true;
+
+    // Le créneau réutilisé est celui d'il y a GpuLatency frames : ses requêtes sont normalement prêtes
+    gpuFrameIndex = (gpuFrameIndex + 1) % GpuLatency;
+    GpuFrame& frame = gpuFrames[gpuFrameIndex];
+    if (frame.pending) collectGpu(frame);
+    frame.used = 0;
+    frame.pending = false;
+    gpuNesting = 0;
+    gpuQueryActive = false;
+}
+
+void Profiler::endFrame()
+{
+    if (!inFrame) return;
+    inFrame = false;
+
+    const double end = msSinceFrameStart();
+    while (!openZones.empty()) {
+        Zone& zone = zones[openZones.back()];
+        zone.durationMs = end - zone.startMs;
+        openZones.pop_back();
+    }
+    if (gpuQueryActive) {
+        glEndQuery(GL_TIME_ELAPSED);
+        ++gpuFrames[gpuFrameIndex].used;
+        gpuQueryActive = false;
+    }
+    gpuFrames[gpuFrameIndex].pending = gpuFrames[gpuFrameIndex].used > 0;
+
+    lastZones.swap(zones);
+    lastFrameDuration = end;
+
+    history[historyNext] = static_cast<float>(end);
+    historyNext = (historyNext + 1) % HistorySize;
+    historyFilled = std::min(historyFilled + 1, HistorySize);
+}
+
+void Profiler::beginZone(const char* name)
+{
+    if (!inFrame || std::this_thread::get_id() != mainThread) return;
+    zones.push_back(Zone{name, static_cast<int>(openZones.size()), msSinceFrameStart(), 0.0});
+    openZones.push_back(zones.size() - 1);
+}
+
+void Profiler::endZone()
+{
+    if (!inFrame || openZones.empty() || std::this_thread::get_id() != mainThread) return;
+    Zone& zone = zones[openZones.back()];
+    zone.durationMs = msSinceFrameStart() - zone.startMs;
+    openZones.pop_back();
+}
+
+void Profiler::beginGpuZone(const char* name)
+{
+    if (std::this_thread::get_id() != mainThread) return;
+    if (++gpuNesting != 1 || !inFrame) return;
+
+    GpuFrame& frame = gpuFrames[gpuFrameIndex];
+    if (frame.used == frame.queries.size()) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+        frame.names.push_back(nullptr);
+    }
+    frame.names[frame.used] = name;
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used]);
+    gpuQueryActive = true;
+}
+
+void Profiler::endGpuZone()
+{
+    if (std::this_thread::get_id() != mainThread || gpuNesting == 0) return;
+    if (--gpuNesting != 0 || !gpuQueryActive) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    ++gpuFrames[gpuFrameIndex].used;
+    gpuQueryActive = false;
+}
+
+void Profiler::collectGpu(GpuFrame& frame)
+{
+    // Les requêtes se terminent dans l'ordre : si la dernière est prête, toutes le sont
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;   // GPU trop en retard : on saute cette frame plutôt que d'attendre
+
+    lastGpu.clear();
+    for (size_t i = 0; i < frame.used; ++i) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &ns);
+        lastGpu.push_back(GpuZone{frame.names[i], static_cast<double>(ns) / 1.0e6});
+    }
+}
+
+float Profiler::percentile(float p) const
+{
+    if (historyFilled == 0) return 0.0f;
+    std::vector<float> sorted(history.begin(), history.begin() + historyFilled);
+    size_t rank = static_cast<size_t>(std::clamp(p, 0.0f, 100.0f) / 100.0f * (sorted.size() - 1) + 0.5f);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
@@ -0,0 +1,91 @@
+#include "ProfilerPanel.h"
+#include "Profiler.h"
+#include "UploadScheduler.h"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+
+ProfilerPanel::ProfilerPanel(Profiler* prof)
+    : profiler(prof)
+{
+}
+
+void ProfilerPanel::setVisible(bool visible)
+{
+    m_visible = visible;
+    if (profiler) profiler->setEnabled(visible);
+}
+
+void ProfilerPanel::draw(bool* open)
+{
+    if (!profiler) return;
+    if (open && !(*open)) return;
+
+    ImGui::SetNextWindowSize(ImVec2(420, 480), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler", open)) {
+        bool enabled = Profiler::IsEnabled();
+        if (ImGui::Checkbox("Actif", &enabled)) profiler->setEnabled(enabled);
+
+        // Historique remis dans l'ordre chronologique pour le graphe
+        const auto& history = profiler->frameHistory();
+        const size_t count = profiler->historyCount();
+        const size_t first = count < Profiler::HistorySize ? 0 : profiler->historyOffset();
+        float frames[Profiler::HistorySize];
+        float maxMs = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            frames[i] = history[(first + i) % Profiler::HistorySize];
+            maxMs = std::max(maxMs, frames[i]);
+        }
+
+        const float p50 = profiler->percentile(50.0f);
+        const float p95 = profiler->percentile(95.0f);
+        const float p99 = profiler->percentile(99.0f);
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%.2f ms", profiler->lastFrameMs());
+        ImGui::PlotLines("##frames", frames, static_cast<int>(count), 0, overlay, 0.0f,
+                         std::max(maxMs, 16.7f), ImVec2(-1, 80));
+        ImGui::Text("p50 %.2f ms   p95 %.2f ms   p99 %.2f ms", p50, p95, p99);
+
+        if (ImGui::CollapsingHeader("CPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if (ImGui::BeginTable("cpuZones", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+                ImGui::TableSetupColumn("Zone");
+                ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+                ImGui::TableHeadersRow();
+                for (const auto& zone : profiler->lastFrameZones()) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Indent(zone.depth * 12.0f + 1.0f);
+                    ImGui::TextUnformatted(zone.name);
+                    ImGui::Unindent(zone.depth * 12.0f + 1.0f);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", zone.durationMs);
+                }
+                ImGui::EndTable();
+            }
+        }
+
+        if (ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const auto& gpuZones = profiler->lastGpuZones();
+            if (gpuZones.empty()) {
+                ImGui::TextDisabled("Aucune mesure GPU disponible");
+            }
+            double total = 0.0;
+            for (const auto& zone : gpuZones) {
+                ImGui::Text("%-16s %.3f ms", zone.name, zone.durationMs);
+                total += zone.durationMs;
+            }
+            if (!gpuZones.empty()) {
+                ImGui::Separator();
+                ImGui::Text("%-16s %.3f ms", "Total", total);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Envois GPU")) {
+            UploadScheduler::Stats uploads = UploadScheduler::Instance().stats();
+            ImGui::Text("Derniere frame: %.1f Ko en %.0f us", uploads.bytesLastFrame / 1024.0, uploads.microsLastFrame);
+            ImGui::Text("En attente: %zu envois, %.1f Ko", uploads.queuedJobs, uploads.queuedBytes / 1024.0);
+        }
+    }
+    ImGui::End();
+}
@@ -1,5 +1,7 @@
 #include "Renderer.h"
 #include "Shader.h"
+#include "ShaderPermutations.h"
+#include "SceneState.h"
 #include "ModelManager.h"
 #include "Grid.h"
 #include "Camera.h"
@@ -7,23 +9,20 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-void Renderer::render(Shader& shader, ModelManager& modelManager, Grid& grid, const Camera& camera, float deltaTime, const EditorState& editorState) {
-    shader.use();
+void Renderer::render(ShaderPermutations& modelShaders, Shader& gridShader, ModelManager& modelManager, Grid& grid, const Camera& camera, const SceneState& sceneState, const EditorState& editorState) {
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)1600 / (float)900, 0.1f, 100.0f);
     glm::mat4 view = camera.GetViewMatrix();
-    shader.setMat4("projection", projection);
-    shader.setMat4("view", view);
-    glm::mat4 model = glm::mat4(1.0f);
-    shader.setMat4("model", model);
-    shader.setVec3("viewPos", camera.Position);
-    shader.setVec3("lightPos", glm::vec3(1.2f, 1.0f, 2.0f));
-    shader.setFloat("time", deltaTime);
+    modelShaders.beginFrame([&](Shader& shader) {
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("viewPos", camera.Position);
+        shader.setVec3("highlightColor", editorState.highlightColor);
+        sceneState.applyLighting(shader);
+    });
 
-    modelManager.drawAll(shader, editorState.highlightObjects, editorState.highlightColor);
+    modelManager.drawAll(modelShaders, editorState.highlightObjects);
 
     if (editorState.gridVisible) {
-        glm::mat4 gridModel = glm::mat4(1.0f);
-        shader.setMat4("model", gridModel);
-        grid.draw(shader, view, projection);
+        grid.draw(gridShader, view, projection);
     }
 }
\ No newline at end of file
@@ -64,6 +64,12 @@ void SandBoxUI::draw(GLFWwindow* window) {
             showRotatePopup = true;
             if (editor->selectedObject) tmpRotation = editor->selectedObject->rotation;
         }
+        if (ImGui::MenuItem("Delete")) {
+            models->removeModel(contextIndex);
+            editor->clearSelection();
+            showResizePopup = false;
+            showRotatePopup = false;
+        }
         ImGui::EndPopup();
     }
 
@@ -1,5 +1,13 @@
 #include "SceneSerializer.h"
+#include "AtomicFile.h"
+#include "Profiler.h"
+#include "BinaryMap.h"
+#include "MappedFile.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <filesystem>
 
@@ -7,82 +15,307 @@
 
 using json = nlohmann::json;
 
+bool SceneSerializer::compressBinary = true;
+
 namespace {
-json glmVec3ToJson(const glm::vec3& v) {
-    return json{v.x, v.y, v.z};
-}
+// Lecture SAX : les valeurs sont rangées directement dans le SceneSnapshot au fil du parseur,
+// sans arbre json intermédiaire. Seule la pile des contextes ouverts est conservée.
+class MapSaxReader {
+public:
+    explicit MapSaxReader(SceneSnapshot &snapshot) : snapshot(snapshot) {}
 
-glm::vec3 jsonToVec3(const json& j, const glm::vec3& fallback = glm::vec3(0.0f)) {
-    if (!j.is_array() || j.size() != 3) return fallback;
-    return glm::vec3(j[0].get<float>(), j[1].get<float>(), j[2].get<float>());
-}
+    // Un vecteur ne contient que des nombres : toute autre valeur rend la map invalide plutôt que
+    // de décaler les composantes suivantes
+    bool null() { return top() != Context::Vector; }
+    bool boolean(bool) { return top() != Context::Vector; }
+    bool number_integer(json::number_integer_t value) { return number(static_cast<float>(value)); }
+    bool number_unsigned(json::number_unsigned_t value) { return number(static_cast<float>(value)); }
+    bool number_float(json::number_float_t value, const json::string_t &) { return number(static_cast<float>(value)); }
+    bool binary(json::binary_t &) { return top() != Context::Vector; }
+
+    bool string(json::string_t &value)
+    {
+        if (top() == Context::Vector) return false;
+        if (top() == Context::Model && currentKey == "path") current.path = std::move(value);
+        return true;
+    }
+
+    bool key(json::string_t &value)
+    {
+        currentKey = std::move(value);
+        return true;
+    }
+
+    bool start_object(std::size_t)
+    {
+        if (top() == Context::Vector) return false;
+        Context context = Context::Skip;
+        if (stack.empty()) context = Context::Root;
+        else if (top() == Context::Root && currentKey == "light") context = Context::Light;
+        else if (top() == Context::Root && currentKey == "environment") context = Context::Environment;
+        else if (top() == Context::Models) {
+            current = ModelInstanceData();
+            context = Context::Model;
+        }
+        stack.push_back(context);
+        currentKey.clear();
+        return true;
+    }
+
+    bool end_object()
+    {
+        if (top() == Context::Model && !current.path.empty()) snapshot.models.push_back(std::move(current));
+        stack.pop_back();
+        // Les objets ne sont imbriqués que dans "models" : aucune clé à restaurer
+        currentKey.clear();
+        return true;
+    }
+
+    bool start_array(std::size_t)
+    {
+        if (top() == Context::Vector) return false;
+        Context context = Context::Skip;
+        if (top() == Context::Root && currentKey == "models") {
+            context = Context::Models;
+        } else if (glm::vec3 *target = vectorField()) {
+            context = Context::Vector;
+            vectorTarget = target;
+            vectorCount = 0;
+        }
+        stack.push_back(context);
+        return true;
+    }
+
+    bool end_array()
+    {
+        // Comme avant : un vecteur qui n'a pas exactement trois composantes garde sa valeur par défaut
+        if (top() == Context::Vector && vectorCount == 3 && vectorTarget) *vectorTarget = vectorValue;
+        stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) { return false; }
+
+private:
+    enum class Context { Root, Light, Environment, Models, Model, Vector, Skip };
+
+    Context top() const { return stack.empty() ? Context::Skip : stack.back(); }
+
+    glm::vec3 *vectorField()
+    {
+        switch (top()) {
+        case Context::Light:
+            if (currentKey == "direction") return &snapshot.light.direction;
+            if (currentKey == "ambient") return &snapshot.light.ambient;
+            if (currentKey == "diffuse") return &snapshot.light.diffuse;
+            if (currentKey == "specular") return &snapshot.light.specular;
+            return nullptr;
+        case Context::Environment:
+            return currentKey == "skyColor" ? &snapshot.environment.skyColor : nullptr;
+        case Context::Model:
+            if (currentKey == "position") return &current.position;
+            if (currentKey == "rotation") return &current.rotation;
+            if (currentKey == "scale") return &current.scale;
+            return nullptr;
+        default:
+            return nullptr;
+        }
+    }
+
+    bool number(float value)
+    {
+        switch (top()) {
+        case Context::Vector:
+            if (vectorCount < 3) vectorValue[vectorCount] = value;
+            ++vectorCount;
+            break;
+        case Context::Light:
+            if (currentKey == "intensity") snapshot.light.intensity = value;
+            break;
+        case Context::Environment:
+            if (currentKey == "ambientBoost") snapshot.environment.ambientBoost = value;
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    SceneSnapshot &snapshot;
+    std::vector<Context> stack;
+    std::string currentKey;
+    ModelInstanceData current;
+    glm::vec3 *vectorTarget = nullptr;
+    glm::vec3 vectorValue = glm::vec3(0.0f);
+    int vectorCount = 0;
+};
+
+// Écriture en flux à travers un tampon de taille fixe : la mémoire ne dépend pas du nombre
+// d'instances. Les flottants sont écrits au plus court sans perte (std::to_chars).
+class MapJsonWriter {
+public:
+    explicit MapJsonWriter(std::ofstream &out) : out(out) {}
+    ~MapJsonWriter() { flush(); }
+
+    void raw(const char *text) { write(text, std::strlen(text)); }
+
+    void number(float value)
+    {
+        // JSON n'a pas de NaN ni d'infini : 0, un null dans un vecteur rendrait la map illisible
+        if (!std::isfinite(value)) {
+            raw("0");
+            return;
+        }
+        char text[32];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        write(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    void vec3(const glm::vec3 &v)
+    {
+        raw("[");
+        number(v.x);
+        raw(", ");
+        number(v.y);
+        raw(", ");
+        number(v.z);
+        raw("]");
+    }
+
+    void string(const std::string &value)
+    {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (unsigned char c : value) {
+            switch (c) {
+            case '"': raw("\\\""); break;
+            case '\\': raw("\\\\"); break;
+            case '\n': raw("\\n"); break;
+            case '\r': raw("\\r"); break;
+            case '\t': raw("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    write(escaped, sizeof(escaped));
+                } else {
+                    put(static_cast<char>(c));
+                }
+            }
+        }
+        put('"');
+    }
+
+    void flush()
+    {
+        if (used == 0) return;
+        out.write(buffer, static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+private:
+    void put(char c)
+    {
+        if (used == sizeof(buffer)) flush();
+        buffer[used++] = c;
+    }
+
+    void write(const char *data, size_t size)
+    {
+        if (used + size > sizeof(buffer)) flush();
+        std::memcpy(buffer + used, data, size);
+        used += size;
+    }
+
+    std::ofstream &out;
+    char buffer[64 * 1024];
+    size_t used = 0;
+};
 }
 
 bool SceneSerializer::Save(const std::string& path, const SceneSnapshot& snapshot)
 {
-    json j;
-    j["light"] = {
-        {"direction", glmVec3ToJson(snapshot.light.direction)},
-        {"ambient", glmVec3ToJson(snapshot.light.ambient)},
-        {"diffuse", glmVec3ToJson(snapshot.light.diffuse)},
-        {"specular", glmVec3ToJson(snapshot.light.specular)},
-        {"intensity", snapshot.light.intensity}
-    };
-
-    j["environment"] = {
-        {"skyColor", glmVec3ToJson(snapshot.environment.skyColor)},
-        {"ambientBoost", snapshot.environment.ambientBoost}
-    };
-
-    json modelsJson = json::array();
-    for (const auto& model : snapshot.models) {
-        modelsJson.push_back({
-            {"path", model.path},
-            {"position", glmVec3ToJson(model.position)},
-            {"rotation", glmVec3ToJson(model.rotation)},
-            {"scale", glmVec3ToJson(model.scale)}
-        });
-    }
-    j["models"] = modelsJson;
-
+    // Écrite à côté puis renommée : une sauvegarde interrompue laisse la map précédente intacte
+    const std::string tmp = AtomicFile::TempPath(path);
     std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-    std::ofstream out(path);
-    if (!out) return false;
-    out << j.dump(4);
-    return true;
+    const bool written = BinaryMap::IsBinaryPath(path) ? BinaryMap::Save(tmp, snapshot, compressBinary)
+                                                       : writeJson(tmp, snapshot);
+    if (!written) {
+        std::filesystem::remove(tmp);
+        return false;
+    }
+    return AtomicFile::Replace(tmp, path);
 }
 
-std::optional<SceneSnapshot> SceneSerializer::Load(const std::string& path)
+bool SceneSerializer::writeJson(const std::string& path, const SceneSnapshot& snapshot)
 {
-    std::ifstream in(path);
-    if (!in) return std::nullopt;
-    json j;
-    in >> j;
+    PROFILE_ZONE_CAT("SceneSerializer::Save", "io");
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
 
-    SceneSnapshot snapshot;
-    if (auto lightIt = j.find("light"); lightIt != j.end()) {
-        snapshot.light.direction = jsonToVec3((*lightIt)["direction"], snapshot.light.direction);
-        snapshot.light.ambient = jsonToVec3((*lightIt)["ambient"], snapshot.light.ambient);
-        snapshot.light.diffuse = jsonToVec3((*lightIt)["diffuse"], snapshot.light.diffuse);
-        snapshot.light.specular = jsonToVec3((*lightIt)["specular"], snapshot.light.specular);
-        snapshot.light.intensity = (*lightIt).value("intensity", snapshot.light.intensity);
-    }
-
-    if (auto envIt = j.find("environment"); envIt != j.end()) {
-        snapshot.environment.skyColor = jsonToVec3((*envIt)["skyColor"], snapshot.environment.skyColor);
-        snapshot.environment.ambientBoost = (*envIt).value("ambientBoost", snapshot.environment.ambientBoost);
-    }
-
-    if (auto modelsIt = j.find("models"); modelsIt != j.end() && modelsIt->is_array()) {
-        for (const auto& elem : *modelsIt) {
-            ModelInstanceData data;
-            data.path = elem.value("path", "");
-            data.position = jsonToVec3(elem["position"], data.position);
-            data.rotation = jsonToVec3(elem["rotation"], data.rotation);
-            data.scale = jsonToVec3(elem["scale"], data.scale);
-            if (!data.path.empty()) snapshot.models.push_back(std::move(data));
+    // Même disposition que l'ancien dump(4) (clés triées), un vecteur par ligne
+    {
+        MapJsonWriter writer(out);
+        writer.raw("{\n    \"environment\": {\n        \"ambientBoost\": ");
+        writer.number(snapshot.environment.ambientBoost);
+        writer.raw(",\n        \"skyColor\": ");
+        writer.vec3(snapshot.environment.skyColor);
+        writer.raw("\n    },\n    \"light\": {\n        \"ambient\": ");
+        writer.vec3(snapshot.light.ambient);
+        writer.raw(",\n        \"diffuse\": ");
+        writer.vec3(snapshot.light.diffuse);
+        writer.raw(",\n        \"direction\": ");
+        writer.vec3(snapshot.light.direction);
+        writer.raw(",\n        \"intensity\": ");
+        writer.number(snapshot.light.intensity);
+        writer.raw(",\n        \"specular\": ");
+        writer.vec3(snapshot.light.specular);
+        writer.raw("\n    },\n    \"models\": [");
+
+        for (size_t i = 0; i < snapshot.models.size(); ++i) {
+            const ModelInstanceData &model = snapshot.models[i];
+            writer.raw(i == 0 ? "\n        {\n            \"path\": " : ",\n        {\n            \"path\": ");
+            writer.string(model.path);
+            writer.raw(",\n            \"position\": ");
+            writer.vec3(model.position);
+            writer.raw(",\n            \"rotation\": ");
+            writer.vec3(model.rotation);
+            writer.raw(",\n            \"scale\": ");
+            writer.vec3(model.scale);
+            writer.raw("\n        }");
         }
+        writer.raw(snapshot.models.empty() ? "]\n}" : "\n    ]\n}");
     }
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+std::optional<SceneSnapshot> SceneSerializer::Load(const std::string& path)
+{
+    if (BinaryMap::IsBinaryPath(path)) return BinaryMap::Load(path);
+
+    PROFILE_ZONE_CAT("SceneSerializer::Load", "io");
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() == 0) return std::nullopt;
+    file.adviseSequential();
 
+    SceneSnapshot snapshot;
+    MapSaxReader reader(snapshot);
+    const char *begin = reinterpret_cast<const char *>(file.data());
+    if (!json::sax_parse(begin, begin + file.size(), &reader)) return std::nullopt;
     return snapshot;
 }
+
+bool SceneSerializer::IsMapFile(const std::string& path)
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".json" || ext == BinaryMap::Extension;
+}
+
+std::string SceneSerializer::WithMapExtension(const std::string& name)
+{
+    if (IsMapFile(name)) return name;
+    std::filesystem::path p = name;
+    p.replace_extension(".json");
+    return p.string();
+}
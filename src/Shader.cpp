@@ -1,6 +1,7 @@
 #include "Shader.h"
+#include "ShaderCache.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines)
 {
     // 1. Retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
@@ -34,41 +35,55 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
     }
     
+    vertexCode = injectDefines(vertexCode, defines);
+    fragmentCode = injectDefines(fragmentCode, defines);
+
+    // 2. Try the program binary cache before compiling anything
+    const std::string cacheKey = ShaderCache::MakeKey(vertexCode, fragmentCode, defines);
+    program = GlProgram(ShaderCache::Load(cacheKey));
+    ID = program.get();
+    if (ID) {
+        valid = true;
+        return;
+    }
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
     
-    // 2. Compile shaders
+    // 3. Compile shaders
     unsigned int vertex, fragment;
-    int success;
-    char infoLog[512];
     
     // Vertex shader
     vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vShaderCode, NULL);
     glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    bool compiled = checkCompileErrors(vertex, "VERTEX");
     
     // Fragment shader
     fragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragment, 1, &fShaderCode, NULL);
     glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+    compiled = checkCompileErrors(fragment, "FRAGMENT") && compiled;
     
     // Shader Program
-    ID = glCreateProgram();
+    program = GlProgram::Create();
+    ID = program.get();
+    if (ShaderCache::IsSupported()) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    bool linked = checkCompileErrors(ID, "PROGRAM");
     
     // Delete the shaders as they're linked into our program now and no longer necessary
     glDeleteShader(vertex);
     glDeleteShader(fragment);
-}
 
-Shader::~Shader()
-{
-    glDeleteProgram(ID);
+    valid = compiled && linked;
+    if (valid) {
+        ShaderCache::Store(cacheKey, ID);
+    }
 }
 
 void Shader::use()
@@ -136,7 +151,21 @@ void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
     glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type)
+std::string Shader::injectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+    if (defines.empty()) return source;
+    std::string block;
+    for (const auto& def : defines) block += "#define " + def + "\n";
+
+    // #version doit rester la première directive du shader
+    size_t pos = source.find("#version");
+    if (pos == std::string::npos) return block + source;
+    size_t eol = source.find('\n', pos);
+    if (eol == std::string::npos) return source + "\n" + block;
+    return source.substr(0, eol + 1) + block + source.substr(eol + 1);
+}
+
+bool Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -153,4 +182,5 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
+    return success != 0;
 }
@@ -0,0 +1,166 @@
+#include "ShaderCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+std::string ShaderCache::directory = "cache/shaders";
+ComponentLogger ShaderCache::logger("Shader");
+
+namespace {
+const char kMagic[4] = {'S', 'B', 'P', 'C'};
+const uint32_t kFileVersion = 1;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+    uint32_t identityLength;
+};
+
+uint64_t fnv1a(uint64_t hash, const std::string& data)
+{
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    // Séparateur pour que ("ab","c") et ("a","bc") donnent des clés différentes
+    hash ^= 0xFF;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+std::string glString(GLenum name)
+{
+    const GLubyte* s = glGetString(name);
+    return s ? reinterpret_cast<const char*>(s) : "";
+}
+}
+
+bool ShaderCache::IsSupported()
+{
+    static int supported = -1;
+    if (supported < 0) {
+        GLint formats = 0;
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        supported = formats > 0 ? 1 : 0;
+        logger.info(supported ? "Cache de programmes binaires actif (" + std::to_string(formats) + " formats)"
+                              : std::string("Cache de programmes binaires indisponible sur ce driver"));
+    }
+    return supported == 1;
+}
+
+std::string ShaderCache::driverIdentity()
+{
+    return glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+}
+
+std::string ShaderCache::MakeKey(const std::string& vertexSource,
+                                 const std::string& fragmentSource,
+                                 const std::vector<std::string>& defines)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = fnv1a(hash, vertexSource);
+    hash = fnv1a(hash, fragmentSource);
+    for (const auto& def : defines) hash = fnv1a(hash, def);
+    hash = fnv1a(hash, driverIdentity());
+
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+std::string ShaderCache::pathFor(const std::string& key)
+{
+    return (std::filesystem::path(directory) / (key + ".bin")).string();
+}
+
+GLuint ShaderCache::Load(const std::string& key)
+{
+    if (!IsSupported()) return 0;
+
+    const std::string path = pathFor(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+
+    CacheHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFileVersion) {
+        logger.error("Entree de cache invalide: " + path);
+        return 0;
+    }
+
+    std::string identity(header.identityLength, '\0');
+    in.read(&identity[0], header.identityLength);
+    if (!in || identity != driverIdentity()) {
+        logger.info("Entree de cache d'un autre driver ignoree: " + path);
+        return 0;
+    }
+
+    std::vector<char> binary(header.binaryLength);
+    in.read(binary.data(), binary.size());
+    if (!in) {
+        logger.error("Entree de cache tronquee: " + path);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        // Le driver refuse le binaire (mise à jour, format retiré...) : on recompilera
+        logger.info("Binaire refuse par le driver, recompilation: " + path);
+        glDeleteProgram(program);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    }
+
+    logger.debug("Programme charge depuis le cache: " + path);
+    return program;
+}
+
+void ShaderCache::Store(const std::string& key, GLuint program)
+{
+    if (!IsSupported() || !program) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        logger.error("glGetProgramBinary n'a rien renvoye");
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    const std::string path = pathFor(key);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        logger.error("Impossible d'ecrire le cache: " + path);
+        return;
+    }
+
+    const std::string identity = driverIdentity();
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFileVersion;
+    header.binaryFormat = format;
+    header.binaryLength = static_cast<uint32_t>(written);
+    header.identityLength = static_cast<uint32_t>(identity.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(identity.data(), identity.size());
+    out.write(binary.data(), written);
+    logger.info("Programme mis en cache: " + path + " (" + std::to_string(written) + " octets)");
+}
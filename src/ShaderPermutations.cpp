@@ -0,0 +1,85 @@
+#include "ShaderPermutations.h"
+#include "Profiler.h"
+
+ComponentLogger ShaderPermutations::logger("Shader");
+
+ShaderPermutations::ShaderPermutations(const std::string& vs, const std::string& fs)
+    : vertexPath(vs), fragmentPath(fs)
+{
+}
+
+std::vector<std::string> ShaderPermutations::DefinesFor(unsigned int features)
+{
+    std::vector<std::string> defines;
+    if (features & ShaderFeature::Diffuse)    defines.push_back("HAS_DIFFUSE");
+    if (features & ShaderFeature::Specular)   defines.push_back("HAS_SPECULAR");
+    if (features & ShaderFeature::NormalMap)  defines.push_back("HAS_NORMAL_MAP");
+    if (features & ShaderFeature::Instancing) defines.push_back("USE_INSTANCING");
+    if (features & ShaderFeature::Highlight)  defines.push_back("HAS_HIGHLIGHT");
+    if (features & ShaderFeature::Alpha)      defines.push_back("HAS_ALPHA");
+    return defines;
+}
+
+Shader& ShaderPermutations::get(unsigned int features)
+{
+    auto it = variants.find(features);
+    if (it == variants.end()) {
+        std::vector<std::string> defines = DefinesFor(features);
+        std::string list;
+        for (const auto& def : defines) list += (list.empty() ? "" : " ") + def;
+        logger.info("Nouvelle variante [" + (list.empty() ? std::string("base") : list) + "] pour " + fragmentPath);
+
+        Variant variant;
+        variant.shader = compile(features);
+        it = variants.emplace(features, std::move(variant)).first;
+    }
+
+    Variant& variant = it->second;
+    variant.shader->use();
+    if (variant.frame != frameIndex) {
+        variant.frame = frameIndex;
+        if (frameSetup) frameSetup(*variant.shader);
+    }
+    return *variant.shader;
+}
+
+std::unique_ptr<Shader> ShaderPermutations::compile(unsigned int features) const
+{
+    PROFILE_ZONE_CAT("Shader compile", "gpu-upload");
+    auto shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), DefinesFor(features));
+
+    // Les unités de texture sont fixes par type : on les assigne une fois pour toutes
+    shader->use();
+    if (features & ShaderFeature::Diffuse)   shader->setInt("material.texture_diffuse1", 0);
+    if (features & ShaderFeature::Specular)  shader->setInt("material.texture_specular1", 1);
+    if (features & ShaderFeature::NormalMap) shader->setInt("material.texture_normal1", 2);
+    return shader;
+}
+
+bool ShaderPermutations::reload()
+{
+    // Tout est compilé avant d'échanger : une faute de frappe dans le GLSL garde l'ancien rendu
+    std::map<unsigned int, std::unique_ptr<Shader>> rebuilt;
+    for (const auto& entry : variants) {
+        auto shader = compile(entry.first);
+        if (!shader->isValid()) {
+            logger.error("Rechargement annule, variante invalide pour " + vertexPath + " / " + fragmentPath);
+            return false;
+        }
+        rebuilt.emplace(entry.first, std::move(shader));
+    }
+
+    for (auto& entry : rebuilt) {
+        Variant& variant = variants[entry.first];
+        variant.shader = std::move(entry.second);
+        variant.frame = 0;  // les uniforms de frame seront renvoyés à la prochaine utilisation
+    }
+    logger.info("Shaders recharges: " + std::to_string(rebuilt.size()) + " variantes de " + fragmentPath);
+    return true;
+}
+
+void ShaderPermutations::beginFrame(FrameSetup setup)
+{
+    frameSetup = std::move(setup);
+    ++frameIndex;
+}
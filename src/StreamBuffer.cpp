@@ -0,0 +1,140 @@
+#include "StreamBuffer.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
+
+std::vector<StreamBuffer*> StreamBuffer::instances;
+size_t StreamBuffer::frameBytes = 0;
+size_t StreamBuffer::lastFrameBytes = 0;
+ComponentLogger StreamBuffer::logger("Render");
+
+StreamBuffer::StreamBuffer(GLenum target, size_t bytesPerFrame)
+    : bindTarget(target), regionSize(bytesPerFrame)
+{
+    const size_t total = regionSize * FrameCount;
+    persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+    buffer = GlBuffer::Create();
+    glBindBuffer(bindTarget, buffer.get());
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(bindTarget, total, nullptr, flags);
+        persistentPtr = static_cast<unsigned char*>(glMapBufferRange(bindTarget, 0, total, flags));
+        if (!persistentPtr) {
+            logger.error("Mapping persistant impossible, repli sur glMapBufferRange");
+            // Un stockage immuable ne peut pas être réalloué : nouveau buffer
+            buffer = GlBuffer::Create();
+            glBindBuffer(bindTarget, buffer.get());
+            persistent = false;
+        }
+    }
+    if (!persistent) {
+        glBufferData(bindTarget, total, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(bindTarget, 0);
+    MemoryTracker::TrackBuffer(buffer.get(), MemoryKind::StreamBuffer, total, "StreamBuffer");
+
+    logger.info(std::string("StreamBuffer cree: ") + std::to_string(FrameCount) + "x" + std::to_string(regionSize) +
+                " octets (" + (persistent ? "persistant/coherent" : "glMapBufferRange non synchronise") + ")");
+    instances.push_back(this);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (buffer) {
+        if (persistentPtr) {
+            glBindBuffer(bindTarget, buffer.get());
+            glUnmapBuffer(bindTarget);
+            glBindBuffer(bindTarget, 0);
+        }
+        buffer.reset();
+    }
+}
+
+void StreamBuffer::waitRegion()
+{
+    GLsync& fence = fences[region];
+    if (fence) {
+        GLenum res = glClientWaitSync(fence, 0, 0);
+        if (res == GL_TIMEOUT_EXPIRED) {
+            // Le GPU a plus de FrameCount-1 frames de retard : on attend par tranches d'1 ms
+            logger.debug("Attente GPU sur la region " + std::to_string(region));
+            do {
+                res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (res == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    regionReady = true;
+}
+
+void* StreamBuffer::map(size_t size, size_t alignment, GLintptr& outOffset)
+{
+    if (mapped) unmap();
+    if (!regionReady) waitRegion();
+
+    if (alignment > 1) {
+        regionOffset = (regionOffset + alignment - 1) / alignment * alignment;
+    }
+    if (size == 0 || regionOffset + size > regionSize) {
+        logger.error("StreamBuffer plein: " + std::to_string(size) + " octets demandes, " +
+                     std::to_string(regionSize - std::min(regionOffset, regionSize)) + " disponibles");
+        return nullptr;
+    }
+
+    const size_t offset = static_cast<size_t>(region) * regionSize + regionOffset;
+    void* ptr = nullptr;
+    if (persistent) {
+        ptr = persistentPtr + offset;
+    } else {
+        glBindBuffer(bindTarget, buffer.get());
+        ptr = glMapBufferRange(bindTarget, offset, size,
+                               GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!ptr) {
+            glBindBuffer(bindTarget, 0);
+            logger.error("glMapBufferRange a echoue");
+            return nullptr;
+        }
+        mapped = true;
+    }
+
+    outOffset = static_cast<GLintptr>(offset);
+    regionOffset += size;
+    frameBytes += size;
+    return ptr;
+}
+
+void StreamBuffer::unmap()
+{
+    if (!mapped) return;
+    glBindBuffer(bindTarget, buffer.get());
+    glUnmapBuffer(bindTarget);
+    glBindBuffer(bindTarget, 0);
+    mapped = false;
+}
+
+void StreamBuffer::endFrame()
+{
+    unmap();
+    if (regionOffset > 0) {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    region = (region + 1) % FrameCount;
+    regionOffset = 0;
+    regionReady = false;
+}
+
+void StreamBuffer::EndFrameAll()
+{
+    for (StreamBuffer* sb : instances) {
+        sb->endFrame();
+    }
+    lastFrameBytes = frameBytes;
+    frameBytes = 0;
+}
@@ -1,11 +1,43 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "Texture.h"
 #include "stb_image.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "TextureResidency.h"
+#include "UploadScheduler.h"
+#include "ContentHash.h"
 #include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 
-std::map<std::string, GLuint> Texture2D::cache;
+std::map<std::string, std::shared_ptr<GlTexture>> Texture2D::cache;
 ComponentLogger Texture2D::logger("Texture");
+bool Texture2D::streaming = true;
+std::map<uint64_t, std::string> Texture2D::contents;
+std::map<std::string, uint64_t> Texture2D::contentOf;
+size_t Texture2D::sharedBytes = 0;
+Texture2D::RelinkHandler Texture2D::relinkHandler;
+
+namespace {
+size_t estimateGpuBytes(const Texture2D::Image &image)
+{
+    // RGB est stocké sur 4 octets par la plupart des drivers ; la chaîne de mipmaps ajoute un tiers
+    const size_t bytesPerPixel = image.channels == 3 ? 4 : static_cast<size_t>(image.channels);
+    return static_cast<size_t>(image.width) * image.height * bytesPerPixel * 4 / 3;
+}
+
+// Fichier sur disque : empreinte des octets encodés, plus rapide que celle des pixels ;
+// image intégrée : empreinte des pixels et des dimensions
+uint64_t contentHash(const std::string &fullPath, const Texture2D::Image &image)
+{
+    uint64_t hash = 0;
+    if (ContentHash::HashFile(fullPath, hash, 1)) return hash;
+    const int dims[3] = {image.width, image.height, image.channels};
+    return ContentHash::Hash(image.pixels.get(), static_cast<size_t>(image.width) * image.height * image.channels,
+                             ContentHash::Hash(dims, sizeof(dims)));
+}
+}
 
 GLuint Texture2D::Load(const std::string &fullPath, bool flipY, Format fmt)
 {
@@ -17,53 +49,315 @@ GLuint Texture2D::Load(const std::string &fullPath, bool flipY, Format fmt)
     auto it = cache.find(fullPath);
     if (it != cache.end()) {
         logger.debug(std::string("Cache hit: ") + fullPath);
-        return it->second;
+        return it->second->get();
+    }
+
+    if (streaming) {
+        // Un fichier absent doit rester sans texture, comme avec un décodage synchrone
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(fullPath, ec)) {
+            logger.error("Texture introuvable: " + fullPath);
+            return 0;
+        }
+
+        Image texel;
+        texel.width = texel.height = 1;
+        texel.channels = 4;
+        texel.pixels.reset(new unsigned char[4]{128, 128, 128, 255}, std::default_delete<unsigned char[]>());
+
+        auto texture = std::make_shared<GlTexture>(GlTexture::Create());
+        GLuint id = texture->get();
+        if (!upload(texture, texel)) return 0;
+        cache[fullPath] = texture;
+        MemoryTracker::TrackTexture(id, estimateGpuBytes(texel), fullPath);
+        // Empreinte calculée avec le décodage, hors du thread GL : voir ShareStreamed
+        TextureResidency::Stream(fullPath, id, flipY);
+        logger.info("Texture en diffusion: " + fullPath);
+        return id;
+    }
+
+    // Même fichier copié dans plusieurs dossiers : une seule texture GPU. Le sens de lecture
+    // entre dans l'empreinte, une image retournée n'est pas la même texture.
+    uint64_t hash = 0;
+    const bool hashed = ContentHash::HashFile(fullPath, hash, flipY ? 1 : 0);
+    if (hashed) {
+        int w = 0, h = 0, c = 0;
+        Image header;
+        if (stbi_info(fullPath.c_str(), &w, &h, &c)) {
+            header.width = w;
+            header.height = h;
+            header.channels = c;
+        }
+        if (GLuint id = shareIdentical(fullPath, hash, estimateGpuBytes(header))) return id;
+    }
+
+    Image image = Decode(fullPath, flipY);
+    if (!image.valid()) return 0;
+    GLuint id = create(fullPath, image);
+    if (id && hashed) rememberContent(fullPath, hash);
+    return id;
+}
+
+Texture2D::Image Texture2D::Decode(const std::string &fullPath, bool flipY)
+{
+    PROFILE_ZONE_CAT("Texture decode", "import");
+    Image image;
+    if (fullPath.empty()) {
+        logger.error("Chemin vide pour la texture");
+        return image;
     }
 
-    stbi_set_flip_vertically_on_load(flipY);
-    int w=0,h=0,n=0;
-    unsigned char *data = stbi_load(fullPath.c_str(), &w, &h, &n, 0);
+    // Variante par thread : plusieurs imports peuvent décoder en parallèle
+    stbi_set_flip_vertically_on_load_thread(flipY);
+    unsigned char *data = stbi_load(fullPath.c_str(), &image.width, &image.height, &image.channels, 0);
     if (!data) {
         logger.error(std::string("stbi_load a échoué: ") + fullPath + " | " + (stbi_failure_reason()?stbi_failure_reason():""));
-        return 0;
+        return image;
     }
+    adopt(image, data, fullPath);
+    return image;
+}
 
-    GLenum internalFormat = GL_RGB;
-    GLenum format = GL_RGB;
-    if (n == 1) { internalFormat = format = GL_RED; }
-    else if (n == 3) { internalFormat = format = GL_RGB; }
-    else if (n == 4) { internalFormat = format = GL_RGBA; }
+Texture2D::Image Texture2D::DecodeMemory(const std::string &key, const unsigned char *bytes, size_t size, bool flipY)
+{
+    PROFILE_ZONE_CAT("Texture decode", "import");
+    Image image;
+    stbi_set_flip_vertically_on_load_thread(flipY);
+    unsigned char *data = stbi_load_from_memory(bytes, static_cast<int>(size), &image.width, &image.height, &image.channels, 0);
+    if (!data) {
+        logger.error(std::string("stbi_load_from_memory a échoué: ") + key + " | " + (stbi_failure_reason()?stbi_failure_reason():""));
+        return image;
+    }
+    adopt(image, data, key);
+    image.encoded = std::make_shared<const std::vector<unsigned char>>(bytes, bytes + size);
+    return image;
+}
 
-    GLuint id = 0;
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+void Texture2D::adopt(Image &image, unsigned char *data, const std::string &owner)
+{
+    // Pixels comptés comme données CPU tant qu'une copie de l'image est vivante
+    const size_t bytes = static_cast<size_t>(image.width) * image.height * image.channels;
+    MemoryTracker::SetCpu(owner, MemoryKind::CpuTexture, bytes);
+    image.pixels.reset(data, [owner](unsigned char *pixels) {
+        stbi_image_free(pixels);
+        MemoryTracker::SetCpu(owner, MemoryKind::CpuTexture, 0);
+    });
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+std::vector<std::string> Texture2D::CachedPaths()
+{
+    std::vector<std::string> paths;
+    paths.reserve(cache.size());
+    for (const auto &p : cache) paths.push_back(p.first);
+    return paths;
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+std::shared_ptr<GlTexture> Texture2D::Find(const std::string &fullPath)
+{
+    auto it = cache.find(fullPath);
+    return it != cache.end() ? it->second : nullptr;
+}
 
-    stbi_image_free(data);
+std::shared_ptr<GlTexture> Texture2D::CreateUncached(const Image &image, const std::string &owner)
+{
+    auto texture = std::make_shared<GlTexture>(GlTexture::Create());
+    if (!upload(texture, image)) return nullptr;
+    MemoryTracker::TrackTexture(texture->get(), estimateGpuBytes(image), owner);
+    return texture;
+}
 
-    GLenum err = glGetError();
-    if (err != GL_NO_ERROR) {
-        logger.error("OpenGL erreur lors de la creation texture: code=" + std::to_string(err));
-        glDeleteTextures(1, &id);
-        return 0;
+GLuint Texture2D::Store(const std::string &fullPath, const Image &image)
+{
+    if (!image.valid()) return 0;
+
+    auto it = cache.find(fullPath);
+    if (it != cache.end()) {
+        GLuint id = it->second->get();
+        // Autre fichier lié à la même texture : il n'a pas changé et doit la garder telle quelle
+        std::string heir;
+        for (const auto &entry : cache) {
+            if (entry.first != fullPath && entry.second == it->second) {
+                heir = entry.first;
+                break;
+            }
+        }
+        // Le contenu change : les prochains fichiers identiques à l'ancien ne doivent plus s'y lier,
+        // ou se lient à celle de l'héritier
+        auto known = contentOf.find(fullPath);
+        if (known != contentOf.end()) {
+            auto owner = contents.find(known->second);
+            if (owner != contents.end() && owner->second == fullPath) {
+                if (heir.empty()) {
+                    contents.erase(owner);
+                } else {
+                    owner->second = heir;
+                    TextureResidency::Rename(id, heir);
+                }
+            }
+            contentOf.erase(known);
+        }
+        if (heir.empty()) {
+            if (!Replace(fullPath, image)) return 0;
+            rememberContent(fullPath, contentHash(fullPath, image));
+            TextureResidency::Register(fullPath, id, image);
+            logger.info("Texture rechargee: " + fullPath + " (" + std::to_string(image.width) + "x" + std::to_string(image.height) + ")");
+            return id;
+        }
+        // Texture partagée : ce chemin en reçoit une nouvelle, ses utilisateurs sont à relier
+        // (identifiant différent). L'économie comptée au partage est estimée sur la nouvelle image.
+        cache.erase(it);
+        sharedBytes -= std::min(sharedBytes, estimateGpuBytes(image));
+        logger.info("Texture partagee modifiee, separee de " + heir + ": " + fullPath);
+        const GLuint separated = storeNew(fullPath, image);
+        if (separated) relink(fullPath, separated);
+        return separated;
     }
+    return storeNew(fullPath, image);
+}
+
+GLuint Texture2D::storeNew(const std::string &fullPath, const Image &image)
+{
+    const uint64_t hash = contentHash(fullPath, image);
+    if (GLuint id = shareIdentical(fullPath, hash, estimateGpuBytes(image))) return id;
 
-    cache[fullPath] = id;
-    logger.info("Texture chargée: " + fullPath + " (" + std::to_string(w) + "x" + std::to_string(h) + ", channels=" + std::to_string(n) + ")");
+    GLuint id = create(fullPath, image);
+    if (id) rememberContent(fullPath, hash);
     return id;
 }
 
-void Texture2D::ClearCache()
+bool Texture2D::ShareStreamed(const std::string &fullPath, uint64_t hash, const Image &image)
+{
+    auto it = cache.find(fullPath);
+    if (it == cache.end()) return false;
+    // Le texel provisoire quitte le cache le temps de chercher un fichier identique
+    const std::shared_ptr<GlTexture> placeholder = it->second;
+    cache.erase(it);
+    if (GLuint id = shareIdentical(fullPath, hash, estimateGpuBytes(image))) {
+        relink(fullPath, id);
+        return true;
+    }
+    cache[fullPath] = placeholder;
+    rememberContent(fullPath, hash);
+    return false;
+}
+
+void Texture2D::relink(const std::string &fullPath, GLuint id)
+{
+    if (relinkHandler) relinkHandler(fullPath, id);
+}
+
+GLuint Texture2D::create(const std::string &fullPath, const Image &image)
+{
+    // Nouvelle texture diffusée : seul un petit niveau part maintenant, la suite suit par frames
+    const int level = streaming ? TextureResidency::InitialLevel(image.width, image.height) : 0;
+    const Image first = level > 0 ? Downscale(image, level) : image;
+
+    auto texture = std::make_shared<GlTexture>(GlTexture::Create());
+    GLuint id = texture->get();
+    if (!upload(texture, first)) return 0;
+
+    cache[fullPath] = texture;
+    MemoryTracker::TrackTexture(id, estimateGpuBytes(first), fullPath);
+    TextureResidency::Register(fullPath, id, image, level);
+    logger.info("Texture chargée: " + fullPath + " (" + std::to_string(image.width) + "x" + std::to_string(image.height) + ", channels=" + std::to_string(image.channels) + ")");
+    return id;
+}
+
+GLuint Texture2D::shareIdentical(const std::string &fullPath, uint64_t hash, size_t gpuBytes)
+{
+    auto known = contents.find(hash);
+    if (known == contents.end()) return 0;
+    auto shared = cache.find(known->second);
+    if (shared == cache.end()) return 0;
+
+    cache[fullPath] = shared->second;
+    contentOf[fullPath] = hash;
+    sharedBytes += gpuBytes;
+    logger.info("Texture identique a " + known->second + ", partagee: " + fullPath + " (" +
+                std::to_string(gpuBytes / 1024) + " Ko evites, total " + std::to_string(sharedBytes / 1024) + " Ko)");
+    return shared->second->get();
+}
+
+void Texture2D::rememberContent(const std::string &fullPath, uint64_t hash)
+{
+    contents.emplace(hash, fullPath);
+    contentOf[fullPath] = hash;
+}
+
+bool Texture2D::Replace(const std::string &fullPath, const Image &image)
+{
+    auto it = cache.find(fullPath);
+    if (it == cache.end() || !image.valid()) return false;
+    GLuint id = it->second->get();
+    if (!upload(it->second, image)) return false;
+    MemoryTracker::TrackTexture(id, estimateGpuBytes(image), fullPath);
+    return true;
+}
+
+Texture2D::Image Texture2D::Downscale(const Image &image, int levels)
 {
-    for (auto &p : cache) {
-        if (p.second) glDeleteTextures(1, &p.second);
+    if (!image.valid() || levels <= 0) return image;
+
+    const int c = image.channels;
+    int w = image.width, h = image.height;
+    const unsigned char *src = image.pixels.get();
+    std::vector<unsigned char> current, next;
+    for (int l = 0; l < levels && (w > 1 || h > 1); ++l) {
+        const int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+        next.resize(static_cast<size_t>(nw) * nh * c);
+        for (int y = 0; y < nh; ++y) {
+            const int y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+            for (int x = 0; x < nw; ++x) {
+                const int x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+                for (int ch = 0; ch < c; ++ch) {
+                    const unsigned sum = src[(static_cast<size_t>(y0) * w + x0) * c + ch] + src[(static_cast<size_t>(y0) * w + x1) * c + ch]
+                                       + src[(static_cast<size_t>(y1) * w + x0) * c + ch] + src[(static_cast<size_t>(y1) * w + x1) * c + ch];
+                    next[(static_cast<size_t>(y) * nw + x) * c + ch] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        current.swap(next);
+        src = current.data();
+        w = nw;
+        h = nh;
     }
+
+    Image out;
+    out.width = w;
+    out.height = h;
+    out.channels = c;
+    out.pixels.reset(new unsigned char[current.size()], std::default_delete<unsigned char[]>());
+    std::memcpy(out.pixels.get(), current.data(), current.size());
+    return out;
+}
+
+bool Texture2D::upload(const std::shared_ptr<GlTexture> &texture, const Image &image)
+{
+    if (!texture || !image.valid()) return false;
+    GLenum internalFormat = GL_RGB;
+    GLenum format = GL_RGB;
+    if (image.channels == 1) { internalFormat = format = GL_RED; }
+    else if (image.channels == 3) { internalFormat = format = GL_RGB; }
+    else if (image.channels == 4) { internalFormat = format = GL_RGBA; }
+
+    glBindTexture(GL_TEXTURE_2D, texture->get());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Envoi et mipmaps faits par UploadScheduler dans le budget d'une frame suivante ;
+    // l'image reste en mémoire jusque-là
+    UploadScheduler::Instance().uploadTexture(texture, image.width, image.height, internalFormat, format, image.pixels);
+    return true;
+}
+
+void Texture2D::ClearCache()
+{
+    // Les textures encore référencées par un modèle survivent ; les autres partent dans la
+    // file de suppression de GpuResources
     cache.clear();
+    contents.clear();
+    contentOf.clear();
+    TextureResidency::Clear();
 }
@@ -0,0 +1,356 @@
+#include "TextureResidency.h"
+#include "ContentHash.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+std::unordered_map<GLuint, TextureResidency::Entry> TextureResidency::entries;
+std::vector<TextureResidency::ReadyLevel> TextureResidency::ready;
+size_t TextureResidency::budget = 1024u * 1024u * 1024u;
+size_t TextureResidency::uploadBudget = 16u * 1024u * 1024u;
+uint64_t TextureResidency::frame = 0;
+ComponentLogger TextureResidency::logger("Residency");
+
+namespace {
+// Plus grand côté minimal d'une texture rétrogradée ; en dessous on passe à l'éviction
+const int kMinDemotedSize = 64;
+// Décodages lancés en parallèle par le gestionnaire
+const int kMaxInFlight = 4;
+// Les remontées de résolution s'arrêtent sous le budget pour ne pas osciller autour de la limite
+const double kPromoteHeadroom = 0.9;
+// Texels voulus par pixel projeté : les textures répétées sur l'objet en demandent plus
+const float kTexelsPerPixel = 2.0f;
+// Aucune demande de décodage en cours
+const int kNoPending = -2;
+// Plus grand côté de la première image envoyée d'une texture diffusée
+const int kInitialSize = 32;
+
+size_t imageBytes(const Texture2D::Image& image)
+{
+    return static_cast<size_t>(image.width) * image.height * image.channels;
+}
+}
+
+int TextureResidency::InitialLevel(int width, int height)
+{
+    int level = 0;
+    const int largest = std::max(width, height);
+    while ((largest >> level) > kInitialSize) ++level;
+    return level;
+}
+
+void TextureResidency::SetBudget(size_t bytes)
+{
+    budget = bytes;
+    logger.info("Budget textures: " + std::to_string(bytes / (1024 * 1024)) + " Mo");
+}
+
+void TextureResidency::Register(const std::string& fullPath, GLuint id, const Texture2D::Image& image, int uploadedLevel)
+{
+    if (!id || !image.valid()) return;
+
+    Entry& entry = entries[id];
+    entry.path = fullPath;
+    entry.width = image.width;
+    entry.height = image.height;
+    entry.channels = image.channels;
+    entry.level = uploadedLevel;
+    entry.pendingLevel = kNoPending;   // une nouvelle image remplace toute demande en vol
+    entry.sourceMissing = false;
+    entry.decoding = false;
+    entry.encoded = image.encoded;
+
+    entry.maxLevel = 0;
+    const int largest = std::max(image.width, image.height);
+    while ((largest >> (entry.maxLevel + 1)) >= kMinDemotedSize) ++entry.maxLevel;
+
+    // Couleur moyenne sur une grille d'échantillons, utilisée comme texel unique après éviction
+    const int samples = 16;
+    unsigned long sum[4] = {0, 0, 0, 0};
+    int count = 0;
+    for (int sy = 0; sy < samples; ++sy) {
+        const int y = sy * image.height / samples;
+        for (int sx = 0; sx < samples; ++sx) {
+            const int x = sx * image.width / samples;
+            const unsigned char* p = image.pixels.get() + (static_cast<size_t>(y) * image.width + x) * image.channels;
+            for (int c = 0; c < image.channels && c < 4; ++c) sum[c] += p[c];
+            ++count;
+        }
+    }
+    for (int c = 0; c < 4; ++c) {
+        if (image.channels == 1 && c < 3) entry.placeholder[c] = static_cast<unsigned char>(sum[0] / count);
+        else if (c < image.channels) entry.placeholder[c] = static_cast<unsigned char>(sum[c] / count);
+        else entry.placeholder[c] = 255;
+    }
+}
+
+void TextureResidency::Stream(const std::string& fullPath, GLuint id, bool flipY)
+{
+    if (!id) return;
+
+    Entry& entry = entries[id];
+    entry = Entry();
+    entry.path = fullPath;
+    entry.level = Evicted;             // texel provisoire en attendant le décodage
+    entry.decoding = true;
+    entry.flipY = flipY;
+
+    JobSystem::Instance().submit([id, fullPath, flipY]() {
+        // Empreinte calculée ici plutôt qu'au Load : le thread GL ne lit pas le fichier
+        uint64_t hash = 0;
+        const bool hashed = ContentHash::HashFile(fullPath, hash, flipY ? 1 : 0);
+        Texture2D::Image image = Texture2D::Decode(fullPath, flipY);
+        Texture2D::Image low;
+        if (image.valid()) low = Texture2D::Downscale(image, InitialLevel(image.width, image.height));
+        JobSystem::Instance().runOnMainThread([id, fullPath, hashed, hash, image, low]() {
+            auto it = entries.find(id);
+            if (it == entries.end() || it->second.path != fullPath || !it->second.decoding) return;
+            if (!image.valid()) {
+                it->second.decoding = false;
+                it->second.sourceMissing = true;
+                return;
+            }
+            // Fichier identique déjà en cache : le texel provisoire est abandonné
+            if (hashed && Texture2D::ShareStreamed(fullPath, hash, image)) {
+                entries.erase(it);
+                return;
+            }
+            // Petit niveau envoyé tout de suite : la texture est utilisable dès cette frame
+            if (!Texture2D::Replace(fullPath, low)) return;
+            Register(fullPath, id, image, InitialLevel(image.width, image.height));
+        });
+    });
+}
+
+void TextureResidency::Rename(GLuint id, const std::string& fullPath)
+{
+    auto it = entries.find(id);
+    if (it == entries.end()) return;
+    // Les niveaux en vol portent l'ancien chemin et seront ignorés : on peut en redemander
+    it->second.path = fullPath;
+    it->second.pendingLevel = kNoPending;
+}
+
+void TextureResidency::Clear()
+{
+    entries.clear();
+    ready.clear();
+}
+
+void TextureResidency::Touch(GLuint id, float screenPixels)
+{
+    auto it = entries.find(id);
+    if (it == entries.end()) return;
+    Entry& entry = it->second;
+    if (entry.lastUsed != frame) {
+        entry.lastUsed = frame;
+        entry.coverage = screenPixels;
+    } else {
+        entry.coverage = std::max(entry.coverage, screenPixels);
+    }
+}
+
+size_t TextureResidency::bytesAt(const Entry& entry, int level)
+{
+    // Même estimation que Texture2D::Store : RGB sur 4 octets, mipmaps comptées pour un tiers
+    const size_t bytesPerPixel = entry.channels == 3 ? 4 : static_cast<size_t>(entry.channels);
+    if (level == Evicted) return 4;
+    const size_t w = static_cast<size_t>(std::max(1, entry.width >> level));
+    const size_t h = static_cast<size_t>(std::max(1, entry.height >> level));
+    return w * h * bytesPerPixel * 4 / 3;
+}
+
+int TextureResidency::wantedLevel(const Entry& entry)
+{
+    const float needed = std::max(1.0f, entry.coverage * kTexelsPerPixel);
+    const int largest = std::max(entry.width, entry.height);
+    int level = 0;
+    while (level < entry.maxLevel && (largest >> (level + 1)) >= needed) ++level;
+    return level;
+}
+
+void TextureResidency::requestLevel(GLuint id, Entry& entry, int level)
+{
+    entry.pendingLevel = level;
+    const std::string path = entry.path;
+    const bool flipY = entry.flipY;
+    const auto encoded = entry.encoded;
+    // L'image complète n'est pas gardée en mémoire : chaque changement de niveau relit le fichier,
+    // ou les octets encodés d'une image intégrée (clé "<modèle>#image<N>", sans fichier)
+    JobSystem::Instance().submit([id, path, level, flipY, encoded]() {
+        Texture2D::Image image = encoded ? Texture2D::DecodeMemory(path, encoded->data(), encoded->size(), flipY)
+                                         : Texture2D::Decode(path, flipY);
+        if (image.valid() && level > 0) image = Texture2D::Downscale(image, level);
+        JobSystem::Instance().runOnMainThread([id, path, level, image]() {
+            finishLevel(id, path, level, image);
+        });
+    });
+}
+
+void TextureResidency::finishLevel(GLuint id, const std::string& path, int level, const Texture2D::Image& image)
+{
+    auto it = entries.find(id);
+    // Cache vidé, identifiant réutilisé ou demande remplacée entre-temps
+    if (it == entries.end() || it->second.path != path || it->second.pendingLevel != level) return;
+
+    Entry& entry = it->second;
+    if (!image.valid()) {
+        entry.pendingLevel = kNoPending;
+        entry.sourceMissing = true;
+        logger.error("Source illisible, texture figee a son niveau actuel: " + path);
+        return;
+    }
+    // Les niveaux réduits libèrent de la mémoire : envoyés sans attendre
+    if (entry.level != Evicted && level > entry.level) {
+        applyLevel(entry, level, image);
+        return;
+    }
+    ready.push_back(ReadyLevel{id, path, level, image});
+}
+
+void TextureResidency::applyLevel(Entry& entry, int level, const Texture2D::Image& image)
+{
+    entry.pendingLevel = kNoPending;
+    if (Texture2D::Replace(entry.path, image)) {
+        logger.debug("Texture " + entry.path + " -> niveau " + std::to_string(level));
+        entry.level = level;
+    }
+}
+
+void TextureResidency::uploadReady()
+{
+    if (ready.empty()) return;
+
+    // Les textures les plus grandes à l'écran d'abord
+    auto coverageOf = [](const ReadyLevel& r) {
+        auto it = entries.find(r.id);
+        return it != entries.end() ? it->second.coverage : 0.0f;
+    };
+    std::sort(ready.begin(), ready.end(), [&coverageOf](const ReadyLevel& a, const ReadyLevel& b) {
+        return coverageOf(a) > coverageOf(b);
+    });
+
+    size_t uploaded = 0;
+    size_t consumed = 0;
+    for (; consumed < ready.size(); ++consumed) {
+        const ReadyLevel& r = ready[consumed];
+        const size_t bytes = imageBytes(r.image);
+        if (consumed > 0 && uploaded + bytes > uploadBudget) break;
+
+        auto it = entries.find(r.id);
+        if (it == entries.end() || it->second.path != r.path || it->second.pendingLevel != r.level) continue;
+        applyLevel(it->second, r.level, r.image);
+        uploaded += bytes;
+    }
+    ready.erase(ready.begin(), ready.begin() + consumed);
+}
+
+void TextureResidency::evict(Entry& entry)
+{
+    Texture2D::Image texel;
+    texel.width = texel.height = 1;
+    texel.channels = 4;
+    texel.pixels.reset(new unsigned char[4], std::default_delete<unsigned char[]>());
+    std::memcpy(texel.pixels.get(), entry.placeholder, 4);
+    if (Texture2D::Replace(entry.path, texel)) {
+        logger.debug("Texture evincee: " + entry.path);
+        entry.level = Evicted;
+    }
+}
+
+void TextureResidency::Update()
+{
+    PROFILE_ZONE("Texture residency");
+
+    uploadReady();
+
+    size_t resident = 0;
+    int inFlight = 0;
+    std::vector<std::pair<GLuint, Entry*>> order;
+    order.reserve(entries.size());
+    for (auto& e : entries) {
+        // Les demandes en vol sont comptées à leur niveau cible pour ne pas rétrograder deux fois
+        const bool pending = e.second.pendingLevel != kNoPending;
+        resident += bytesAt(e.second, pending ? e.second.pendingLevel : e.second.level);
+        if (pending) ++inFlight;
+        if (e.second.decoding) continue;
+        order.emplace_back(e.first, &e.second);
+    }
+
+    if (resident > budget) {
+        // Les moins utiles d'abord : non dessinées depuis longtemps, puis les plus petites à l'écran
+        std::sort(order.begin(), order.end(), [](const std::pair<GLuint, Entry*>& a, const std::pair<GLuint, Entry*>& b) {
+            if (a.second->lastUsed != b.second->lastUsed) return a.second->lastUsed < b.second->lastUsed;
+            return a.second->coverage < b.second->coverage;
+        });
+
+        // 1. Retirer un niveau de mip à chaque candidate tant que le budget est dépassé
+        bool demotable = false;
+        for (auto& candidate : order) {
+            Entry& entry = *candidate.second;
+            if (entry.sourceMissing || entry.pendingLevel != kNoPending) continue;
+            if (entry.level == Evicted || entry.level >= entry.maxLevel) continue;
+            demotable = true;
+            if (resident <= budget || inFlight >= kMaxInFlight) break;
+            resident -= bytesAt(entry, entry.level) - bytesAt(entry, entry.level + 1);
+            requestLevel(candidate.first, entry, entry.level + 1);
+            ++inFlight;
+        }
+
+        // 2. Dernier recours : évincer ce qui n'a pas été dessiné à la dernière frame
+        if (!demotable) {
+            for (auto& candidate : order) {
+                if (resident <= budget) break;
+                Entry& entry = *candidate.second;
+                if (entry.sourceMissing || entry.pendingLevel != kNoPending || entry.level == Evicted) continue;
+                if (entry.lastUsed == frame) continue;
+                resident -= bytesAt(entry, entry.level) - bytesAt(entry, Evicted);
+                evict(entry);
+            }
+        }
+    } else if (resident < budget * kPromoteHeadroom && inFlight < kMaxInFlight) {
+        // Remonter les textures visibles, les plus grandes à l'écran d'abord
+        std::sort(order.begin(), order.end(), [](const std::pair<GLuint, Entry*>& a, const std::pair<GLuint, Entry*>& b) {
+            return a.second->coverage > b.second->coverage;
+        });
+        const size_t limit = static_cast<size_t>(budget * kPromoteHeadroom);
+        for (auto& candidate : order) {
+            if (inFlight >= kMaxInFlight) break;
+            Entry& entry = *candidate.second;
+            if (entry.lastUsed != frame || entry.sourceMissing || entry.pendingLevel != kNoPending) continue;
+
+            const int current = entry.level == Evicted ? entry.maxLevel + 1 : entry.level;
+            // Chaque montée redécode le fichier : on va directement au niveau voulu
+            int target = wantedLevel(entry);
+            const size_t currentBytes = bytesAt(entry, entry.level);
+            while (target < current && resident - currentBytes + bytesAt(entry, target) > limit) ++target;
+            if (target >= current) continue;
+
+            resident = resident - currentBytes + bytesAt(entry, target);
+            requestLevel(candidate.first, entry, target);
+            ++inFlight;
+        }
+    }
+
+    ++frame;
+}
+
+TextureResidency::Stats TextureResidency::GetStats()
+{
+    Stats stats;
+    stats.budget = budget;
+    stats.textures = entries.size();
+    for (const auto& e : entries) {
+        const Entry& entry = e.second;
+        stats.resident += bytesAt(entry, entry.level);
+        stats.full += bytesAt(entry, 0);
+        if (entry.level == Evicted) ++stats.evicted;
+        else if (entry.level > 0) ++stats.demoted;
+        if (entry.pendingLevel != kNoPending || entry.decoding) ++stats.loading;
+    }
+    stats.queuedUploads = ready.size();
+    return stats;
+}
@@ -0,0 +1,353 @@
+#include "ThumbnailRenderer.h"
+#include "ContentHash.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include "Model.h"
+#include "ModelManager.h"
+#include "Profiler.h"
+#include "ShaderPermutations.h"
+#include "Texture.h"
+#include "UploadScheduler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+std::string ThumbnailRenderer::directory = "cache/thumbnails";
+ComponentLogger ThumbnailRenderer::logger("Thumbnail");
+
+namespace {
+// Au-delà, la vignette est rendue même si des envois GPU restent en file (textures en diffusion)
+const uint64_t kMaxUploadWaitFrames = 120;
+const float kFieldOfView = 30.0f;
+// Vignettes prêtes non demandées depuis ce nombre de frames : texture libérée
+const uint64_t kEvictAfterFrames = 600;
+// Au-delà, les vignettes prêtes demandées le moins récemment sont libérées
+const size_t kMaxReadyThumbnails = 256;
+// Intervalle entre deux passes de libération
+const uint64_t kEvictInterval = 60;
+}
+
+ThumbnailRenderer::ThumbnailRenderer(ShaderPermutations &modelShaders)
+    : shaders(modelShaders)
+{
+}
+
+GLuint ThumbnailRenderer::modelThumbnail(const std::string &path)
+{
+    return request(path, false);
+}
+
+GLuint ThumbnailRenderer::mapThumbnail(const std::string &mapPath)
+{
+    return request(mapPath, true);
+}
+
+GLuint ThumbnailRenderer::request(const std::string &path, bool map)
+{
+    Slot &slot = slots[path];
+    slot.map = map;
+    slot.wanted = frame;
+    if (slot.state == State::Ready) return slot.texture.get();
+    if (slot.state == State::Idle) {
+        slot.state = State::Queued;
+        queue.push_back(path);
+    }
+    return 0;
+}
+
+void ThumbnailRenderer::captureMap(const std::string &mapPath, ModelManager &scene)
+{
+    pendingCapture.reset(new PendingCapture{mapPath, &scene, frame});
+}
+
+bool ThumbnailRenderer::uploadsSettled(uint64_t since) const
+{
+    if (frame <= since) return false;
+    return UploadScheduler::Instance().stats().queuedJobs == 0 || frame - since > kMaxUploadWaitFrames;
+}
+
+void ThumbnailRenderer::update()
+{
+    ++frame;
+    if (frame % kEvictInterval == 0) evictUnused();
+
+    if (pendingCapture && uploadsSettled(pendingCapture->since)) {
+        PROFILE_ZONE("Thumbnail capture");
+        const std::unique_ptr<PendingCapture> capture = std::move(pendingCapture);
+        glm::vec3 minBounds, maxBounds;
+        std::vector<unsigned char> pixels;
+        if (!capture->scene->sceneBounds(minBounds, maxBounds) ||
+            !render(minBounds, maxBounds, [&]() { capture->scene->drawAll(shaders); }, pixels)) {
+            return;
+        }
+        finish(capture->mapPath, pixels.data(), Size, Size, 4);
+        // La map vient d'être écrite ou lue : son empreinte désigne l'entrée du cache à remplacer
+        JobSystem::Instance().submitBackground([mapPath = capture->mapPath, pixels = std::move(pixels)]() {
+            uint64_t hash = 0;
+            if (ContentHash::HashFile(mapPath, hash)) WriteTga(CacheFile(hash), pixels, Size, Size);
+        });
+        return;
+    }
+
+    if (pendingRender && uploadsSettled(pendingRender->since)) {
+        PROFILE_ZONE("Thumbnail render");
+        const std::unique_ptr<PendingRender> job = std::move(pendingRender);
+        busy = false;
+        glm::vec3 minBounds, maxBounds;
+        job->model->getBounds(minBounds, maxBounds);
+        std::vector<unsigned char> pixels;
+        const glm::mat4 identity(1.0f);
+        if (!render(minBounds, maxBounds, [&]() { job->model->Draw(shaders, ShaderFeature::None, identity); }, pixels)) {
+            finish(job->path, nullptr, 0, 0, 0);
+            return;
+        }
+        finish(job->path, pixels.data(), Size, Size, 4);
+        JobSystem::Instance().submitBackground([file = job->cacheFile, pixels = std::move(pixels)]() { WriteTga(file, pixels, Size, Size); });
+        return;
+    }
+
+    if (busy) return;
+    // Les dernières demandes d'abord ; celles qui ne sont plus affichées quittent la file
+    while (!queue.empty()) {
+        const std::string path = queue.back();
+        queue.pop_back();
+        auto it = slots.find(path);
+        if (it == slots.end() || it->second.state != State::Queued) continue;
+        if (frame - it->second.wanted > 1) {
+            it->second.state = State::Idle;
+            continue;
+        }
+        start(path, it->second.map);
+        break;
+    }
+}
+
+void ThumbnailRenderer::start(const std::string &path, bool map)
+{
+    busy = true;
+    slots[path].state = State::Loading;
+
+    JobSystem::Instance().submitBackground([this, path, map]() {
+        uint64_t hash = 0;
+        const bool hashed = ContentHash::HashFile(path, hash);
+        const std::string cacheFile = hashed ? CacheFile(hash) : std::string();
+        std::error_code ec;
+        if (hashed && std::filesystem::exists(cacheFile, ec)) {
+            Texture2D::Image image = Texture2D::Decode(cacheFile, true);
+            JobSystem::Instance().runOnMainThread([this, path, image]() {
+                busy = false;
+                finish(path, image.pixels.get(), image.width, image.height, image.channels);
+            });
+            return;
+        }
+
+        // Les maps n'ont de vignette qu'une fois capturées
+        std::shared_ptr<Model> model;
+        if (hashed && !map) {
+            try {
+                model = std::make_shared<Model>(path, false, true);
+            } catch (const std::exception &ex) {
+                logger.error("Echec import pour la vignette: " + path + " (" + ex.what() + ")");
+            }
+        }
+        JobSystem::Instance().runOnMainThread([this, path, cacheFile, model]() {
+            if (!model || model->meshes.empty()) {
+                busy = false;
+                finish(path, nullptr, 0, 0, 0);
+                return;
+            }
+            // Textures hors du cache partagé : elles partent avec le modèle une fois la vignette rendue
+            model->uploadToGpu(false);
+            pendingRender.reset(new PendingRender{path, cacheFile, model, frame});
+        });
+    });
+}
+
+void ThumbnailRenderer::finish(const std::string &path, const unsigned char *pixels, int width, int height, int channels)
+{
+    Slot &slot = slots[path];
+    if (!pixels || (channels != 3 && channels != 4)) {
+        // Une capture de map arrivée pendant la recherche dans le cache reste affichée
+        if (slot.state != State::Ready) slot.state = State::Missing;
+        return;
+    }
+
+    GlTexture texture = GlTexture::Create();
+    glBindTexture(GL_TEXTURE_2D, texture.get());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    MemoryTracker::TrackTexture(texture.get(), static_cast<size_t>(width) * height * 4, "thumbnails");
+
+    slot.texture = std::move(texture);
+    slot.state = State::Ready;
+    // Une capture de map compte comme une demande : elle reste jusqu'à ce que la liste l'oublie
+    slot.wanted = std::max(slot.wanted, frame);
+}
+
+void ThumbnailRenderer::evictUnused()
+{
+    std::vector<std::map<std::string, Slot>::iterator> ready;
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (it->second.state == State::Ready) ready.push_back(it);
+    }
+    // Les plus récemment demandées d'abord : on garde le début de la liste
+    std::sort(ready.begin(), ready.end(), [](const auto &a, const auto &b) { return a->second.wanted > b->second.wanted; });
+    size_t released = 0;
+    for (size_t i = 0; i < ready.size(); ++i) {
+        Slot &slot = ready[i]->second;
+        if (i < kMaxReadyThumbnails && frame - slot.wanted <= kEvictAfterFrames) continue;
+        slot.texture.reset();
+        slot.state = State::Idle;
+        ++released;
+    }
+    if (released) logger.debug("Vignettes liberees: " + std::to_string(released));
+}
+
+bool ThumbnailRenderer::ensureTarget()
+{
+    if (framebuffer) return true;
+    if (targetFailed) return false;
+
+    colorTarget = GlTexture::Create();
+    glBindTexture(GL_TEXTURE_2D, colorTarget.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Size, Size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    depthTarget = GlRenderbuffer::Create();
+    glBindRenderbuffer(GL_RENDERBUFFER, depthTarget.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, Size, Size);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    framebuffer = GlFramebuffer::Create();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTarget.get(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthTarget.get());
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        logger.error("FBO de vignettes incomplet, vignettes desactivees");
+        framebuffer.reset();
+        colorTarget.reset();
+        depthTarget.reset();
+        targetFailed = true;
+        return false;
+    }
+    MemoryTracker::TrackTexture(colorTarget.get(), static_cast<size_t>(Size) * Size * 4, "thumbnails");
+    return true;
+}
+
+bool ThumbnailRenderer::render(const glm::vec3 &minBounds, const glm::vec3 &maxBounds, const std::function<void()> &draw,
+                               std::vector<unsigned char> &pixels)
+{
+    if (!ensureTarget() || minBounds.x > maxBounds.x || minBounds.y > maxBounds.y || minBounds.z > maxBounds.z) return false;
+    PROFILE_GPU_ZONE("Thumbnail");
+
+    // Vue de trois quarts en plongée, à la distance où la sphère englobante remplit le champ
+    const glm::vec3 center = 0.5f * (minBounds + maxBounds);
+    const float radius = glm::max(0.5f * glm::length(maxBounds - minBounds), 1e-3f);
+    const float distance = radius / std::sin(glm::radians(kFieldOfView) * 0.5f);
+    const glm::vec3 eye = center + glm::normalize(glm::vec3(1.0f, 0.8f, 1.2f)) * distance;
+    const glm::mat4 view = glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(kFieldOfView), 1.0f,
+                                                  glm::max(distance - radius * 1.1f, distance * 0.01f),
+                                                  distance + radius * 1.1f);
+
+    // Uniforms de la vignette pour les variantes utilisées ici ; la frame repose les siens
+    // par son propre beginFrame, appelé après update()
+    shaders.beginFrame([&](Shader &shader) {
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("viewPos", eye);
+        shader.setVec3("highlightColor", glm::vec3(0.0f));
+        shader.setVec3("dirLight.direction", glm::normalize(glm::vec3(-0.4f, -1.0f, -0.6f)));
+        shader.setVec3("dirLight.ambient", glm::vec3(0.35f));
+        shader.setVec3("dirLight.diffuse", glm::vec3(0.8f));
+        shader.setVec3("dirLight.specular", glm::vec3(0.3f));
+        shader.setFloat("environmentAmbientBoost", 1.0f);
+    });
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glViewport(0, 0, Size, Size);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    draw();
+
+    pixels.resize(static_cast<size_t>(Size) * Size * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, Size, Size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    return true;
+}
+
+std::string ThumbnailRenderer::CacheFile(uint64_t hash)
+{
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.tga", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool ThumbnailRenderer::WriteTga(const std::string &path, const std::vector<unsigned char> &pixels, int width, int height)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // TGA non compressé 32 bits, lignes de bas en haut comme glReadPixels ; BGRA dans le fichier
+    unsigned char header[18] = {};
+    header[2] = 2;
+    header[12] = static_cast<unsigned char>(width & 0xFF);
+    header[13] = static_cast<unsigned char>(width >> 8);
+    header[14] = static_cast<unsigned char>(height & 0xFF);
+    header[15] = static_cast<unsigned char>(height >> 8);
+    header[16] = 32;
+    header[17] = 8;   // 8 bits d'alpha, origine en bas à gauche
+
+    std::vector<unsigned char> bgra(pixels.size());
+    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
+        bgra[i] = pixels[i + 2];
+        bgra[i + 1] = pixels[i + 1];
+        bgra[i + 2] = pixels[i];
+        bgra[i + 3] = pixels[i + 3];
+    }
+
+    // Écrit à côté puis renommé : un lecteur ne voit jamais une image à moitié écrite
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(bgra.data()), static_cast<std::streamsize>(bgra.size()));
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            logger.error("Ecriture de vignette impossible: " + path);
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,180 @@
+#include "TraceCapture.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace {
+// ~10 Mo : plusieurs secondes de capture avec des imports en cours
+const size_t kCapacity = 1u << 18;
+
+const auto kEpoch = std::chrono::steady_clock::now();
+
+std::mutex threadNamesMutex;
+std::map<uint32_t, std::string> threadNames;
+std::atomic<uint32_t> nextThreadIndex{0};
+
+std::string escapeJson(const char* text)
+{
+    std::string out;
+    for (const char* c = text; c && *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20) out += *c;
+    }
+    return out;
+}
+
+std::string traceFileName()
+{
+    std::time_t t = std::time(nullptr);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", std::localtime(&t));
+    return std::string("logs/trace_") + buf + ".json";
+}
+}
+
+struct TraceCapture::Event {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t thread = 0;
+    // Publié en dernier : l'écriture du fichier ignore les cases réservées mais pas encore remplies
+    std::atomic<bool> ready{false};
+};
+
+std::atomic<bool> TraceCapture::capturing{false};
+std::atomic<bool> TraceCapture::writing{false};
+std::atomic<size_t> TraceCapture::nextEvent{0};
+std::atomic<size_t> TraceCapture::dropped{0};
+std::unique_ptr<TraceCapture::Event[]> TraceCapture::events;
+int TraceCapture::framesLeft = 0;
+uint64_t TraceCapture::deadlineUs = 0;
+ComponentLogger TraceCapture::logger("Trace");
+
+uint64_t TraceCapture::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - kEpoch).count());
+}
+
+uint32_t TraceCapture::threadIndex()
+{
+    thread_local uint32_t index = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void TraceCapture::SetThreadName(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(threadNamesMutex);
+    threadNames[threadIndex()] = name;
+}
+
+bool TraceCapture::Start(int frames, double seconds)
+{
+    if (frames <= 0 && seconds <= 0.0) {
+        logger.error("Capture refusee: ni nombre de frames ni duree");
+        return false;
+    }
+    if (capturing.load() || writing.load()) {
+        logger.error("Capture deja en cours");
+        return false;
+    }
+
+    if (!events) events.reset(new Event[kCapacity]);
+    for (size_t i = 0; i < kCapacity; ++i) events[i].ready.store(false, std::memory_order_relaxed);
+    nextEvent.store(0);
+    dropped.store(0);
+    framesLeft = frames > 0 ? frames : -1;
+    deadlineUs = seconds > 0.0 ? Now() + static_cast<uint64_t>(seconds * 1.0e6) : 0;
+
+    logger.info("Capture demarree: " + std::to_string(frames) + " frames, " + std::to_string(seconds) + " s");
+    capturing.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceCapture::Record(const char* name, const char* category, uint64_t startUs, uint64_t endUs)
+{
+    if (!capturing.load(std::memory_order_acquire)) return;
+
+    const size_t index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kCapacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event& event = events[index];
+    event.name = name;
+    event.category = category;
+    event.start = startUs;
+    event.end = endUs;
+    event.thread = threadIndex();
+    event.ready.store(true, std::memory_order_release);
+}
+
+void TraceCapture::EndFrame()
+{
+    if (!capturing.load(std::memory_order_relaxed)) return;
+
+    bool done = framesLeft > 0 && --framesLeft == 0;
+    if (deadlineUs && Now() >= deadlineUs) done = true;
+    if (done) finish();
+}
+
+void TraceCapture::finish()
+{
+    capturing.store(false, std::memory_order_release);
+    writing.store(true);
+
+    const size_t count = std::min(nextEvent.load(), kCapacity);
+    const std::string path = traceFileName();
+    // L'écriture de quelques Mo de JSON n'a rien à faire sur le thread de rendu
+    JobSystem::Instance().submit([path, count]() {
+        write(path, count);
+        writing.store(false);
+    });
+}
+
+void TraceCapture::write(const std::string& path, size_t count)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        logger.error("Impossible d'ecrire la trace: " + path);
+        return;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(threadNamesMutex);
+        for (const auto& thread : threadNames) {
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.first
+                << ",\"args\":{\"name\":\"" << escapeJson(thread.second.c_str()) << "\"}}";
+            first = false;
+        }
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Event& event = events[i];
+        if (!event.ready.load(std::memory_order_acquire)) continue;
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"" << escapeJson(event.category)
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << event.start << ",\"dur\":" << (event.end - event.start) << "}";
+        first = false;
+        ++written;
+    }
+    out << "\n]}\n";
+
+    std::string message = "Trace ecrite: " + path + " (" + std::to_string(written) + " evenements";
+    if (dropped.load()) message += ", " + std::to_string(dropped.load()) + " perdus, tampon plein";
+    logger.info(message + ")");
+}
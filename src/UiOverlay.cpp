@@ -1,10 +1,17 @@
 #include "UiOverlay.h"
+#include "AssetDatabase.h"
 #include "ModelBrowserPanel.h"
 #include "CustomButtonsPanel.h"
 #include "ScenePanel.h"
 #include "SceneState.h"
 #include "MapPanel.h"
 #include "EditorState.h"
+#include "StreamBuffer.h"
+#include "ProfilerPanel.h"
+#include "Profiler.h"
+#include "MemoryPanel.h"
+#include "MemoryTracker.h"
+#include "SceneSerializer.h"
 
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
@@ -13,6 +20,18 @@
 #include <GLFW/glfw3.h>
 #include "Camera.h"
 
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+bool isModelFile(const std::string& path)
+{
+    auto ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".obj" || ext == ".fbx" || ext == ".dae" || ext == ".gltf" || ext == ".glb";
+}
+}
+
 UiOverlay::UiOverlay() {}
 UiOverlay::~UiOverlay() { shutdown(); }
 
@@ -41,16 +60,23 @@ void UiOverlay::init(GLFWwindow* win,
     // GLSL version string depending on your context; 130 works for GL 3.0+, 330 for core
     ImGui_ImplOpenGL3_Init("#version 130");
 
-    browser = std::make_unique<ModelBrowserPanel>(mgr, modelsRoot);
+    modelAssets = std::make_unique<AssetDatabase>(modelsRoot, isModelFile);
+    mapAssets = std::make_unique<AssetDatabase>(mapsRoot, SceneSerializer::IsMapFile, false);
+
+    browser = std::make_unique<ModelBrowserPanel>(mgr, modelAssets.get());
     buttons = std::make_unique<CustomButtonsPanel>(editorState);
     scenePanel = std::make_unique<ScenePanel>(sceneState);
-    mapPanel = std::make_unique<MapPanel>(mapsRoot, saveCb, loadCb, newCb, editorState);
+    mapPanel = std::make_unique<MapPanel>(mapsRoot, saveCb, loadCb, newCb, editorState, mapAssets.get(), mgr);
+    profilerPanel = std::make_unique<ProfilerPanel>(&Profiler::Instance());
+    memoryPanel = std::make_unique<MemoryPanel>();
 
     // Assurer qu'aucun panneau n'est visible par défaut
     if (browser) browser->setVisible(false);
     if (buttons) buttons->setVisible(false);
     if (scenePanel) scenePanel->setVisible(false);
     if (mapPanel) mapPanel->setVisible(false);
+    if (profilerPanel) profilerPanel->setVisible(false);
+    if (memoryPanel) memoryPanel->setVisible(false);
 }
 
 void UiOverlay::shutdown()
@@ -70,8 +96,21 @@ void UiOverlay::toggleVisible()
     }
 }
 
+void UiOverlay::setThumbnails(ThumbnailRenderer* renderer)
+{
+    if (browser) browser->setThumbnails(renderer);
+    if (mapPanel) mapPanel->setThumbnails(renderer);
+}
+
+void UiOverlay::mapSaved(const std::string& path)
+{
+    if (mapPanel) mapPanel->mapSaved(path);
+}
+
 void UiOverlay::beginFrame()
 {
+    if (modelAssets) modelAssets->update();
+    if (mapAssets) mapAssets->update();
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -121,7 +160,7 @@ void UiOverlay::draw()
         if (ImGui::Button("Resume", ImVec2(200, 40))) {
             editor->menuState = MenuState::None;
             // Fermer l'overlay uniquement si aucun panneau n'est ouvert
-            bool anyPanelOpen = (browser && browser->isVisible()) || (buttons && buttons->isVisible()) || (scenePanel && scenePanel->isVisible()) || (mapPanel && mapPanel->isVisible());
+            bool anyPanelOpen = (browser && browser->isVisible()) || (buttons && buttons->isVisible()) || (scenePanel && scenePanel->isVisible()) || (mapPanel && mapPanel->isVisible()) || (profilerPanel && profilerPanel->isVisible()) || (memoryPanel && memoryPanel->isVisible());
             if (!anyPanelOpen && visible) toggleVisible();
         }
         
@@ -184,7 +223,8 @@ void UiOverlay::draw()
             if (hovered[0]) {
                 editor->activeRadialItem = RadialMenuItem::InfoLogs;
                 // Afficher le panneau d'infos/logs
-                if (scenePanel) scenePanel->setVisible(true);
+                if (profilerPanel) profilerPanel->setVisible(true);
+                if (memoryPanel) memoryPanel->setVisible(true);
             } else if (hovered[1]) {
                 editor->activeRadialItem = RadialMenuItem::ImportModels;
                 // Afficher le navigateur de modèles
@@ -212,6 +252,13 @@ void UiOverlay::draw()
     if (buttons && buttons->isVisible()) buttons->draw(&open);
     if (scenePanel && scenePanel->isVisible()) scenePanel->draw(&open);
     if (mapPanel && mapPanel->isVisible()) mapPanel->draw(&open);
+    if (profilerPanel && profilerPanel->isVisible()) {
+        // Fermer le panneau coupe aussi le profilage
+        bool profilerOpen = true;
+        profilerPanel->draw(&profilerOpen);
+        if (!profilerOpen) profilerPanel->setVisible(false);
+    }
+    if (memoryPanel && memoryPanel->isVisible()) memoryPanel->draw(&open);
 
     // Afficher le message de statut s'il est actif
     if (editor && !editor->statusMessage.empty() && editor->statusMessageTime > 0.0f) {
@@ -230,7 +277,7 @@ void UiOverlay::draw()
     
     // Afficher les FPS en haut à droite
     if (editor) {
-        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 100, 10));
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 160, 10));
         ImGui::SetNextWindowBgAlpha(0.35f);
         if (ImGui::Begin("FPS", nullptr, 
                         ImGuiWindowFlags_NoTitleBar | 
@@ -239,6 +286,10 @@ void UiOverlay::draw()
                         ImGuiWindowFlags_NoFocusOnAppearing |
                         ImGuiWindowFlags_NoNav)) {
             ImGui::Text("FPS: %.1f", editor->fps);
+            ImGui::Text("Stream: %.1f Ko", StreamBuffer::BytesStreamedLastFrame() / 1024.0f);
+            size_t vram = MemoryTracker::Total(MemoryKind::VertexBuffer) + MemoryTracker::Total(MemoryKind::IndexBuffer) +
+                          MemoryTracker::Total(MemoryKind::StreamBuffer) + MemoryTracker::Total(MemoryKind::Texture);
+            ImGui::Text("VRAM: %.1f Mo", vram / (1024.0f * 1024.0f));
         }
         ImGui::End();
     }
@@ -256,6 +307,8 @@ void UiOverlay::hideAllPanels()
     if (buttons) buttons->setVisible(false);
     if (scenePanel) scenePanel->setVisible(false);
     if (mapPanel) mapPanel->setVisible(false);
+    if (profilerPanel) profilerPanel->setVisible(false);
+    if (memoryPanel) memoryPanel->setVisible(false);
 }
 
 void UiOverlay::showOnlyMapPanel()
@@ -286,6 +339,14 @@ void UiOverlay::showOnlyCustomButtons()
     if (buttons) buttons->setVisible(true);
 }
 
+void UiOverlay::showOnlyInfoPanels()
+{
+    if (!visible) toggleVisible();
+    hideAllPanels();
+    if (profilerPanel) profilerPanel->setVisible(true);
+    if (memoryPanel) memoryPanel->setVisible(true);
+}
+
 void UiOverlay::DrawRadialButton(const char* label, const ImVec2& center, float radius, float angleStart, float angleEnd, bool& hovered) {
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     const ImU32 col = hovered ? IM_COL32(200, 200, 100, 200) : IM_COL32(100, 100, 100, 200);
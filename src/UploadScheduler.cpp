@@ -0,0 +1,206 @@
+#include "UploadScheduler.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+ComponentLogger UploadScheduler::logger("Upload");
+
+namespace {
+// Alignement des copies dans l'anneau de staging
+const size_t kStagingAlignment = 4;
+}
+
+UploadScheduler& UploadScheduler::Instance()
+{
+    static UploadScheduler instance;
+    return instance;
+}
+
+void UploadScheduler::uploadBuffer(const std::shared_ptr<Ticket>& ticket, GLuint buffer, const void* data, size_t bytes)
+{
+    if (!ticket || !buffer || !data || bytes == 0) return;
+
+    // Copie privée : la source (sommets d'un Mesh) peut être déplacée ou libérée avant l'envoi
+    std::shared_ptr<unsigned char> copy(new unsigned char[bytes], std::default_delete<unsigned char[]>());
+    std::memcpy(copy.get(), data, bytes);
+
+    Job job;
+    job.kind = Job::Buffer;
+    job.owner = ticket;
+    job.buffer = buffer;
+    job.data = copy;
+    job.bytes = bytes;
+
+    ticket->pending.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(incomingMutex);
+    incoming.push_back(std::move(job));
+}
+
+void UploadScheduler::uploadTexture(const std::shared_ptr<GlTexture>& texture, int width, int height,
+                                    GLenum internalFormat, GLenum format, std::shared_ptr<unsigned char> pixels)
+{
+    if (!texture || !pixels || width <= 0 || height <= 0) return;
+
+    int channels = 4;
+    if (format == GL_RED) channels = 1;
+    else if (format == GL_RG) channels = 2;
+    else if (format == GL_RGB) channels = 3;
+
+    Job job;
+    job.kind = Job::Texture;
+    job.owner = texture;
+    job.data = pixels;
+    job.bytes = static_cast<size_t>(width) * height * channels;
+    job.width = width;
+    job.height = height;
+    job.internalFormat = internalFormat;
+    job.format = format;
+
+    std::lock_guard<std::mutex> lock(incomingMutex);
+    incoming.push_back(std::move(job));
+}
+
+void UploadScheduler::setBudget(size_t bytesPerFrame, double microsPerFrame)
+{
+    budgetBytes = std::max<size_t>(bytesPerFrame, 64u * 1024u);
+    budgetMicros = microsPerFrame;
+    // L'anneau sera recréé à la bonne taille au prochain process()
+    staging.reset();
+}
+
+UploadScheduler::Stats UploadScheduler::stats() const
+{
+    Stats s;
+    s.bytesLastFrame = lastBytes;
+    s.microsLastFrame = lastMicros;
+    s.queuedJobs = queue.size();
+    s.queuedBytes = queuedBytes;
+    return s;
+}
+
+bool UploadScheduler::runBuffer(Job& job, size_t& frameBytes)
+{
+    const size_t room = std::min(budgetBytes > frameBytes ? budgetBytes - frameBytes : 0, staging->available());
+    const size_t chunk = std::min(job.bytes - job.offset, room > kStagingAlignment ? room - kStagingAlignment : 0);
+    if (chunk == 0) return false;
+
+    GLintptr stagingOffset = 0;
+    void* dst = staging->map(chunk, kStagingAlignment, stagingOffset);
+    if (!dst) return false;
+    std::memcpy(dst, job.data.get() + job.offset, chunk);
+    staging->unmap();
+
+    glBindBuffer(GL_COPY_READ_BUFFER, staging->id());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, job.buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, stagingOffset, static_cast<GLintptr>(job.offset), chunk);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    job.offset += chunk;
+    frameBytes += chunk;
+    return true;
+}
+
+bool UploadScheduler::runTexture(Job& job, size_t& frameBytes)
+{
+    const bool fitsRing = job.bytes + kStagingAlignment <= staging->capacityPerFrame();
+    if (frameBytes > 0) {
+        // Une texture ne se découpe pas : elle attend une frame où elle tient dans le budget
+        if (frameBytes + job.bytes > budgetBytes || !fitsRing) return false;
+        if (job.bytes + kStagingAlignment > staging->available()) return false;
+    }
+
+    auto texture = std::static_pointer_cast<GlTexture>(job.owner.lock());
+    glBindTexture(GL_TEXTURE_2D, texture->get());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (fitsRing && job.bytes + kStagingAlignment <= staging->available()) {
+        GLintptr stagingOffset = 0;
+        void* dst = staging->map(job.bytes, kStagingAlignment, stagingOffset);
+        if (!dst) return false;
+        std::memcpy(dst, job.data.get(), job.bytes);
+        staging->unmap();
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->id());
+        glTexImage2D(GL_TEXTURE_2D, 0, job.internalFormat, job.width, job.height, 0, job.format, GL_UNSIGNED_BYTE,
+                     reinterpret_cast<const void*>(stagingOffset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        logger.debug("Texture plus grande que l'anneau de staging, envoi direct: " +
+                     std::to_string(job.width) + "x" + std::to_string(job.height));
+        glTexImage2D(GL_TEXTURE_2D, 0, job.internalFormat, job.width, job.height, 0, job.format, GL_UNSIGNED_BYTE,
+                     job.data.get());
+    }
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR) {
+        logger.error("OpenGL erreur lors de l'envoi d'une texture: code=" + std::to_string(err));
+    }
+
+    job.offset = job.bytes;
+    frameBytes += job.bytes;
+    return true;
+}
+
+void UploadScheduler::process()
+{
+    PROFILE_ZONE_CAT("GPU uploads", "gpu-upload");
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        for (auto& job : incoming) {
+            queuedBytes += job.bytes;
+            queue.push_back(std::move(job));
+        }
+        incoming.clear();
+    }
+    if (!staging) {
+        staging = std::make_unique<StreamBuffer>(GL_PIXEL_UNPACK_BUFFER, budgetBytes);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMicros = [&start]() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    size_t frameBytes = 0;
+    while (!queue.empty()) {
+        if (frameBytes >= budgetBytes || elapsedMicros() >= budgetMicros) break;
+
+        Job& job = queue.front();
+        const size_t before = job.offset;
+        std::shared_ptr<void> owner = job.owner.lock();
+        if (!owner) {
+            // Ticket libéré ou texture détruite : son objet GL n'existe peut-être plus
+            queuedBytes -= job.bytes - job.offset;
+            queue.pop_front();
+            continue;
+        }
+
+        const bool progressed = job.kind == Job::Buffer ? runBuffer(job, frameBytes) : runTexture(job, frameBytes);
+        queuedBytes -= job.offset - before;
+        if (!progressed) break;
+        if (job.offset < job.bytes) continue;
+
+        if (job.kind == Job::Buffer) {
+            std::static_pointer_cast<Ticket>(owner)->pending.fetch_sub(1, std::memory_order_release);
+        }
+        queue.pop_front();
+    }
+
+    lastBytes = frameBytes;
+    lastMicros = elapsedMicros();
+}
+
+void UploadScheduler::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        incoming.clear();
+    }
+    queue.clear();
+    queuedBytes = 0;
+    staging.reset();
+}
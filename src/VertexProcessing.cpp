@@ -0,0 +1,42 @@
+#include "VertexProcessing.h"
+
+#include <cmath>
+
+void VertexProcessing::GenerateNormals(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    for (auto &v : vertices) v.Normal = glm::vec3(0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Vertex &a = vertices[indices[i]], &b = vertices[indices[i + 1]], &c = vertices[indices[i + 2]];
+        const glm::vec3 n = glm::cross(b.Position - a.Position, c.Position - a.Position);
+        a.Normal += n;
+        b.Normal += n;
+        c.Normal += n;
+    }
+    for (auto &v : vertices) {
+        const float len = glm::length(v.Normal);
+        v.Normal = len > 0.0f ? v.Normal / len : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+void VertexProcessing::GenerateTangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    for (auto &v : vertices) v.Tangent = v.Bitangent = glm::vec3(0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Vertex &a = vertices[indices[i]], &b = vertices[indices[i + 1]], &c = vertices[indices[i + 2]];
+        const glm::vec3 e1 = b.Position - a.Position, e2 = c.Position - a.Position;
+        const glm::vec2 d1 = b.TexCoords - a.TexCoords, d2 = c.TexCoords - a.TexCoords;
+        const float det = d1.x * d2.y - d2.x * d1.y;
+        if (std::abs(det) < 1e-12f) continue;
+        const float r = 1.0f / det;
+        const glm::vec3 t = (e1 * d2.y - e2 * d1.y) * r;
+        const glm::vec3 bt = (e2 * d1.x - e1 * d2.x) * r;
+        for (Vertex *v : {&a, &b, &c}) {
+            v->Tangent += t;
+            v->Bitangent += bt;
+        }
+    }
+    for (auto &v : vertices) {
+        if (glm::length(v.Tangent) > 0.0f) v.Tangent = glm::normalize(v.Tangent);
+        if (glm::length(v.Bitangent) > 0.0f) v.Bitangent = glm::normalize(v.Bitangent);
+    }
+}
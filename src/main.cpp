@@ -5,6 +5,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Shader.h"
+#include "ShaderPermutations.h"
 #include "Camera.h"
 #include "Model.h"
 #include "ModelManager.h"
@@ -12,14 +13,27 @@
 #include "SceneState.h"
 #include "Grid.h"
 #include "SceneSerializer.h"
+#include "MapJournal.h"
 #include "EditorState.h"
 #include "SceneData.h"
 #include "MenuRenderer.h"
 #include "SandBoxUI.h"
+#include "StreamBuffer.h"
+#include "JobSystem.h"
+#include "HotReload.h"
+#include "Profiler.h"
+#include "TraceCapture.h"
+#include "GpuHandle.h"
+#include "TextureResidency.h"
+#include "UploadScheduler.h"
+#include "ImportBenchmark.h"
+#include "ThumbnailRenderer.h"
 #include <imgui.h>
 #include <iostream>
 #include <filesystem>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -47,53 +61,73 @@ struct AppContext {
     SceneState* scene = nullptr;
     EditorState* editor = nullptr;
     std::string mapsRoot;
+    ThumbnailRenderer* thumbnails = nullptr;
+    UiOverlay* overlay = nullptr;
+    // Modifications de la map ouverte : Ctrl+S n'écrit que celles faites depuis la dernière sauvegarde
+    MapJournal journal;
 
     std::string normalized(const std::string& path) const {
         if (path.empty()) return path;
         return std::filesystem::path(path).lexically_normal().string();
     }
 
-    std::string ensureJsonExtension(const std::string& name) const {
-        std::filesystem::path p = name;
-        if (p.extension() != ".json") {
-            p.replace_extension(".json");
-        }
-        return p.string();
-    }
-
     std::string currentMapPath() const {
         std::string mapName = (editor && !editor->currentMapName.empty()) ? editor->currentMapName : "default";
+        if (editor) mapName += editor->currentMapExtension;
         std::filesystem::path base = mapsRoot.empty() ? std::filesystem::path(".") : std::filesystem::path(mapsRoot);
-        base /= ensureJsonExtension(mapName);
+        base /= SceneSerializer::WithMapExtension(mapName);
         return base.string();
     }
 
-    bool saveSceneTo(const std::string& path) {
+    // Instantané O(1) des instances, converti en données de map sur le thread d'écriture
+    MapJournal::InstanceSource instanceSource() const {
+        ModelManager::Instances instances = models->snapshotInstances();
+        return [instances]() { return ModelManager::ToInstanceData(instances); };
+    }
+
+    // Démarre la sauvegarde : l'écriture se fait en arrière-plan et la barre d'état annonce sa fin
+    bool saveSceneTo(const std::string& path, bool autosave = false) {
         if (!models || !scene) return false;
         std::string resolved = normalized(path.empty() ? currentMapPath() : path);
         if (resolved.empty()) return false;
 
-        SceneSnapshot snapshot;
-        snapshot.light = scene->light();
-        snapshot.environment = scene->environment();
-        snapshot.models = models->serializeInstances();
-
-        std::filesystem::create_directories(std::filesystem::path(resolved).parent_path());
-        bool ok = SceneSerializer::Save(resolved, snapshot);
+        std::string name = std::filesystem::path(resolved).stem().string();
+        EditorState* status = editor;
+        auto done = [status, name, autosave, resolved, thumbnails = thumbnails, models = models, overlay = overlay](bool ok) {
+            if (ok && !autosave && thumbnails) thumbnails->captureMap(resolved, *models);
+            if (ok && overlay) overlay->mapSaved(resolved);
+            if (!status) return;
+            // Une sauvegarde automatique réussie reste silencieuse
+            if (!ok) status->setStatusMessage("Map save failed: " + name, 5.0f);
+            else if (!autosave) status->setStatusMessage("Map saved: " + name, 3.0f);
+        };
         if (editor) {
-            editor->currentMapName = std::filesystem::path(resolved).stem().string();
-            editor->setStatusMessage(ok ? std::string("Map saved: ") + editor->currentMapName
-                                         : std::string("Map save failed: ") + editor->currentMapName,
-                                     ok ? 3.0f : 5.0f);
+            editor->currentMapName = name;
+            editor->currentMapExtension = std::filesystem::path(resolved).extension().string();
+            if (!autosave) editor->setStatusMessage("Saving map: " + name, 10.0f);
         }
-        return ok;
+
+        if (journal.isAttachedTo(resolved)) {
+            journal.commit(resolved, scene->light(), scene->environment(), done);
+            if (journal.wantsCompaction()) journal.compact(scene->light(), scene->environment(), instanceSource());
+        } else {
+            std::filesystem::create_directories(std::filesystem::path(resolved).parent_path());
+            journal.save(resolved, scene->light(), scene->environment(), instanceSource(), done);
+        }
+        return true;
     }
 
     bool saveActiveMap() { return saveSceneTo(currentMapPath()); }
 
+    // Sauvegarde périodique, seulement pour une map déjà ouverte ou enregistrée
+    void autosave() {
+        if (journal.isAttachedTo(normalized(currentMapPath()))) saveSceneTo(currentMapPath(), true);
+    }
+
     bool loadSceneFrom(const std::string& path) {
         if (!models || !scene) return false;
-        auto snapshot = SceneSerializer::Load(path);
+        std::string resolved = normalized(path);
+        auto snapshot = journal.load(resolved);
         if (!snapshot) {
             if (editor) editor->setStatusMessage("Failed to load map", 5.0f);
             return false;
@@ -101,41 +135,91 @@ struct AppContext {
         scene->setLight(snapshot->light);
         scene->setEnvironment(snapshot->environment);
         models->loadInstances(snapshot->models);
+        // Instances écartées au chargement : les index du journal ne correspondraient plus
+        if (models->getModelCount() != snapshot->models.size()) journal.detach();
+        if (thumbnails) thumbnails->captureMap(resolved, *models);
         if (editor) {
             editor->currentMapName = std::filesystem::path(path).stem().string();
+            editor->currentMapExtension = std::filesystem::path(path).extension().string();
             editor->setStatusMessage(std::string("Map loaded: ") + editor->currentMapName, 3.0f);
         }
         return true;
     }
 
+    // Écrit une map vide à path en arrière-plan ; la map ouverte et son journal ne changent pas.
+    // Refusé pour la map ouverte, dont les modifications iraient dans le journal supprimé.
     bool createSceneAt(const std::string& path) {
-        if (!models || !scene) return false;
-        SceneSnapshot backup;
-        backup.light = scene->light();
-        backup.environment = scene->environment();
-        backup.models = models->serializeInstances();
-        std::string previousName = editor ? editor->currentMapName : std::string();
-
-        models->clear();
-        DirectionalLightSettings defaultLight;
-        EnvironmentSettings defaultEnv;
-        scene->setLight(defaultLight);
-        scene->setEnvironment(defaultEnv);
-        bool ok = saveSceneTo(path);
-
-        models->loadInstances(backup.models);
-        scene->setLight(backup.light);
-        scene->setEnvironment(backup.environment);
-        if (editor) {
-            editor->currentMapName = previousName;
-            editor->setStatusMessage(ok ? "New map created" : "Failed to create map", ok ? 3.0f : 5.0f);
+        std::string resolved = normalized(path);
+        EditorState* status = editor;
+        auto done = [status](bool ok) {
+            if (status) status->setStatusMessage(ok ? "New map created" : "Failed to create map", ok ? 3.0f : 5.0f);
+        };
+        if (resolved.empty()) {
+            done(false);
+            return false;
         }
-        return ok;
+        if (journal.isAttachedTo(resolved)) {
+            if (editor) editor->setStatusMessage("Map is open, save it instead", 5.0f);
+            return false;
+        }
+        std::filesystem::create_directories(std::filesystem::path(resolved).parent_path());
+        return journal.create(resolved, done);
     }
 };
 
-int main()
+// Nombre de frames capturées par F9 quand --trace-frames n'est pas précisé
+const int DEFAULT_TRACE_FRAMES = 120;
+
+int main(int argc, char** argv)
 {
+    // --trace-frames N / --trace-seconds S : capture une trace Chrome dès le démarrage
+    // --texture-budget-mb N : VRAM allouée aux textures avant rétrogradation des mips
+    // --texture-upload-mb N : envois de textures par frame pendant la diffusion
+    // --no-texture-streaming : textures envoyées en entier au chargement
+    // --no-native-importers : tous les modèles passent par Assimp
+    // --bench-import FICHIER [--bench-iterations N] : compare les temps d'import puis quitte
+    // --convert-map SOURCE DESTINATION : réécrit une map dans le format de l'extension cible, puis quitte
+    // --no-map-compression : maps binaires écrites sans compression
+    // --autosave-seconds S : sauvegarde la map ouverte toutes les S secondes
+    // --undo-budget-mb N : mémoire gardée par l'historique d'annulation
+    int traceFrames = 0;
+    double traceSeconds = 0.0;
+    std::string benchImport;
+    std::string convertSource, convertTarget;
+    int benchIterations = 5;
+    float autosaveSeconds = 0.0f;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--no-texture-streaming") == 0) Texture2D::SetStreaming(false);
+        else if (std::strcmp(argv[i], "--no-native-importers") == 0) Model::SetNativeImporters(false);
+        else if (std::strcmp(argv[i], "--no-map-compression") == 0) SceneSerializer::SetBinaryCompression(false);
+        else if (!hasValue) continue;
+        else if (std::strcmp(argv[i], "--trace-frames") == 0) traceFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--trace-seconds") == 0) traceSeconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--texture-budget-mb") == 0) {
+            TextureResidency::SetBudget(static_cast<size_t>(std::atol(argv[++i])) * 1024u * 1024u);
+        } else if (std::strcmp(argv[i], "--texture-upload-mb") == 0) {
+            TextureResidency::SetUploadBudget(static_cast<size_t>(std::atol(argv[++i])) * 1024u * 1024u);
+        } else if (std::strcmp(argv[i], "--bench-import") == 0) benchImport = argv[++i];
+        else if (std::strcmp(argv[i], "--bench-iterations") == 0) benchIterations = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--autosave-seconds") == 0) autosaveSeconds = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--undo-budget-mb") == 0) {
+            ModelManager::SetHistoryBudget(static_cast<size_t>(std::atol(argv[++i])) * 1024u * 1024u);
+        }
+        else if (std::strcmp(argv[i], "--convert-map") == 0 && i + 2 < argc) {
+            convertSource = argv[++i];
+            convertTarget = argv[++i];
+        }
+    }
+    if (!convertSource.empty()) {
+        auto snapshot = SceneSerializer::Load(convertSource);
+        const bool ok = snapshot && SceneSerializer::Save(convertTarget, *snapshot);
+        std::cout << (ok ? "Map convertie: " : "Echec de conversion: ") << convertSource << " -> " << convertTarget << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (!benchImport.empty()) return ImportBenchmark::Run(benchImport, benchIterations);
+    TraceCapture::SetThreadName("Main");
+
     // Initialize GLFW
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -170,19 +254,30 @@ int main()
     // Configure global opengl state
     glEnable(GL_DEPTH_TEST);
 
-    // Build and compile our shader program
-    Shader ourShader("../shaders/model_loading.vs", "../shaders/model_loading.fs");
+    // Variants of the model shader are compiled on demand from the material feature bits
+    ShaderPermutations modelShaders("../shaders/model_loading.vs", "../shaders/model_loading.fs");
 
     // Model manager with drag-and-drop support
     ModelManager manager;
     ModelManager::InstallDropHandler(window, &manager);
+    // Texture d'un chemin remplacée par une autre (fichier identique, texture partagée modifiée)
+    Texture2D::SetRelinkHandler([&manager](const std::string& path, GLuint id) { manager.retargetTexture(path, id); });
 
     SceneState sceneState;
     EditorState editorState;
     const std::string modelsRoot = "../resources/models";
     const std::string mapsRoot = "../resources/maps";
 
-    AppContext appContext{ &manager, &sceneState, &editorState, mapsRoot };
+    // Vignettes des panneaux Models et Maps, rendues une par frame en début de boucle
+    ThumbnailRenderer thumbnails(modelShaders);
+
+    AppContext appContext;
+    appContext.models = &manager;
+    appContext.scene = &sceneState;
+    appContext.editor = &editorState;
+    appContext.mapsRoot = mapsRoot;
+    appContext.thumbnails = &thumbnails;
+    manager.setEditListener([&appContext](const InstanceEdit& edit) { appContext.journal.record(edit); });
 
     UiOverlay overlay;
     auto saveCb = [&appContext](const std::string& path) { return appContext.saveSceneTo(path); };
@@ -198,40 +293,64 @@ int main()
                 saveCb,
                 loadCb,
                 newCb);
+    overlay.setThumbnails(&thumbnails);
+    appContext.overlay = &overlay;
     bool prevToggleE = false;
     bool prevSaveCombo = false;
+    bool prevUndoCombo = false;
+    bool prevRedoCombo = false;
+    bool prevTraceKey = false;
     bool overlayOpenedForPause = false;
 
     SandBoxUI sandboxUI(&manager, &editorState, &camera);
 
     // Grid floor
-    Shader gridShader("../shaders/grid.vs", "../shaders/grid.fs");
+    ShaderPermutations gridShaders("../shaders/grid.vs", "../shaders/grid.fs");
     Grid grid;
+
+    // Shaders, modèles et textures modifiés sur disque sont rechargés sans redémarrer
+    HotReload hotReload(manager);
+    hotReload.addShaders(&modelShaders);
+    hotReload.addShaders(&gridShaders);
+    hotReload.watch("../shaders");
+    hotReload.watch(modelsRoot);
     
     // Draw in wireframe
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    if (traceFrames > 0 || traceSeconds > 0.0) {
+        TraceCapture::Start(traceFrames, traceSeconds);
+    }
+
     // Render loop
     while (!glfwWindowShouldClose(window))
     {
+        Profiler::Instance().beginFrame();
+
         // Per-frame time logic
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-        if (deltaTime > 0.0f) {
-            editorState.fps = 1.0f / deltaTime;
-        }
         editorState.update(deltaTime);
 
+        // Frontière de frame : on applique les imports terminés en arrière-plan avant tout rendu
+        {
+            PROFILE_ZONE("Jobs");
+            JobSystem::Instance().drainMainThread();
+            hotReload.update();
+            thumbnails.update();
+        }
+
         // Input (disable camera controls when cursor is not disabled)
         if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED || overlay.isVisible() || editorState.menuState != MenuState::None) {
+            PROFILE_ZONE("Input");
             processInput(window, editorState, manager, camera, overlay, overlayOpenedForPause);
         }
         
         // Mettre à jour l'état de l'éditeur
         editorState.update(deltaTime);
         
-        // Mettre à jour les FPS
+        // Mettre à jour les FPS (moyenne sur une demi-seconde, plus lisible qu'une valeur par frame)
         static float fpsTimer = 0.0f;
         static int frameCount = 0;
         fpsTimer += deltaTime;
@@ -251,6 +370,37 @@ int main()
         }
         prevSaveCombo = saveCombo;
 
+        // Ctrl+Z / Ctrl+Y (ou Ctrl+Maj+Z) : annuler, rétablir
+        bool shiftDown = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
+                         glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+        bool zDown = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+        bool undoCombo = ctrlDown && zDown && !shiftDown;
+        bool redoCombo = ctrlDown && (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS || (zDown && shiftDown));
+        if ((undoCombo && !prevUndoCombo) || (redoCombo && !prevRedoCombo)) {
+            bool changed = undoCombo ? manager.undo() : manager.redo();
+            if (changed) editorState.clearSelection();
+            editorState.setStatusMessage(changed ? (undoCombo ? "Undo" : "Redo")
+                                                 : (undoCombo ? "Nothing to undo" : "Nothing to redo"), 1.5f);
+        }
+        prevUndoCombo = undoCombo;
+        prevRedoCombo = redoCombo;
+
+        static float autosaveTimer = 0.0f;
+        if (autosaveSeconds > 0.0f && (autosaveTimer += deltaTime) >= autosaveSeconds) {
+            autosaveTimer = 0.0f;
+            appContext.autosave();
+        }
+
+        // F9 : capture des prochaines frames dans logs/trace_*.json
+        bool traceKey = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+        if (traceKey && !prevTraceKey && !TraceCapture::IsCapturing()) {
+            int frames = traceFrames > 0 ? traceFrames : DEFAULT_TRACE_FRAMES;
+            if (TraceCapture::Start(frames)) {
+                editorState.setStatusMessage("Trace capture: " + std::to_string(frames) + " frames", 3.0f);
+            }
+        }
+        prevTraceKey = traceKey;
+
         // Toggle UI with E (désactivé pour permettre le menu radial)
         // bool eDown = glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS;
         // if (eDown && !prevToggleE) {
@@ -264,31 +414,44 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Begin UI frame
-        overlay.beginFrame();
-
-        // UI métier centralisée (picking triangulation, menu contextuel)
-        sandboxUI.draw(window);
+        {
+            PROFILE_ZONE("UI build");
+            overlay.beginFrame();
 
-        // Don't forget to enable shader before setting uniforms
-        ourShader.use();
+            // UI métier centralisée (picking triangulation, menu contextuel)
+            sandboxUI.draw(window);
+        }
 
         // View/projection transformations
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
 
-        // Lighting uniforms
-        ourShader.setVec3("viewPos", camera.Position);
-        sceneState.applyLighting(ourShader);
+        // Uniforms communs, appliqués à chaque variante lors de sa première utilisation dans la frame
+        modelShaders.beginFrame([&](Shader& shader) {
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            shader.setVec3("viewPos", camera.Position);
+            shader.setVec3("highlightColor", editorState.highlightColor);
+            sceneState.applyLighting(shader);
+        });
+
+        // Envois GPU en attente (maillages, textures), plafonnés par frame
+        UploadScheduler::Instance().process();
 
         // Draw grid
         if (editorState.gridVisible) {
-            grid.draw(gridShader, view, projection);
+            PROFILE_ZONE("Grid");
+            PROFILE_GPU_ZONE("Grid");
+            grid.draw(gridShaders.get(ShaderFeature::None), view, projection);
         }
 
         // Draw placed models
-        manager.drawAll(ourShader, editorState.highlightObjects, editorState.highlightColor);
+        manager.setViewer(camera.Position, glm::radians(camera.Zoom), (float)SCR_HEIGHT);
+        {
+            PROFILE_ZONE("drawAll");
+            PROFILE_GPU_ZONE("drawAll");
+            manager.drawAll(modelShaders, editorState.highlightObjects);
+        }
 
         // Placement preview follows camera until click
         if (manager.hasPreview()) {
@@ -296,7 +459,7 @@ int main()
             glm::vec3 pos = camera.Position + forward * 3.0f; // 3 units in front
             pos.y = 0.0f; // snap to ground plane
             manager.setPreviewPosition(pos);
-            manager.drawPreview(ourShader, true, editorState.highlightColor);
+            manager.drawPreview(modelShaders, true);
 
             ImGuiIO& io = ImGui::GetIO();
             bool mouseCaptured = io.WantCaptureMouse;
@@ -308,7 +471,10 @@ int main()
         }
 
         // Draw UI
-        overlay.draw();
+        {
+            PROFILE_ZONE("UI build (panels)");
+            overlay.draw();
+        }
         
         // Dessiner les menus si nécessaire (après overlay.draw)
         if (editorState.menuState == MenuState::Radial) {
@@ -336,10 +502,10 @@ int main()
                 if (clickedItem != RadialMenuItem::None) {
                     switch (clickedItem) {
                         case RadialMenuItem::InfoLogs:
-                            // Afficher les infos/logs (panneau de scène)
+                            // Afficher les infos/logs (profileur de frame)
                             editorState.menuState = MenuState::None;
                             editorState.activeRadialItem = RadialMenuItem::None;
-                            overlay.showOnlyScenePanel();
+                            overlay.showOnlyInfoPanels();
                             break;
                         case RadialMenuItem::ImportModels:
                             // Afficher le navigateur de modèles (via SandBoxUI)
@@ -398,13 +564,40 @@ int main()
         }
         leftMouseWasPressed = leftMouseIsPressed;
         
-        overlay.endFrame();
+        {
+            PROFILE_ZONE("overlay.endFrame");
+            PROFILE_GPU_ZONE("ImGui");
+            overlay.endFrame();
+        }
+
+        // Clôturer les régions des tampons de streaming de cette frame
+        StreamBuffer::EndFrameAll();
 
         // GLFW: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        glfwSwapBuffers(window);
+        {
+            PROFILE_ZONE("Swap");
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
+
+        // Textures dessinées cette frame connues : envoyer les niveaux prêts, ajuster au budget
+        TextureResidency::Update();
+
+        // Objets GL libérés pendant la frame : supprimés maintenant que plus rien ne les dessine
+        GpuResources::Flush();
+
+        Profiler::Instance().endFrame();
+        TraceCapture::EndFrame();
     }
 
+    // Sauvegardes encore en cours d'écriture : les laisser se terminer avant de quitter
+    appContext.journal.waitIdle();
+
+    // Le cache de textures est statique : le vider tant que le contexte existe encore
+    UploadScheduler::Instance().shutdown();
+    Texture2D::SetRelinkHandler(nullptr);
+    Texture2D::ClearCache();
+    GpuResources::Flush();
     glfwTerminate();
     return -1;
 }
@@ -0,0 +1,93 @@
+// Lecture des maps JSON par SceneSerializer::Load : valeurs attendues et entrées malformées
+// mais syntaxiquement valides, qui ne doivent ni planter ni corrompre les instances voisines.
+#include "SceneSerializer.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::fprintf(stderr, "%s:%d: echec: %s\n", __FILE__, __LINE__, #condition);  \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (0)
+
+namespace {
+int failures = 0;
+
+std::optional<SceneSnapshot> loadText(const std::string &name, const std::string &text)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << text;
+    }
+    auto snapshot = SceneSerializer::Load(path.string());
+    std::filesystem::remove(path);
+    return snapshot;
+}
+
+void readsVectors()
+{
+    auto snapshot = loadText("sandbox_vectors.json",
+                             R"({"models": [{"path": "a.obj", "position": [1, 2, 3], "scale": [2, 2, 2]}]})");
+    CHECK(snapshot && snapshot->models.size() == 1);
+    if (!snapshot || snapshot->models.empty()) return;
+    CHECK(snapshot->models[0].position == glm::vec3(1.0f, 2.0f, 3.0f));
+    CHECK(snapshot->models[0].scale == glm::vec3(2.0f));
+}
+
+void rejectsNonNumericVectorElements()
+{
+    // Une composante qui n'est pas un nombre ne décale pas les suivantes : la map est refusée
+    const char *const maps[] = {
+        R"({"models": [{"path": "a.obj", "position": [1, null, 2, 3]}]})",
+        R"({"models": [{"path": "a.obj", "position": [1, 2, [], 3]}]})",
+        R"({"models": [{"path": "a.obj", "rotation": [[1, 2, 3]]}]})",
+        R"({"models": [{"path": "a.obj", "scale": [1, "2", 3]}]})",
+        R"({"models": [{"path": "a.obj", "scale": [true, 2, 3]}]})",
+        R"({"light": {"ambient": [0.1, {"x": 1}, 0.2]}})",
+    };
+    for (const char *text : maps) CHECK(!loadText("sandbox_invalid.json", text));
+}
+
+void writesNonFiniteAsReadableNumbers()
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "sandbox_nan.json";
+    SceneSnapshot saved;
+    ModelInstanceData instance;
+    instance.path = "a.obj";
+    instance.position = glm::vec3(1.0f, std::numeric_limits<float>::quiet_NaN(), 3.0f);
+    saved.models.push_back(instance);
+    CHECK(SceneSerializer::Save(path.string(), saved));
+    auto loaded = SceneSerializer::Load(path.string());
+    std::filesystem::remove(path);
+    CHECK(loaded && loaded->models.size() == 1);
+    if (loaded && loaded->models.size() == 1) CHECK(loaded->models[0].position == glm::vec3(1.0f, 0.0f, 3.0f));
+}
+
+void ignoresWrongSizedVector()
+{
+    auto snapshot = loadText("sandbox_sizes.json",
+                             R"({"models": [{"path": "a.obj", "position": [1, 2], "scale": [1, 2, 3, 4]}]})");
+    CHECK(snapshot && snapshot->models.size() == 1);
+    if (!snapshot || snapshot->models.empty()) return;
+    CHECK(snapshot->models[0].position == glm::vec3(0.0f));
+    CHECK(snapshot->models[0].scale == glm::vec3(1.0f));
+}
+}
+
+int main()
+{
+    readsVectors();
+    rejectsNonNumericVectorElements();
+    writesNonFiniteAsReadableNumbers();
+    ignoresWrongSizedVector();
+    if (failures) std::fprintf(stderr, "%d verification(s) en echec\n", failures);
+    return failures ? 1 : 0;
+}